@@ -2,12 +2,22 @@
 * \file    DigitalLoadExample.ino
 * \brief    Example Control of Digital Constant Current Source
 * \brief    Required hardware: PCB RL-021/xx, Microcontroller (Arduino) with I2C communication  
-* \brief    Required drivers: MCP47x6.h, MCP3428.h
+* \brief    Required drivers: MCP47x6.h, MCP3428.h, I2C_Engine.h, RL021_Waveform.h, RL021_Scheduler.h, RL021_BatteryTest.h, RL021_LoadGroup.h, RL021_Calibration.h, RL021_Settings.h, RL021_Supervisor.h, RL021_Scpi.h
 * 
 * \brief    basic functions: 
 *               -Set constant load current and read back all measured channels
                 -Control via serial commands
-                -Output waveforms to load
+                -Output waveforms to load (table uploaded via serial commands, timer driven player)
+                -Several boards on one I2C bus (LOAD_BOARDS), telemetry tagged with board number
+                -Synchronized capture of all boards (general call conversion), I2C clock 100/400kHz
+                -Battery discharge test (capacity, energy, discharge curve)
+                -Multi-point calibration with least-squares fit (reference values entered via serial commands)
+                -Calibration and settings of each board in EEPROM, loaded at boot
+                -Safety supervisor of all boards (over-temperature, over-power, over-current, SOA) with latched faults
+                -Fixed-period tasks (supervisor, control, acquisition, commands, telemetry) instead of a delay() loop
+                -SCPI-style command lines (setpoints, measurements, error queue), several queries answered in one line
+                -Waveform player, battery test, calibration and SCPI are build options (LOAD_WAVEFORM, LOAD_BATTERY_TEST,
+                 LOAD_CALIBRATION, LOAD_SCPI), left out by default on 2KB RAM (Nano)
 * 
 * \author  Julian Schindler
 *
@@ -31,35 +41,207 @@
 #include "printf.h"
 
 #include "RL021_DigitalLoad.h"
+#include "RL021_Protocol.h"
+#include "RL021_Waveform.h"
+#include "RL021_Scheduler.h"
+#include "RL021_BatteryTest.h"
+#include "RL021_LoadGroup.h"
+#include "RL021_Calibration.h"
+#include "RL021_Settings.h"
+#include "RL021_Supervisor.h"
+#include "RL021_Scpi.h"
 
 ////////////////////////////////////////////////////////////////////////////////////
-#ifndef MOCK_ADC_DAC
-  /// Create DAC Object with default I2C adress 0x60
-  MCP47x6base * DAC_mcp47x6 = new MCP4726;
-  //MOCK_MCP47x6base DAC_mcp47x6;
-  
-  /// Create ADC Object with default I2C adress 0x68
-  MCP3428 ADC_mcp3428(0); /// A2, A1, A0 bits (000, 0x68)
-  //MOCK_MCP3428 ADC_mcp3428; /// debug
-  
-  /// Create DigitalLoad Object
-  //RL021_DigitalLoad myLoad(DAC_mcp47x6, &ADC_mcp3428);
-  
-  /// Create DigitalLoad Object with mocked ADC/DAC
-  RL021_DigitalLoad myLoad(DAC_mcp47x6,&ADC_mcp3428);
+/// Create DAC Object with default I2C adress 0x60
+MCP47x6base * DAC_mcp47x6 = new MCP4726;
+
+/// Create ADC Object with default I2C adress 0x68
+MCP3428 ADC_mcp3428(0); /// A2, A1, A0 bits (000, 0x68)
+
+/// Create DigitalLoad Object
+/// (without hardware: native build with simulated board, see firmware/HostSimulation)
+RL021_DigitalLoad myLoad(DAC_mcp47x6,&ADC_mcp3428);
+
+/// Stream ring buffer of board 0 ('sm'), the other boards do not stream
+S_RL021_StreamSample streamBuffer[RL021_STREAM_BUFFER_SIZE];
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Queue for all I2C transactions of ADC and DAC (serviced in loop)
+I2C_Engine I2C_bus;
+
+/// I2C bus clock [Hz], 'si'...'e' switches between 100 and 400 kHz (MCP4726 and MCP3428 support fast mode)
+#define I2C_CLOCK_HZ    100000
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Number of boards on the bus LOAD_BOARDS (1 ... 8, see RL021_LoadGroup.h, build flag e.g. -DLOAD_BOARDS=4): myLoad is board 0, 
+/// board n is created in setup() with DAC 0x60 + n and ADC 0x68 + n (R8 / DAC ordering code)
+
+/// Interleaved acquisition of all boards, 'sj'...'e' with channel mask: synchronized capture (0: interleaved)
+RL021_LoadGroup loadGroup(&I2C_bus);
+
+/// Board of the setpoint commands, select with 'sx'...'e' (waveform, battery test and stream: board 0)
+RL021_DigitalLoad * selectedLoad = &myLoad;
+
+/// Reference, jumper settings and EEPROM settings of a board, see 'ss' command
+void setupBoard(RL021_DigitalLoad * load);
+
 ////////////////////////////////////////////////////////////////////////////////////
+/// Optional functions, 1: included, 0: left out (build flag, e.g. -DLOAD_SCPI=1)
+/// 2KB RAM (ATmega328, Nano): left out by default, their static RAM (waveform ~180 bytes, battery test ~190,
+/// calibration ~270, SCPI ~130) and the RAM of the other functions leave too little for the stack
+#if defined(RAMEND) && (RAMEND < 0x900)
+#define LOAD_OPTIONS_DEFAULT    0
 #else
+#define LOAD_OPTIONS_DEFAULT    1
+#endif
+#ifndef LOAD_WAVEFORM
+#define LOAD_WAVEFORM           LOAD_OPTIONS_DEFAULT
+#endif
+#ifndef LOAD_BATTERY_TEST
+#define LOAD_BATTERY_TEST       LOAD_OPTIONS_DEFAULT
+#endif
+#ifndef LOAD_CALIBRATION
+#define LOAD_CALIBRATION        LOAD_OPTIONS_DEFAULT
+#endif
+#ifndef LOAD_SCPI
+#define LOAD_SCPI               LOAD_OPTIONS_DEFAULT
+#endif
 
-  //Use simulation of ADC and DAC if required hardware is not present
-  MCP47x6base DAC_mcp47x6;
-  MCP3428 ADC_mcp3428;
-  RL021_DigitalLoad myLoad(&DAC_mcp47x6,&ADC_mcp3428);
+#if LOAD_WAVEFORM
+/// Arbitrary waveform player (Timer1), see 'sw'/'sd'/'so'/'sh'/'sk'/'sn'/'sg' commands
+RL021_Waveform waveform(&myLoad);
+uint16_t waveOffset_mA = 0;
+uint16_t waveAmplitude_mA = 0;
+#endif
 
+#if LOAD_BATTERY_TEST
+/// Battery discharge test, see 'sy'/'sz'/'sb' commands
+RL021_BatteryTest batteryTest(&myLoad);
+uint16_t batteryCutoff_mV = 0;
 #endif
-////////////////////////////////////////////////////////////////////////////////////
-int countTicks = 10000;
+
+#if LOAD_CALIBRATION
+/// Calibration of board 0, see 'sc'/'sl'/'st' commands, correction tables of current, Vload, Vext
+RL021_Calibration calibration(&myLoad);
+S_RL021_CorrectionTable correctionTables[ADC_CH_NTC];
+#endif
+
+/// Safety supervisor of all boards (default limits, see RL021_Supervisor.h), see '1'/'3' commands
+RL021_Supervisor supervisor;
+
 uint16_t currentToSet;
 
+////////////////////////////////////////////////////////////////////////////////////
+/// Tasks of loop(): period [us], priority (0: highest)
+#define TASK_SUPERVISOR_PERIOD_US   500     /// limit check of new measurements, shutdown
+#define TASK_CONTROL_PERIOD_US      500     /// end of waveform run
+#define TASK_ACQUISITION_PERIOD_US  1000    /// one I2C transaction per run, stream (12-bit conversion: 4.2ms)
+#define TASK_COMMAND_PERIOD_US      5000    /// 115200 baud: max. 58 characters per period
+#define TASK_TELEMETRY_PERIOD_US    (1000000 / LOAD_BOARDS)  /// one board per run, every board once per second
+
+RL021_Scheduler scheduler;
+
+void taskSupervisor();
+void taskControl();
+void taskAcquisition();
+void taskCommand();
+void taskTelemetry();
+
+// send 'c' to get summary and curve of the actual / last battery test (sent automatically at the end of a test)
+void sendBatteryTest();
+
+// calibration: reference request of each point, fit at the end
+void sendCalibrationRequest();
+void sendCalibrationFit();
+void printCalibrationFit(const __FlashStringHelper * name, const S_RL021_CalFit * fit);
+
+// send 'o' to dump and reset the task statistics (runs, overruns, max. start delay and duration)
+void sendTaskStatistics();
+
+// send '1' to get the supervisor state of all boards (sent automatically on a trip), '3' to clear faults
+void sendSupervisorStatus();
+
+/// Interprete one character of a single / multi character command
+void handleSerialCommand(char c);
+
+/// SCPI command lines, see scpiCommands (setpoints and values of the selected board in A, V, W, Ohm, °C)
+int16_t scpiSetLoadMode(RL021_Scpi * scpi, E_LOAD_MODE mode, float scale, float maximum);
+int16_t scpiQueryLoadMode(RL021_Scpi * scpi, E_LOAD_MODE mode, uint8_t decimals);
+int16_t scpiIdentify(RL021_Scpi * scpi);
+int16_t scpiReset(RL021_Scpi * scpi);
+int16_t scpiClearStatus(RL021_Scpi * scpi);
+int16_t scpiCurrent(RL021_Scpi * scpi);
+int16_t scpiCurrentQuery(RL021_Scpi * scpi);
+int16_t scpiVoltage(RL021_Scpi * scpi);
+int16_t scpiVoltageQuery(RL021_Scpi * scpi);
+int16_t scpiPower(RL021_Scpi * scpi);
+int16_t scpiPowerQuery(RL021_Scpi * scpi);
+int16_t scpiResistance(RL021_Scpi * scpi);
+int16_t scpiResistanceQuery(RL021_Scpi * scpi);
+int16_t scpiModeQuery(RL021_Scpi * scpi);
+int16_t scpiMeasureCurrent(RL021_Scpi * scpi);
+int16_t scpiMeasureVoltage(RL021_Scpi * scpi);
+int16_t scpiMeasureVoltageExt(RL021_Scpi * scpi);
+int16_t scpiMeasureTemperature(RL021_Scpi * scpi);
+int16_t scpiMeasurePower(RL021_Scpi * scpi);
+int16_t scpiMeasureAll(RL021_Scpi * scpi);
+int16_t scpiMeasureRaw(RL021_Scpi * scpi);
+int16_t scpiRegulation(RL021_Scpi * scpi);
+int16_t scpiRegulationQuery(RL021_Scpi * scpi);
+int16_t scpiResolution(RL021_Scpi * scpi);
+int16_t scpiResolutionQuery(RL021_Scpi * scpi);
+int16_t scpiBoard(RL021_Scpi * scpi);
+int16_t scpiBoardQuery(RL021_Scpi * scpi);
+int16_t scpiProtectionQuery(RL021_Scpi * scpi);
+int16_t scpiProtectionClear(RL021_Scpi * scpi);
+int16_t scpiSave(RL021_Scpi * scpi);
+int16_t scpiError(RL021_Scpi * scpi);
+int16_t scpiErrorCount(RL021_Scpi * scpi);
+
+#if LOAD_SCPI
+/// Command tree: long form, upper case letters are the short form, [optional node]
+const S_RL021_ScpiCommand scpiCommands[] PROGMEM = {
+  {"*IDN?",                         scpiIdentify},
+  {"*RST",                          scpiReset},
+  {"*CLS",                          scpiClearStatus},
+  {"[SOURce:]CURRent[:LEVel]",      scpiCurrent},
+  {"[SOURce:]CURRent[:LEVel]?",     scpiCurrentQuery},
+  {"[SOURce:]VOLTage[:LEVel]",      scpiVoltage},
+  {"[SOURce:]VOLTage[:LEVel]?",     scpiVoltageQuery},
+  {"[SOURce:]POWer[:LEVel]",        scpiPower},
+  {"[SOURce:]POWer[:LEVel]?",       scpiPowerQuery},
+  {"[SOURce:]RESistance[:LEVel]",   scpiResistance},
+  {"[SOURce:]RESistance[:LEVel]?",  scpiResistanceQuery},
+  {"[SOURce:]MODE?",                scpiModeQuery},
+  {"MEASure:CURRent?",              scpiMeasureCurrent},
+  {"MEASure:VOLTage?",              scpiMeasureVoltage},
+  {"MEASure:VOLTage:EXTernal?",     scpiMeasureVoltageExt},
+  {"MEASure:TEMPerature?",          scpiMeasureTemperature},
+  {"MEASure:POWer?",                scpiMeasurePower},
+  {"MEASure:ALL?",                  scpiMeasureAll},
+  {"MEASure:RAW?",                  scpiMeasureRaw},
+  {"REGulation[:STATe]",            scpiRegulation},
+  {"REGulation[:STATe]?",           scpiRegulationQuery},
+  {"SENSe:RESolution",              scpiResolution},
+  {"SENSe:RESolution?",             scpiResolutionQuery},
+  {"SYSTem:BOARd",                  scpiBoard},
+  {"SYSTem:BOARd?",                 scpiBoardQuery},
+  {"SYSTem:PROTection?",            scpiProtectionQuery},
+  {"SYSTem:PROTection:CLEar",       scpiProtectionClear},
+  {"SYSTem:SAVE",                   scpiSave},
+  {"SYSTem:ERRor[:NEXT]?",          scpiError},
+  {"SYSTem:ERRor:COUNt?",           scpiErrorCount}
+};
+
+RL021_Scpi scpi(&Serial, scpiCommands, sizeof(scpiCommands) / sizeof(S_RL021_ScpiCommand));
+#endif
+
+/// Index of the selected board in loadGroup
+uint8_t getSelectedBoard();
+
+/// Set raw DAC value stepwise
+void DAC_IncrementRaw(bool increment, bool bigStep, bool reset);
+
 /// Increment current stepwise by 1 LSB of DAC (via serial command '+'/'-')
 void calibrateCurrent();
 
@@ -68,13 +250,30 @@ void calibrateVoltage();
 
 /// Send all ADC measured values via serial port
 void sendInfo();
-void sendInfoProtocol();
-void sendRawInfoProtocol();
+void sendInfoProtocol(RL021_DigitalLoad * load);
+void sendRawInfoProtocol(RL021_DigitalLoad * load);
 
 // send 'r' to switch to raw data
 // send 't' to switch to mA/mV data
 bool sendRawInfo = false; //(false): sendInfoProtocol(), (true):sendRawInfoProtocol()
 
+// send 'b' to switch to binary frames (see RL021_Protocol.h)
+// send 'a' to switch to ASCII protocol
+bool sendBinary = false;
+RL021_Protocol binaryProtocol(&Serial);
+
+// send 'sm'...'e' with channel mask to stream all conversions as binary blocks (0: stop)
+// send 'sq'...'e' to set ADC resolution (12, 14, 16)
+void sendStream();
+uint32_t lastStreamBlock_ms = 0;
+
+// send 'i' to dump and reset the I2C bus statistics of DAC and ADC of all boards
+void sendI2CStatistics();
+void printI2CStatistics(const __FlashStringHelper * device, const S_I2C_STATISTICS * statistics);
+
+// send 'sg1e' to start / 'sg0e' to stop the waveform player, timing is sent at the end of a run
+void sendWaveformStatistics();
+
 /// Dummy output functions (call frequently to get waveform)
 void Sawtooth();
 void Triangle();
@@ -88,236 +287,1063 @@ void setup() {
 
   //Serial.println("<RL 021/00 Digital Load>");
 /*
-  Serial.print("check for DAC ... ");
+  Serial.print(F("check for DAC ... "));
     if (!DAC_mcp47x6->devicepresent()) 
     {
-      Serial.println("DAC Device not found");
+      Serial.println(F("DAC Device not found"));
     }
     else
     {
-      Serial.println("DAC Device OK");
+      Serial.println(F("DAC Device OK"));
     }
 
     /// Use external voltage reference (2.048V onboard) 
     DAC_mcp47x6->setReference(MCP47x6base::refpinbuff);
 
-    Serial.print("check for ADC ... ");
+    Serial.print(F("check for ADC ... "));
     if (!ADC_mcp3428.testConnection()) 
     {
-      Serial.println("ADC Device not found");
+      Serial.println(F("ADC Device not found"));
     }
     else
     {
-      Serial.println("ADC Device OK");
+      Serial.println(F("ADC Device OK"));
     }
     */
 
-    DAC_mcp47x6->setReference(MCP47x6base::refpinbuff);
+    Wire.setClock(I2C_CLOCK_HZ);
 
+    /// Queue all bus transactions, ADC conversions do not block the loop
+    setupBoard(&myLoad);
+    myLoad.SetStreamBuffer(streamBuffer, RL021_STREAM_BUFFER_SIZE);
+    loadGroup.AddBoard(&myLoad);
+    supervisor.AddBoard(&myLoad);
 
-    /// Write board jumper settings (like set on PCB)
-    myLoad.SetJumperSetting(JP2_CURRENT,Jumper_Closed);
-    myLoad.SetJumperSetting(JP3_VLOAD,Jumper_Open);
-    myLoad.SetJumperSetting(JP4_VEXT,Jumper_Open);  
+    /// Further boards on the same bus
+    for(uint8_t n=1;n<LOAD_BOARDS;n++)
+    {
+      RL021_DigitalLoad * load = new RL021_DigitalLoad(new MCP4726(0x60 + n), new MCP3428(n));
+      setupBoard(load);
+      loadGroup.AddBoard(load);
+      supervisor.AddBoard(load);
+    }
 
-    /// Write calibration data, otherwise default calibration is used
-    ///...
-    
     currentToSet = 0;
-    myLoad.SetCurrent_mA(currentToSet);
+
+    /// Convert all channels of all boards in background, getters return cached values
+    loadGroup.StartAcquisition();
+
+    scheduler.AddTask("supervisor", taskSupervisor, TASK_SUPERVISOR_PERIOD_US, 0);
+    scheduler.AddTask("control", taskControl, TASK_CONTROL_PERIOD_US, 1);
+    scheduler.AddTask("acquisition", taskAcquisition, TASK_ACQUISITION_PERIOD_US, 2);
+    scheduler.AddTask("command", taskCommand, TASK_COMMAND_PERIOD_US, 3);
+    scheduler.AddTask("telemetry", taskTelemetry, TASK_TELEMETRY_PERIOD_US, 4);
+    scheduler.Start();
 
     //Serial.println("<start loop>");
 
 }
 
+/** Reference, jumpers and calibration of one board (I2C engine: see RL021_LoadGroup::AddBoard())
+ *  Calibration and settings stored with 'ss1e' replace the defaults, the board is calibrated before the first DAC write.
+ *
+ *  @param RL021_DigitalLoad * load -
+ *  @return /
+ */
+void setupBoard(RL021_DigitalLoad * load)
+{
+    load->deviceDAC->setReference(MCP47x6base::refpinbuff);
+
+    /// Write board jumper settings (like set on PCB), used if the EEPROM holds no settings of this board
+    load->SetJumperSetting(JP2_CURRENT,Jumper_Closed);
+    load->SetJumperSetting(JP3_VLOAD,Jumper_Open);
+    load->SetJumperSetting(JP4_VEXT,Jumper_Open);  
+
+    /// Write calibration data, otherwise default calibration is used
+    E_RL021_SETTINGS_STATUS status = RL021_Settings::Load(load);
+
+    Serial.print(F("<settings board "));
+    Serial.print(load->deviceADC->GetAddress() % RL021_SETTINGS_SLOTS);
+    Serial.print((status == SETTINGS_LOADED) ? F(": loaded") : (status == SETTINGS_EMPTY) ? F(": defaults") : F(": defaults, invalid"));
+    Serial.print(F(">"));
+    Serial.println();
+    
+    load->SetCurrent_mA(0);
+}
+
 void loop() 
 {  
+#if LOAD_WAVEFORM
+  /// Waveform sample of the latest Timer1 tick: checked between all tasks, not delayed by the control task period
+  waveform.Service();
+#endif
+
+  /// Due task with the highest priority
+  scheduler.Run();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tasks
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////
+// Limits of all boards on the cached measurements, shutdown of a board on a violation
+void taskSupervisor()
+{
+  if(!supervisor.Service())
+  {
+    return;
+  }
+
+  /// Board 0: functions which write the DAC are ended (DAC writes are blocked until '3')
+  if(supervisor.GetFaults(0))
+  {
+#if LOAD_WAVEFORM
+    waveform.Stop();
+#endif
+#if LOAD_BATTERY_TEST
+    if(batteryTest.IsRunning())
+    {
+      batteryTest.Stop();
+    }
+#endif
+#if LOAD_CALIBRATION
+    if(calibration.GetState() != CAL_IDLE && calibration.GetState() != CAL_DONE)
+    {
+      calibration.Stop();
+    }
+#endif
+  }
+  sendSupervisorStatus();
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Load output: end of the waveform run (samples are written by loop())
+void taskControl()
+{
+#if LOAD_WAVEFORM
+  static bool waveformRunning = false;
+
+  if(waveformRunning && !waveform.IsRunning())
+  {
+    sendWaveformStatistics();
+  }
+  waveformRunning = waveform.IsRunning();
+#endif
 
   //Sawtooth(200);
   //Triangle(150);
   //Square(133);
   //myLoad.SetCurrent_mA(currentToSet);
 
-  /*
-  Serial.print("c: ");
-  Serial.print(currentToSet);
-  Serial.println();
-  */
-  
   //calibrateCurrent();
 
   //calibrateVoltage();
+}
 
-  //Character received via UART
-  if ( Serial.available() )
+///////////////////////////////////////////////////////////////////////////
+// Background acquisition of all ADC channels (incl. regulation / load modes) and stream
+void taskAcquisition()
+{
+  /// all boards, one queued I2C transaction per board
+  loadGroup.Service();
+
+#if LOAD_BATTERY_TEST
+  /// Integrate capacity, check cutoff
+  if(batteryTest.Service())
   {
-    handleSerialCommand();
+    sendBatteryTest();
   }
-  
-  //tick counter
-  countTicks++;
-  if (countTicks > 100) //1s
+#endif
+
+#if LOAD_CALIBRATION
+  /// Calibration: settling / averaging, request next reference
+  E_RL021_CAL_STATE calibrationState = calibration.GetState();
+  if(calibration.Service())
   {
-    countTicks = 0;
-    //sendInfo();
-    
+    sendCalibrationRequest();
+  }
+  if(calibrationState != CAL_DONE && calibration.GetState() == CAL_DONE)
+  {
+    sendCalibrationFit();
+  }
+#endif
+
+  if(myLoad.IsStreaming())
+  {
+    sendStream();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Characters received via UART: SCPI lines, else single / multi character commands
+void taskCommand()
+{
+  while ( Serial.available() )
+  {
+    char c = Serial.read();
+#if LOAD_SCPI
+    if(scpi.Feed(c))
+    {
+      continue;
+    }
+#endif
+    handleSerialCommand(c);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Measurement of all channels of one board (not while streaming)
+// several boards: board number as 'sx'...'e' before the values / FRAME_BOARD_SNAPSHOT
+void taskTelemetry()
+{
+  static uint8_t board = 0;
+
+  if(myLoad.IsStreaming())
+  {
+    return;
+  }
+
+  //sendInfo();
+
+  RL021_DigitalLoad * load = loadGroup.GetBoard(board);
+
+  if(sendBinary)
+  {
+    if(LOAD_BOARDS > 1)
+    {
+      binaryProtocol.SendBoardSnapshot(board, load, sendRawInfo);
+    }
+    else
+    {
+      binaryProtocol.SendSnapshot(load, sendRawInfo);
+    }
+  }
+  else
+  {
+    if(LOAD_BOARDS > 1)
+    {
+      Serial.print(F("sx"));
+      Serial.print(board);
+      Serial.print(F("e"));
+      Serial.println();
+    }
 
     if(sendRawInfo)
     {
-      sendRawInfoProtocol();
+      sendRawInfoProtocol(load);
     }
     else
     {
-      sendInfoProtocol();
+      sendInfoProtocol(load);
     }
   }
-  
-  delay(10);
+
+  board = (board + 1) % loadGroup.GetBoardCount();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Read and Interprete Serial command from PC
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+///////////////////////////////////////////////////////////////////////////
+/*
+Single character commands:
+'+' Increment DAC +1
+'-' Decrement DAC -1
+'0' Set DAC to 0
+'8' Increment DAC +100
+'2' Decrement DAC -100
+'r' set sendRawInfo TRUE
+'t' set sendRawInfo FALSE
+'b' binary protocol (frames, see RL021_Protocol.h)
+'a' ASCII protocol (default)
+'5' enable closed-loop current regulation
+'6' disable closed-loop current regulation
+'7' enable PGA auto-gain of current, Vload, Vext (x1 ... x8, see RL021_DigitalLoad::SetAutoGain())
+'9' disable PGA auto-gain (x1)
+'i' dump and reset I2C statistics (transactions, bytes, NACKs, latency, data ready polls per conversion)
+'o' dump and reset task statistics (runs, overruns, max. start delay and duration)
+'c' battery test summary and discharge curve (LOAD_BATTERY_TEST)
+'1' supervisor state of all boards (faults, derating, values of the last trip, latency conversion -> shutdown)
+'3' clear latched faults of the selected board, load restarts with 0mA (a violation still present trips again)
+
+Multi character commands:
+'sa' Read ASCII digits (1-9999) 'e' set load current in mA
+'sf' Read ASCII digits (1-9999) 'e' set raw DAC value
+'sv' Read ASCII digits (1-99999) 'e' set constant voltage mode in mV
+'sp' Read ASCII digits (1-99999) 'e' set constant power mode in mW
+'sr' Read ASCII digits (1-99999) 'e' set constant resistance mode in 10mOhm
+'sm' Read ASCII digits (0-15) 'e' stream channel mask (bit0: current, bit1: Vload, bit2: Vext, bit3: NTC), 0: stop
+     (load on: a mask without current, Vload and NTC (11) trips the supervisor, fault UNSUPERVISED),
+     not possible during synchronized capture ('sj')
+'sq' Read ASCII digits (12, 14, 16) 'e' set ADC resolution
+'sw' 'e' clear waveform table (upload: 'sw' 'e', then 'sd' for each sample), 'sw' ... 'sg': LOAD_WAVEFORM
+'sd' Read ASCII digits (0-1000) 'e' append waveform sample (1000: offset + amplitude)
+'so' Read ASCII digits (0-9999) 'e' waveform offset in mA
+'sh' Read ASCII digits (0-9999) 'e' waveform amplitude in mA
+'sk' Read ASCII digits (4-2000) 'e' waveform sample rate in Hz
+'sn' Read ASCII digits (0-65535) 'e' waveform table repetitions (0: endless)
+'sg' Read ASCII digits (0, 1) 'e' stop / start waveform (regulation off, CC mode)
+'sy' Read ASCII digits (0-65535) 'e' battery test cutoff voltage in mV, 'sy' ... 'sb': LOAD_BATTERY_TEST
+'sz' Read ASCII digits (0-9999) 'e' battery test tail current in mA after first cutoff (0: no tail)
+'sb' Read ASCII digits (0-9999) 'e' start battery test with current in mA (0: abort)
+'sx' Read ASCII digits (0-7) 'e' select board of 'sa', 'sf', 'sv', 'sp', 'sr', 'sq', 'su', 'ss', '5', '6', '7', '9', '3', '+', '-', '0', '8', '2'
+'sj' Read ASCII digits (0-15) 'e' synchronized capture of all boards, channel mask like 'sm' (0: interleaved acquisition)
+     (trips boards with the load on like 'sm' if the mask lacks current, Vload or NTC), not possible while streaming
+'si' Read ASCII digits (100, 400) 'e' I2C clock in kHz
+'sc' Read ASCII digits (0-3) 'e' start calibration of board 0 in the actual range (0: current, DAC sweep, 1: Vload, 2: Vext,
+     3: PGA gains x2 / x4 / x8 with the current channel, no reference values), 'sc' ... 'st': LOAD_CALIBRATION
+'sl' Read ASCII digits (0-99999) 'e' reference value of the requested calibration point in mA / mV
+'st' Read ASCII digits (0-2) 'e' calibration: 0: abort, 1: apply fit, 2: apply fit and correction table
+     (Vload / Vext: ends the calibration with the points measured so far)
+'su' Read ASCII digits (CTS) 'e' filter of channel C (0-3) on selected board: type T (0: none, 1: moving average,
+     2: exponential, 3: decimation), length 2^S (e.g. 'su013e': current, moving average of 8 conversions)
+'ss' Read ASCII digits (0, 1) 'e' settings of selected board in EEPROM: 0: erase (defaults at next boot),
+     1: save calibration, jumpers, ADC resolution, filters, regulation and load mode parameters (loaded at boot)
+
+'<' Ignore following characters until '>' received
+
+SCPI command lines (LOAD_SCPI, RL021_Scpi.h, table scpiCommands): start with an upper case letter or '*', end with '\n',
+commands separated by ';', responses of all queries of a line in one line ('\n'), e.g.
+"CURR 1.5;MEAS:ALL?;SYST:ERR?\n" -> "1.499,11.849,4.999,26.1;0,"No error"\n"
+'*IDN?' identification, '*RST' all boards 0A (waveform / battery test stopped), '*CLS' clear error queue
+'CURR <A>', 'VOLT <V>', 'POW <W>', 'RES <Ohm>' set load mode and setpoint (like 'sa', 'sv', 'sp', 'sr'),
+     queries: setpoint, 0 in another mode ('CURR?': current setpoint of every mode), 'MODE?' CC / CV / CP / CR
+'MEAS:CURR?', 'MEAS:VOLT?', 'MEAS:VOLT:EXT?', 'MEAS:TEMP?', 'MEAS:POW?' measured values (A, V, V, °C, W),
+     'MEAS:ALL?' current, Vload, Vext, temperature, 'MEAS:RAW?' raw ADC values of the 4 channels
+'REG ON|OFF' closed-loop regulation, 'SENS:RES 12|14|16' ADC resolution, 'SYST:BOAR <n>' select board (like 'sx'),
+'SYST:PROT?' latched faults (RL021_FAULT_xxx), 'SYST:PROT:CLE' clear faults (like '3'), 'SYST:SAVE' like 'ss1e'
+'SYST:ERR?' oldest error: number,"text" (0: no error), 'SYST:ERR:COUN?' number of stored errors
+
+*/
+void handleSerialCommand(char c)
+{
+  uint32_t serialNumber = 0;
+                            // E, Z, H, T, ZT
+  static uint8_t number[5] = {0,0,0,0,0};
+  static bool readInDigit = false;
+  static bool firstCharacter = false;
+  static uint8_t serialDigitType = 0;
+
+  /// Check for multi character command start sign
+  if(c == 's' && readInDigit == false)
+  {
+    readInDigit = true;
+    firstCharacter = true;  
+  }
+  else if(firstCharacter == true)
+  {
+    serialDigitType = c;
+    readInDigit = true;
+    firstCharacter = false;
+  }
+  /// Check for multi character commands data
+  if(readInDigit)
+  {
+      if(c >= 48 && c <= 57)//ASCII '0'-'9'
+      {
+        uint8_t newDigit;  
+        newDigit = c - 48; //ASCII '0'-'9' to integer
+        number[4] = number[3]; //ZT
+        number[3] = number[2]; //T
+        number[2] = number[1]; //H
+        number[1] = number[0]; //Z
+        number[0] = newDigit; //E      
+      }    
+  }
+
+  /// Single character commands
+  if(readInDigit == false)
+  {
+      switch (c)
+      {
+        case '+': //increment DAC small step
+            DAC_IncrementRaw(1, 0, 0);
+          break;
+        case '-': //decrement DAC small step
+            DAC_IncrementRaw(0, 0, 0);
+          break;
+        case '0': //set DAC to 0
+            DAC_IncrementRaw(0, 0, 1);
+          break;
+        case '8': ///increment DAC big step
+            DAC_IncrementRaw(1, 1, 0);
+          break;
+        case '2': //decrement DAC bif step
+            DAC_IncrementRaw(0, 1, 0);
+          break;
+        case 'r':
+              sendRawInfo = true;
+          break;
+        case 't':
+              sendRawInfo = false;
+          break;
+        case 'b':
+              sendBinary = true;
+              Serial.print(F("<protocol binary v"));
+              Serial.print(RL021_FRAME_VERSION);
+              Serial.print(F(">"));
+              Serial.println();
+          break;
+        case 'a':
+              sendBinary = false;
+              Serial.print(F("<protocol ascii>"));
+              Serial.println();
+          break;
+        case '5':
+              selectedLoad->EnableRegulation(true);
+          break;
+        case '6':
+              selectedLoad->EnableRegulation(false);
+          break;
+        case 'i':
+              sendI2CStatistics();
+          break;
+        case 'o':
+              sendTaskStatistics();
+          break;
+#if LOAD_BATTERY_TEST
+        case 'c':
+              sendBatteryTest();
+          break;
+#endif
+        case '1':
+              sendSupervisorStatus();
+          break;
+        case '3':
+              for(uint8_t n=0;n<loadGroup.GetBoardCount();n++)
+              {
+                if(loadGroup.GetBoard(n) == selectedLoad)
+                {
+                  supervisor.ClearFaults(n);
+                }
+              }
+              sendSupervisorStatus();
+          break;
+        case '7':
+              selectedLoad->SetAutoGain((1<<ADC_CH_CURRENT) | (1<<ADC_CH_VLOAD) | (1<<ADC_CH_VEXT));
+          break;
+        case '9':
+              selectedLoad->SetAutoGain(0);
+              for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+              {
+                selectedLoad->SetAdcGain((E_ADC_CHANNEL)ch, 0);
+              }
+          break;
+        default:
+          Serial.println(F("single command unknown"));
+          break;
+      }
+  }
+
+  /// Check for multi character command end sign
+  if(c == 'e' && readInDigit == true)
+  {
+    serialNumber = number[0] + number[1]*10 + number[2]*100 + number[3]*1000 + number[4]*10000UL;
+    number[4] = 0;
+    number[3] = 0;
+    number[2] = 0;
+    number[1] = 0;
+    number[0] = 0;
+
+    if(serialDigitType == 'a')
+    {
+      //set read in number to DAC
+      selectedLoad->SetCurrent_mA(serialNumber);   
+      Serial.print(F("<"));
+      Serial.print(F("Set Load Current [mA]: "));
+      Serial.print(serialNumber);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'f')
+    {
+      selectedLoad->SetRawDac(serialNumber);
+      Serial.print(F("<"));
+      Serial.print(F("raw DAC set: "));
+      Serial.print(serialNumber);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'm')
+    {
+      if(loadGroup.IsSyncCapture())
+      {
+        /// the ADC of board 0 is driven by the synchronized capture of loadGroup
+        Serial.println(F("<stream not possible during sync capture ('sj0e' first)>"));
+      }
+      else if(serialNumber > 0)
+      {
+        /// stream is sent as binary blocks
+        if(myLoad.StartStreaming(serialNumber, myLoad.GetAdcResolution()))
+        {
+          sendBinary = true;
+        }
+        else
+        {
+          Serial.println(F("<stream not started, no stream buffer>"));
+        }
+      }
+      else
+      {
+        myLoad.StopStreaming();
+        myLoad.StartAcquisition();
+        Serial.print(F("<"));
+        Serial.print(F("stream stopped, overflows: "));
+        Serial.print(myLoad.GetStreamOverflows());
+        Serial.print(F(">"));
+        Serial.println();
+      }
+    }
+    else if (serialDigitType == 'q')
+    {
+      selectedLoad->SetAdcResolution(serialNumber);
+      Serial.print(F("<"));
+      Serial.print(F("ADC resolution: "));
+      Serial.print(selectedLoad->GetAdcResolution());
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'v')
+    {
+      selectedLoad->SetLoadMode(LOAD_MODE_CV, serialNumber);
+      Serial.print(F("<"));
+      Serial.print(F("Set Load Voltage [mV]: "));
+      Serial.print(serialNumber);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'p')
+    {
+      selectedLoad->SetLoadMode(LOAD_MODE_CP, serialNumber);
+      Serial.print(F("<"));
+      Serial.print(F("Set Load Power [mW]: "));
+      Serial.print(serialNumber);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'r')
+    {
+      selectedLoad->SetLoadMode(LOAD_MODE_CR, serialNumber * 10);
+      Serial.print(F("<"));
+      Serial.print(F("Set Load Resistance [mOhm]: "));
+      Serial.print(serialNumber * 10);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'x')
+    {
+      Serial.print(F("<"));
+      if(loadGroup.GetBoard(serialNumber) != NULL)
+      {
+        selectedLoad = loadGroup.GetBoard(serialNumber);
+        Serial.print(F("board selected: "));
+      }
+      else
+      {
+        Serial.print(F("board not available: "));
+      }
+      Serial.print(serialNumber);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'j')
+    {
+      Serial.print(F("<"));
+      if(myLoad.IsStreaming())
+      {
+        /// the stream acquisition of board 0 drives its ADC
+        Serial.print(F("sync capture not possible while streaming ('sm0e' first)"));
+      }
+      else if(serialNumber)
+      {
+        loadGroup.StartSyncCapture(serialNumber);
+        Serial.print(F("sync capture, channels: "));
+        Serial.print(serialNumber);
+      }
+      else
+      {
+        loadGroup.StartAcquisition();
+        Serial.print(F("interleaved acquisition"));
+      }
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'i')
+    {
+      Serial.print(F("<"));
+      if(serialNumber == 100 || serialNumber == 400)
+      {
+        Wire.setClock(serialNumber * 1000);
+        Serial.print(F("I2C clock [kHz]: "));
+      }
+      else
+      {
+        Serial.print(F("I2C clock not supported [kHz]: "));
+      }
+      Serial.print(serialNumber);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 'u')
+    {
+      uint8_t channel = serialNumber / 100;
+      uint8_t type = (serialNumber / 10) % 10;
+      uint8_t shift = serialNumber % 10;
+
+      Serial.print(F("<"));
+      if(channel < ADC_CH_LAST && type <= FILTER_DECIMATE && selectedLoad->SetFilter((E_ADC_CHANNEL)channel, (E_RL021_FILTER)type, shift))
+      {
+        Serial.print(F("filter set: "));
+      }
+      else
+      {
+        Serial.print(F("filter not supported: "));
+      }
+      Serial.print(serialNumber);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+    else if (serialDigitType == 's')
+    {
+      if(serialNumber == 1)
+      {
+        RL021_Settings::Save(selectedLoad);
+        Serial.println(F("<settings saved>"));
+      }
+      else if(serialNumber == 0)
+      {
+        RL021_Settings::Erase(selectedLoad);
+        Serial.println(F("<settings erased>"));
+      }
+      else
+      {
+        Serial.print(F("<settings command not supported (0: erase, 1: save): "));
+        Serial.print(serialNumber);
+        Serial.print(F(">"));
+        Serial.println();
+      }
+    }
+#if LOAD_CALIBRATION
+    else if (serialDigitType == 'c')
+    {
+      if(!calibration.Start((E_RL021_CAL_TARGET)constrain(serialNumber, (uint32_t)CAL_CURRENT, (uint32_t)CAL_PGA)))
+      {
+        Serial.println(F("<cal not started>"));
+      }
+    }
+    else if (serialDigitType == 'l')
+    {
+      if(!calibration.EnterReference(serialNumber))
+      {
+        Serial.println(F("<cal no reference requested>"));
+      }
+    }
+    else if (serialDigitType == 't')
+    {
+      if(serialNumber == 0)
+      {
+        calibration.Stop();
+        Serial.println(F("<cal aborted>"));
+      }
+      else
+      {
+        if(calibration.GetState() == CAL_REFERENCE)
+        {
+          calibration.Finish();
+          if(calibration.GetState() == CAL_DONE)
+          {
+            sendCalibrationFit();
+          }
+        }
+
+        E_ADC_CHANNEL channel = (calibration.GetTarget() == CAL_VLOAD) ? ADC_CH_VLOAD :
+                                (calibration.GetTarget() == CAL_VEXT) ? ADC_CH_VEXT : ADC_CH_CURRENT;
+        Serial.print(F("<cal "));
+        Serial.print(calibration.Apply((serialNumber == 2) ? &correctionTables[channel] : NULL) ? F("applied") : F("not applied"));
+        Serial.print(F(">"));
+        Serial.println();
+      }
+    }
+#endif
+#if LOAD_BATTERY_TEST
+    else if (serialDigitType == 'y')
+    {
+      batteryCutoff_mV = serialNumber;
+      batteryTest.SetCutoff(batteryCutoff_mV);
+    }
+    else if (serialDigitType == 'z')
+    {
+      batteryTest.SetTailCurrent(serialNumber);
+    }
+    else if (serialDigitType == 'b')
+    {
+      if(serialNumber)
+      {
+        Serial.print(F("<"));
+        Serial.print(F("battery test "));
+        Serial.print(batteryTest.Start(serialNumber) ? F("started, cutoff [mV]: ") : F("not started, cutoff [mV]: "));
+        Serial.print(batteryCutoff_mV);
+        Serial.print(F(">"));
+        Serial.println();
+      }
+      else if(batteryTest.IsRunning())
+      {
+        batteryTest.Stop();
+        sendBatteryTest();
+      }
+    }
+#endif
+#if LOAD_WAVEFORM
+    else if (serialDigitType == 'w')
+    {
+      waveform.ClearTable();
+    }
+    else if (serialDigitType == 'd')
+    {
+      if(!waveform.AddSample(serialNumber))
+      {
+        Serial.println(F("<wave table full>"));
+      }
+    }
+    else if (serialDigitType == 'o')
+    {
+      waveform.SetScaling(serialNumber, waveAmplitude_mA);
+      waveOffset_mA = serialNumber;
+    }
+    else if (serialDigitType == 'h')
+    {
+      waveform.SetScaling(waveOffset_mA, serialNumber);
+      waveAmplitude_mA = serialNumber;
+    }
+    else if (serialDigitType == 'k')
+    {
+      if(!waveform.SetSampleRate(serialNumber))
+      {
+        Serial.println(F("<wave sample rate out of range>"));
+      }
+    }
+    else if (serialDigitType == 'n')
+    {
+      waveform.SetRepeatCount(serialNumber);
+    }
+    else if (serialDigitType == 'g')
+    {
+      if(serialNumber)
+      {
+        Serial.print(F("<"));
+        Serial.print(F("wave "));
+        Serial.print(waveform.Start() ? F("started, samples: ") : F("not started, samples: "));
+        Serial.print(waveform.GetTableLength());
+        Serial.print(F(">"));
+        Serial.println();
+      }
+      else if(waveform.IsRunning())
+      {
+        waveform.Stop();
+      }
+    }
+#endif
+
+
+    readInDigit = false;
+  }
+
+
+}
+
+
+#if LOAD_SCPI
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SCPI command handlers (table scpiCommands), return SCPI_NO_ERROR or a SCPI error number
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint8_t getSelectedBoard()
+{
+  for(uint8_t n=0;n<loadGroup.GetBoardCount();n++)
+  {
+    if(loadGroup.GetBoard(n) == selectedLoad)
+    {
+      return n;
+    }
+  }
+  return 0;
+}
+
+/** Set load mode of the selected board with the setpoint parameter
+ *
+ *  @param RL021_Scpi * scpi -
+ *  @param E_LOAD_MODE mode -
+ *  @param float scale - parameter (A, V, W, Ohm) -> setpoint (mA, mV, mW, mOhm)
+ *  @param float maximum - max. parameter
+ *  @return int16_t - SCPI error number
+ */
+int16_t scpiSetLoadMode(RL021_Scpi * scpi, E_LOAD_MODE mode, float scale, float maximum)
+{
+  float value;
+  int16_t error = scpi->GetNumber(&value);
+
+  if(error != SCPI_NO_ERROR)
+  {
+    return error;
+  }
+  if(value < 0 || value > maximum)
+  {
+    return SCPI_DATA_OUT_OF_RANGE;
+  }
+  /// DAC writes are blocked until the faults are cleared
+  if(selectedLoad->IsShutdown())
+  {
+    return SCPI_EXECUTION_ERROR;
+  }
+
+  selectedLoad->SetLoadMode(mode, (uint32_t)(value * scale + 0.5f));
+  return SCPI_NO_ERROR;
+}
+
+/// Setpoint of the load mode, 0 if the selected board is in another mode
+int16_t scpiQueryLoadMode(RL021_Scpi * scpi, E_LOAD_MODE mode, uint8_t decimals)
+{
+  scpi->ResultNumber((selectedLoad->GetLoadMode() == mode) ? selectedLoad->modeSetpoint / 1000.0f : 0.0f, decimals);
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiIdentify(RL021_Scpi * scpi)
+{
+  scpi->ResultText(F("RedLabs,RL-021/00,0,V0.1"));
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiReset(RL021_Scpi * /*scpi*/)
+{
+#if LOAD_WAVEFORM
+  waveform.Stop();
+#endif
+#if LOAD_BATTERY_TEST
+  if(batteryTest.IsRunning())
+  {
+    batteryTest.Stop();
+  }
+#endif
+  for(uint8_t n=0;n<loadGroup.GetBoardCount();n++)
+  {
+    loadGroup.GetBoard(n)->SetCurrent_mA(0);
+  }
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiClearStatus(RL021_Scpi * scpi)
+{
+  scpi->ClearErrors();
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiCurrent(RL021_Scpi * scpi)
+{
+  return scpiSetLoadMode(scpi, LOAD_MODE_CC, 1000.0f, 9.999f);
+}
+
+/// Current setpoint [A] (CV / CP / CR: actual setpoint of the mode)
+int16_t scpiCurrentQuery(RL021_Scpi * scpi)
+{
+  scpi->ResultNumber(selectedLoad->setpoint_mA / 1000.0f, 3);
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiVoltage(RL021_Scpi * scpi)
+{
+  return scpiSetLoadMode(scpi, LOAD_MODE_CV, 1000.0f, 99.999f);
+}
+
+int16_t scpiVoltageQuery(RL021_Scpi * scpi)
+{
+  return scpiQueryLoadMode(scpi, LOAD_MODE_CV, 3);
+}
+
+int16_t scpiPower(RL021_Scpi * scpi)
+{
+  return scpiSetLoadMode(scpi, LOAD_MODE_CP, 1000.0f, 99.999f);
+}
+
+int16_t scpiPowerQuery(RL021_Scpi * scpi)
+{
+  return scpiQueryLoadMode(scpi, LOAD_MODE_CP, 3);
+}
+
+int16_t scpiResistance(RL021_Scpi * scpi)
+{
+  return scpiSetLoadMode(scpi, LOAD_MODE_CR, 1000.0f, 999.99f);
+}
+
+int16_t scpiResistanceQuery(RL021_Scpi * scpi)
+{
+  return scpiQueryLoadMode(scpi, LOAD_MODE_CR, 3);
+}
+
+int16_t scpiModeQuery(RL021_Scpi * scpi)
+{
+  static const char * modeNames[4] = {"CC", "CV", "CP", "CR"};
+
+  scpi->ResultText(modeNames[selectedLoad->GetLoadMode()]);
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiMeasureCurrent(RL021_Scpi * scpi)
+{
+  scpi->ResultNumber(selectedLoad->GetCurrent_mA() / 1000.0f, 3);
+  return SCPI_NO_ERROR;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Read and Interprete Serial command from PC
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int16_t scpiMeasureVoltage(RL021_Scpi * scpi)
+{
+  scpi->ResultNumber(selectedLoad->GetVoltageLoad_mV() / 1000.0f, 3);
+  return SCPI_NO_ERROR;
+}
 
+int16_t scpiMeasureVoltageExt(RL021_Scpi * scpi)
+{
+  scpi->ResultNumber(selectedLoad->GetVoltageExt_mV() / 1000.0f, 3);
+  return SCPI_NO_ERROR;
+}
 
-///////////////////////////////////////////////////////////////////////////
-/*
-Single character commands:
-'+' Increment DAC +1
-'-' Decrement DAC -1
-'0' Set DAC to 0
-'8' Increment DAC +100
-'2' Decrement DAC -100
-'r' set sendRawInfo TRUE
-'t' set sendRawInfo FALSE
+int16_t scpiMeasureTemperature(RL021_Scpi * scpi)
+{
+  scpi->ResultNumber(selectedLoad->GetTemperature() / 10.0f, 1);
+  return SCPI_NO_ERROR;
+}
 
-Multi character commands:
-'sa' Read ASCII digits (1-9999) 'e' set load current in mA
-'sf' Read ASCII digits (1-9999) 'e' set raw DAC value
+int16_t scpiMeasurePower(RL021_Scpi * scpi)
+{
+  scpi->ResultNumber((float)selectedLoad->GetCurrent_mA() * selectedLoad->GetVoltageLoad_mV() / 1000000.0f, 3);
+  return SCPI_NO_ERROR;
+}
 
-'<' Ignore following characters until '>' received
+/// Current [A], Vload [V], Vext [V], temperature [°C] of one acquisition
+int16_t scpiMeasureAll(RL021_Scpi * scpi)
+{
+  scpiMeasureCurrent(scpi);
+  scpiMeasureVoltage(scpi);
+  scpiMeasureVoltageExt(scpi);
+  return scpiMeasureTemperature(scpi);
+}
+
+int16_t scpiMeasureRaw(RL021_Scpi * scpi)
+{
+  for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+  {
+    scpi->ResultInteger(selectedLoad->GetMeasurement((E_ADC_CHANNEL)ch)->raw);
+  }
+  return SCPI_NO_ERROR;
+}
 
+int16_t scpiRegulation(RL021_Scpi * scpi)
+{
+  bool enable;
+  int16_t error = scpi->GetBoolean(&enable);
 
+  if(error == SCPI_NO_ERROR)
+  {
+    selectedLoad->EnableRegulation(enable);
+  }
+  return error;
+}
 
-*/
-void handleSerialCommand()
+int16_t scpiRegulationQuery(RL021_Scpi * scpi)
 {
-  uint16_t serialNumber = 0;
-                            // E, Z, H, T, ZT
-  static uint8_t number[5] = {0,0,0,0,0};
-  static bool readInDigit = false;
-  static bool firstCharacter = false;
-  static uint8_t serialDigitType = 0;
-  
-  /// Read single character via serial port
-  char c = (Serial.read());
+  scpi->ResultInteger(selectedLoad->regulationEnabled);
+  return SCPI_NO_ERROR;
+}
 
-  /// Check for multi character command start sign
-  if(c == 's' && readInDigit == false)
+int16_t scpiResolution(RL021_Scpi * scpi)
+{
+  int32_t resolution;
+  int16_t error = scpi->GetInteger(&resolution);
+
+  if(error != SCPI_NO_ERROR)
   {
-    readInDigit = true;
-    firstCharacter = true;  
+    return error;
   }
-  else if(firstCharacter == true)
+  if(resolution != 12 && resolution != 14 && resolution != 16)
   {
-    serialDigitType = c;
-    readInDigit = true;
-    firstCharacter = false;
+    return SCPI_DATA_OUT_OF_RANGE;
   }
-  /// Check for multi character commands data
-  if(readInDigit)
+  /// stream runs with its own resolution ('sm')
+  if(selectedLoad->IsStreaming())
   {
-      if(c >= 48 && c <= 57)//ASCII '0'-'9'
-      {
-        uint8_t newDigit;  
-        newDigit = c - 48; //ASCII '0'-'9' to integer
-        number[4] = number[3]; //ZT
-        number[3] = number[2]; //T
-        number[2] = number[1]; //H
-        number[1] = number[0]; //Z
-        number[0] = newDigit; //E      
-      }    
+    return SCPI_SETTINGS_CONFLICT;
   }
 
-  /// Single character commands
-  if(readInDigit == false)
+  selectedLoad->SetAdcResolution(resolution);
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiResolutionQuery(RL021_Scpi * scpi)
+{
+  scpi->ResultInteger(selectedLoad->GetAdcResolution());
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiBoard(RL021_Scpi * scpi)
+{
+  int32_t board;
+  int16_t error = scpi->GetInteger(&board);
+
+  if(error != SCPI_NO_ERROR)
   {
-      switch (c)
-      {
-        case '+': //increment DAC small step
-            DAC_IncrementRaw(1, 0, 0);
-          break;
-        case '-': //decrement DAC small step
-            DAC_IncrementRaw(0, 0, 0);
-          break;
-        case '0': //set DAC to 0
-            DAC_IncrementRaw(0, 0, 1);
-          break;
-        case '8': ///increment DAC big step
-            DAC_IncrementRaw(1, 1, 0);
-          break;
-        case '2': //decrement DAC bif step
-            DAC_IncrementRaw(0, 1, 0);
-          break;
-        case 'r':
-              sendRawInfo = true;
-          break;
-        case 't':
-              sendRawInfo = false;
-          break;
-        case '5':
-          
-          break;
-        case '6':
-          
-          break;
-        case '7':
-          
-          break;
-        case '9':
-          break;
-        default:
-          Serial.println("single command unknown");
-          break;
-      }
+    return error;
   }
-
-  /// Check for multi character command end sign
-  if(c == 'e' && readInDigit == true)
+  if(board < 0 || board >= loadGroup.GetBoardCount())
   {
-    serialNumber = number[0] + number[1]*10 + number[2]*100 + number[3]*1000 + number[4]*10000;
-    number[4] = 0;
-    number[3] = 0;
-    number[2] = 0;
-    number[1] = 0;
-    number[0] = 0;
+    return SCPI_DATA_OUT_OF_RANGE;
+  }
 
-    if(serialDigitType == 'a')
-    {
-      //set read in number to DAC
-      myLoad.SetCurrent_mA(serialNumber);   
-      Serial.print("<");
-      Serial.print("Set Load Current [mA]: ");
-      Serial.print(serialNumber);
-      Serial.print(">");
-      Serial.println();
-    }
-    else if (serialDigitType == 'f')
-    {
-      myLoad.SetRawDac(serialNumber);
-      Serial.print("<");
-      Serial.print("raw DAC set: ");
-      Serial.print(serialNumber);
-      Serial.print(">");
-      Serial.println();
-    }
+  selectedLoad = loadGroup.GetBoard(board);
+  return SCPI_NO_ERROR;
+}
 
+int16_t scpiBoardQuery(RL021_Scpi * scpi)
+{
+  scpi->ResultInteger(getSelectedBoard());
+  return SCPI_NO_ERROR;
+}
 
-    readInDigit = false;
-  }
+/// Latched faults of the selected board (RL021_FAULT_xxx bits, 0: ok)
+int16_t scpiProtectionQuery(RL021_Scpi * scpi)
+{
+  scpi->ResultInteger(supervisor.GetFaults(getSelectedBoard()));
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiProtectionClear(RL021_Scpi * /*scpi*/)
+{
+  supervisor.ClearFaults(getSelectedBoard());
+  return SCPI_NO_ERROR;
+}
+
+int16_t scpiSave(RL021_Scpi * /*scpi*/)
+{
+  RL021_Settings::Save(selectedLoad);
+  return SCPI_NO_ERROR;
+}
 
+/// Oldest error of the queue: number,"text"
+int16_t scpiError(RL021_Scpi * scpi)
+{
+  int16_t error = scpi->PopError();
+
+  scpi->ResultInteger(error);
+  scpi->ResultString(RL021_Scpi::GetErrorText(error));
+  return SCPI_NO_ERROR;
+}
 
+int16_t scpiErrorCount(RL021_Scpi * scpi)
+{
+  scpi->ResultInteger(scpi->GetErrorCount());
+  return SCPI_NO_ERROR;
 }
+#endif
 
 
 /** Quick & Dirty function to increment/decrement DAC counts
@@ -361,9 +1387,9 @@ void DAC_IncrementRaw(bool increment, bool bigStep, bool reset)
   } 
   
   //DAC_mcp47x6->setVOut(dacCounts);
-  myLoad.SetRawDac(dacCounts);
+  selectedLoad->SetRawDac(dacCounts);
   /*
-  Serial.print("DAC counts: ");
+  Serial.print(F("DAC counts: "));
   Serial.print(dacCounts);
   Serial.println();
   */
@@ -417,7 +1443,7 @@ void calibrateCurrent()
       }   
 
       myLoad.SetRawDac(dacCounts);
-      Serial.print("DAC counts: ");
+      Serial.print(F("DAC counts: "));
       Serial.print(dacCounts);
       Serial.println();
   }
@@ -431,22 +1457,22 @@ void calibrateVoltage()
   int16_t rawAdc = 0;
 
   rawAdc = myLoad.GetRawAdc(ADC_CH_CURRENT);
-  Serial.print("ADC counts current: ");
+  Serial.print(F("ADC counts current: "));
   Serial.print(rawAdc);
   Serial.println();
 
   rawAdc = myLoad.GetRawAdc(ADC_CH_VLOAD);
-  Serial.print("ADC counts Vload: ");
+  Serial.print(F("ADC counts Vload: "));
   Serial.print(rawAdc);
   Serial.println();
 
   rawAdc = myLoad.GetRawAdc(ADC_CH_VEXT);
-  Serial.print("ADC counts Vext: ");
+  Serial.print(F("ADC counts Vext: "));
   Serial.print(rawAdc);
   Serial.println();
 
   rawAdc = myLoad.GetRawAdc(ADC_CH_NTC);
-  Serial.print("ADC counts NTC: ");
+  Serial.print(F("ADC counts NTC: "));
   Serial.print(rawAdc);
   Serial.println();  
 
@@ -523,6 +1549,312 @@ void Square(uint16_t currentLevel)
 // Print Info
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////
+/// Send stream buffer as binary block if it is half full (or every 100ms)
+void sendStream()
+{
+  if(myLoad.StreamAvailable() >= RL021_STREAM_BUFFER_SIZE / 2 || (millis() - lastStreamBlock_ms > 100 && myLoad.StreamAvailable() > 0))
+  {
+    binaryProtocol.SendStream(&myLoad, sendRawInfo);
+    lastStreamBlock_ms = millis();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/// Send I2C bus statistics of DAC and ADC driver of all boards and reset them
+/*
+ * sx<n>e (board number, only with LOAD_BOARDS > 1)
+ * <i2c dac: tr=.. bytes=.. nack=.. lat_us=min/avg/max>
+ * <i2c adc: tr=.. bytes=.. nack=.. lat_us=min/avg/max conv=.. polls=avg/max>
+ */
+void sendI2CStatistics()
+{
+#ifdef I2C_STATISTICS
+  for(uint8_t n=0;n<loadGroup.GetBoardCount();n++)
+  {
+    RL021_DigitalLoad * load = loadGroup.GetBoard(n);
+    if(LOAD_BOARDS > 1)
+    {
+      Serial.print(F("sx"));
+      Serial.print(n);
+      Serial.print(F("e"));
+      Serial.println();
+    }
+    printI2CStatistics(F("dac"), load->deviceDAC->getStatistics());
+    printI2CStatistics(F("adc"), load->deviceADC->GetStatistics());
+    load->deviceDAC->resetStatistics();
+    load->deviceADC->ResetStatistics();
+  }
+  if(loadGroup.IsSyncCapture())
+  {
+    Serial.print(F("<sync: snapshots="));
+    Serial.print(loadGroup.GetSnapshotCount());
+    Serial.print(F(" errors="));
+    Serial.print(loadGroup.GetSyncErrors());
+    Serial.print(F(">"));
+    Serial.println();
+  }
+#else
+  Serial.println(F("<i2c statistics disabled>"));
+#endif
+}
+
+void printI2CStatistics(const __FlashStringHelper * device, const S_I2C_STATISTICS * statistics)
+{
+  Serial.print(F("<i2c "));
+  Serial.print(device);
+  Serial.print(F(": tr="));
+  Serial.print(statistics->transactions);
+  Serial.print(F(" bytes="));
+  Serial.print(statistics->bytes);
+  Serial.print(F(" nack="));
+  Serial.print(statistics->nacks);
+  Serial.print(F(" lat_us="));
+  if(statistics->transactions > 0)
+  {
+    Serial.print(statistics->latencyMin_us);
+    Serial.print(F("/"));
+    Serial.print(statistics->latencySum_us / statistics->transactions);
+    Serial.print(F("/"));
+    Serial.print(statistics->latencyMax_us);
+  }
+  else
+  {
+    Serial.print(F("-"));
+  }
+  if(statistics->conversions > 0)
+  {
+    Serial.print(F(" conv="));
+    Serial.print(statistics->conversions);
+    Serial.print(F(" polls="));
+    Serial.print((float)statistics->polls / statistics->conversions);
+    Serial.print(F("/"));
+    Serial.print(statistics->pollsMax);
+  }
+  Serial.print(F(">"));
+  Serial.println();
+}
+
+#if LOAD_BATTERY_TEST
+///////////////////////////////////////////////////////////////////////////
+/// Send battery test summary and discharge curve
+/*
+ * <bat: state=.. t_s=.. mAh=.. tail_mAh=.. mWh=.. V=start/min/end>
+ * <batc: t_s=.. V=.. I=.. mAh=..>  one line per curve point
+ * state: 0 idle, 1 CC, 2 tail, 3 done (cutoff), 4 aborted
+ */
+void sendBatteryTest()
+{
+  const S_RL021_BatterySummary * summary = batteryTest.GetSummary();
+
+  Serial.print(F("<bat: state="));
+  Serial.print(summary->state);
+  Serial.print(F(" t_s="));
+  Serial.print(summary->duration_ms / 1000);
+  Serial.print(F(" mAh="));
+  Serial.print(summary->charge_uAh / 1000.0, 3);
+  Serial.print(F(" tail_mAh="));
+  Serial.print(summary->tailCharge_uAh / 1000.0, 3);
+  Serial.print(F(" mWh="));
+  Serial.print(summary->energy_uWh / 1000.0, 3);
+  Serial.print(F(" V="));
+  Serial.print(summary->startVoltage_mV);
+  Serial.print(F("/"));
+  Serial.print(summary->minVoltage_mV);
+  Serial.print(F("/"));
+  Serial.print(summary->endVoltage_mV);
+  Serial.print(F(">"));
+  Serial.println();
+
+  for(uint8_t i=0;i<batteryTest.GetCurvePoints();i++)
+  {
+    const S_RL021_BatteryPoint * point = batteryTest.GetCurvePoint(i);
+
+    Serial.print(F("<batc: t_s="));
+    Serial.print(point->time_ms / 1000);
+    Serial.print(F(" V="));
+    Serial.print(point->voltage_mV);
+    Serial.print(F(" I="));
+    Serial.print(point->current_mA);
+    Serial.print(F(" mAh="));
+    Serial.print(point->charge_uAh / 1000.0, 3);
+    Serial.print(F(">"));
+    Serial.println();
+  }
+}
+#endif
+
+#if LOAD_CALIBRATION
+///////////////////////////////////////////////////////////////////////////
+/// Calibration
+/*
+ * <cal point n/N dac=..: enter reference 'sl'...'e'>
+ * <cal adc: slope=.. offset=.. maxres=.. points=..>
+ * <cal dac: ...> (current only)
+ */
+void sendCalibrationRequest()
+{
+  Serial.print(F("<cal point "));
+  Serial.print(calibration.GetPointCount() + 1);
+  if(calibration.GetTarget() == CAL_CURRENT)
+  {
+    Serial.print(F(" dac="));
+    Serial.print(calibration.GetActualDac());
+  }
+  Serial.print(F(": enter reference 'sl'...'e'>"));
+  Serial.println();
+}
+
+void sendCalibrationFit()
+{
+  if(calibration.GetTarget() == CAL_PGA)
+  {
+    printCalibrationFit(F("pga x2"), calibration.GetPgaFit(1));
+    printCalibrationFit(F("pga x4"), calibration.GetPgaFit(2));
+    printCalibrationFit(F("pga x8"), calibration.GetPgaFit(3));
+    return;
+  }
+
+  printCalibrationFit(F("adc"), calibration.GetAdcFit());
+  if(calibration.GetTarget() == CAL_CURRENT)
+  {
+    printCalibrationFit(F("dac"), calibration.GetDacFit());
+  }
+}
+
+void printCalibrationFit(const __FlashStringHelper * name, const S_RL021_CalFit * fit)
+{
+  Serial.print(F("<cal "));
+  Serial.print(name);
+  if(fit->valid)
+  {
+    Serial.print(F(": slope="));
+    Serial.print(fit->slope, 6);
+    Serial.print(F(" offset="));
+    Serial.print(fit->offset, 2);
+    Serial.print(F(" maxres="));
+    Serial.print(fit->maxResidual, 2);
+  }
+  else
+  {
+    Serial.print(F(": no fit"));
+  }
+  Serial.print(F(" points="));
+  Serial.print(calibration.GetPointCount());
+  Serial.print(F(">"));
+  Serial.println();
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////
+/// Send statistics of all tasks and reset them
+/*
+ * <task control: T_us=.. runs=.. overruns=.. delay_us=max dur_us=max>
+ */
+void sendTaskStatistics()
+{
+  for(uint8_t i=0;i<scheduler.GetTaskCount();i++)
+  {
+    const S_RL021_Task * task = scheduler.GetTask(i);
+
+    Serial.print(F("<task "));
+    Serial.print(task->name);
+    Serial.print(F(": T_us="));
+    Serial.print(task->period_us);
+    Serial.print(F(" runs="));
+    Serial.print(task->runs);
+    Serial.print(F(" overruns="));
+    Serial.print(task->overruns);
+    Serial.print(F(" delay_us="));
+    Serial.print(task->delayMax_us);
+    Serial.print(F(" dur_us="));
+    Serial.print(task->durationMax_us);
+    Serial.print(F(">"));
+    Serial.println();
+  }
+  scheduler.ResetStatistics();
+}
+
+///////////////////////////////////////////////////////////////////////////
+/// Send supervisor state of all boards
+/*
+ * <supervisor board 0: faults=OT,OP,OC,SOA,STALE,UNSUPERVISED | ok derating=../256 trips=..>
+ * <trip board 0: I_mA=.. V_mV=.. T_Cx10=.. lat_us=..>      (after a trip)
+ */
+void sendSupervisorStatus()
+{
+  static const char * faultNames[6] = {"OT", "OP", "OC", "SOA", "STALE", "UNSUPERVISED"};
+
+  for(uint8_t n=0;n<supervisor.GetBoardCount();n++)
+  {
+    const S_RL021_SupervisorStatus * status = supervisor.GetStatus(n);
+
+    Serial.print(F("<supervisor board "));
+    Serial.print(n);
+    Serial.print(F(": faults="));
+    if(status->faults == 0)
+    {
+      Serial.print(F("ok"));
+    }
+    bool first = true;
+    for(uint8_t i=0;i<6;i++)
+    {
+      if(status->faults & (1<<i))
+      {
+        if(!first)
+        {
+          Serial.print(',');
+        }
+        Serial.print(faultNames[i]);
+        first = false;
+      }
+    }
+    Serial.print(F(" derating="));
+    Serial.print(status->derating);
+    Serial.print(F("/256 trips="));
+    Serial.print(status->trips);
+    Serial.print(F(">"));
+    Serial.println();
+
+    if(status->trips > 0)
+    {
+      Serial.print(F("<trip board "));
+      Serial.print(n);
+      Serial.print(F(": I_mA="));
+      Serial.print(status->tripCurrent_mA);
+      Serial.print(F(" V_mV="));
+      Serial.print(status->tripVoltage_mV);
+      Serial.print(F(" T_Cx10="));
+      Serial.print(status->tripTemperature);
+      Serial.print(F(" lat_us="));
+      Serial.print(status->tripLatency_us);
+      Serial.print(F(">"));
+      Serial.println();
+    }
+  }
+}
+
+#if LOAD_WAVEFORM
+///////////////////////////////////////////////////////////////////////////
+// Timing of the last waveform run
+// <wave: samples= missed= lat_us=min/max>
+void sendWaveformStatistics()
+{
+  const S_RL021_WaveStatistics * statistics = waveform.GetStatistics();
+
+  Serial.print(F("<wave: samples="));
+  Serial.print(statistics->samples);
+  Serial.print(F(" missed="));
+  Serial.print(statistics->missed);
+  Serial.print(F(" lat_us="));
+  Serial.print(statistics->samples > 1 ? statistics->latencyMin_us : 0);
+  Serial.print(F("/"));
+  Serial.print(statistics->latencyMax_us);
+  Serial.print(F(">"));
+  Serial.println();
+}
+#endif
+
 ///////////////////////////////////////////////////////////////////////////
 /// Send values in SI units
 /*
@@ -531,26 +1863,26 @@ void Square(uint16_t currentLevel)
  * 's'c'...'e'  extern voltage in mV
  * 's'd'...'e'  NTC temp in °Cx10
  */
-void sendInfoProtocol()
+void sendInfoProtocol(RL021_DigitalLoad * load)
 {
-  Serial.print("sa");
-  Serial.print(myLoad.GetCurrent_mA());
-  Serial.print("e");
+  Serial.print(F("sa"));
+  Serial.print(load->GetCurrent_mA());
+  Serial.print(F("e"));
   Serial.println();
 
-  Serial.print("sb");
-  Serial.print(myLoad.GetVoltageLoad_mV());
-  Serial.print("e");
+  Serial.print(F("sb"));
+  Serial.print(load->GetVoltageLoad_mV());
+  Serial.print(F("e"));
   Serial.println();
 
-  Serial.print("sc");
-  Serial.print(myLoad.GetVoltageExt_mV());
-  Serial.print("e");
+  Serial.print(F("sc"));
+  Serial.print(load->GetVoltageExt_mV());
+  Serial.print(F("e"));
   Serial.println();
 
-  Serial.print("sd");
-  Serial.print(myLoad.GetTemperature());
-  Serial.print("e");
+  Serial.print(F("sd"));
+  Serial.print(load->GetTemperature());
+  Serial.print(F("e"));
   Serial.println();   
 }
 
@@ -562,27 +1894,27 @@ void sendInfoProtocol()
  * 's'h'...'e'  extern voltage channel
  * 's'i'...'e'  NTC temp channel
  */
-void sendRawInfoProtocol()
+void sendRawInfoProtocol(RL021_DigitalLoad * load)
 {
   //////////
-  Serial.print("sf");
-  Serial.print(myLoad.GetRawAdc(ADC_CH_CURRENT));
-  Serial.print("e");
+  Serial.print(F("sf"));
+  Serial.print(load->GetMeasurement(ADC_CH_CURRENT)->raw);
+  Serial.print(F("e"));
   Serial.println();
 
-  Serial.print("sg");
-  Serial.print(myLoad.GetRawAdc(ADC_CH_VLOAD));
-  Serial.print("e");
+  Serial.print(F("sg"));
+  Serial.print(load->GetMeasurement(ADC_CH_VLOAD)->raw);
+  Serial.print(F("e"));
   Serial.println();
 
-  Serial.print("sh");
-  Serial.print(myLoad.GetRawAdc(ADC_CH_VEXT));
-  Serial.print("e");
+  Serial.print(F("sh"));
+  Serial.print(load->GetMeasurement(ADC_CH_VEXT)->raw);
+  Serial.print(F("e"));
   Serial.println();
 
-  Serial.print("si");
-  Serial.print(myLoad.GetRawAdc(ADC_CH_NTC));
-  Serial.print("e");
+  Serial.print(F("si"));
+  Serial.print(load->GetMeasurement(ADC_CH_NTC)->raw);
+  Serial.print(F("e"));
   Serial.println();  
 }
 
@@ -591,19 +1923,19 @@ void sendRawInfoProtocol()
 /// Send readable info to console
 void sendInfo()
 {
-  Serial.print("ADC: current [mA]: ");
+  Serial.print(F("ADC: current [mA]: "));
   Serial.print(myLoad.GetCurrent_mA());
   Serial.println();
 
-  Serial.print("ADC: load voltage [mV]: ");
+  Serial.print(F("ADC: load voltage [mV]: "));
   Serial.print(myLoad.GetVoltageLoad_mV());
   Serial.println();
 
-  Serial.print("ADC: ext voltage [mV]: ");
+  Serial.print(F("ADC: ext voltage [mV]: "));
   Serial.print(myLoad.GetVoltageExt_mV());
   Serial.println();
 
-  Serial.print("ADC: NTC temp [C x10]: ");
+  Serial.print(F("ADC: NTC temp [C x10]: "));
   Serial.print(myLoad.GetTemperature());
   Serial.println();
   
@@ -0,0 +1,232 @@
+#include "I2C_Engine.h"
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+I2C_Engine::I2C_Engine()
+{
+    head = 0;
+    count = 0;
+}
+
+/************************************************************************************************************************************************/
+/* Public - queue handling
+/************************************************************************************************************************************************/
+/** Add transaction to queue
+ *
+ *  @param const S_I2C_TRANSACTION * transaction - transaction is copied, caller can reuse it
+ *	@return bool - (true): queued, (false): queue full or invalid length
+ */
+bool I2C_Engine::Submit(const S_I2C_TRANSACTION * transaction)
+{
+    if(count >= I2C_ENGINE_QUEUE_SIZE || transaction->length > I2C_ENGINE_MAX_DATA)
+    {
+        return false;
+    }
+
+    uint8_t tail = (head + count) % I2C_ENGINE_QUEUE_SIZE;
+    queue[tail] = *transaction;
+    queue[tail].status = I2C_STATUS_PENDING;
+    count++;
+
+    return true;
+}
+
+/** Execute the oldest queued transaction and notify its client
+ *  Client may submit new transactions from within the notification
+ *
+ *  @param /
+ *	@return bool - (true): transaction executed, (false): queue empty
+ */
+bool I2C_Engine::Service()
+{
+    if(count == 0)
+    {
+        return false;
+    }
+
+    /// Remove from queue before execution (client may submit from callback)
+    S_I2C_TRANSACTION transaction = queue[head];
+    head = (head + 1) % I2C_ENGINE_QUEUE_SIZE;
+    count--;
+
+    Execute(&transaction);
+
+    if(transaction.client != NULL)
+    {
+        transaction.client->I2C_TransactionDone(&transaction);
+    }
+
+    return true;
+}
+
+/// Execute all queued transactions (blocking)
+void I2C_Engine::Flush()
+{
+    while(Service());
+}
+
+/** Execute the queued transactions of one client in order (blocking), e.g. for a blocking driver call.
+ *  Transactions of other clients (other boards on the bus) stay queued, they are executed by Service().
+ *
+ *  @param const I2C_Client * client -
+ *	@return /
+ */
+void I2C_Engine::Flush(const I2C_Client * client)
+{
+    uint8_t position = 0;
+
+    while(position < count)
+    {
+        uint8_t index = (head + position) % I2C_ENGINE_QUEUE_SIZE;
+        if(queue[index].client != client)
+        {
+            position++;
+            continue;
+        }
+
+        /// Remove from queue before execution (client may submit from callback)
+        S_I2C_TRANSACTION transaction = queue[index];
+        Remove(position);
+
+        Execute(&transaction);
+        if(transaction.client != NULL)
+        {
+            transaction.client->I2C_TransactionDone(&transaction);
+        }
+    }
+}
+
+/// Number of queued transactions
+uint8_t I2C_Engine::Pending()
+{
+    return count;
+}
+
+/// Check for free queue entries
+bool I2C_Engine::IsFull()
+{
+    return (count >= I2C_ENGINE_QUEUE_SIZE);
+}
+
+/** Remove all queued transactions of a client, order of the remaining transactions is kept
+ *  (e.g. DAC writes which must not overwrite an emergency value written directly on the bus)
+ *
+ *  @param const I2C_Client * client -
+ *	@return uint8_t - removed transactions
+ */
+uint8_t I2C_Engine::Cancel(const I2C_Client * client)
+{
+    uint8_t kept = 0;
+    uint8_t removed = 0;
+
+    for(uint8_t i=0;i<count;i++)
+    {
+        uint8_t index = (head + i) % I2C_ENGINE_QUEUE_SIZE;
+        if(queue[index].client == client)
+        {
+            removed++;
+        }
+        else
+        {
+            if(removed > 0)
+            {
+                queue[(head + kept) % I2C_ENGINE_QUEUE_SIZE] = queue[index];
+            }
+            kept++;
+        }
+    }
+
+    count = kept;
+    return removed;
+}
+
+/************************************************************************************************************************************************/
+/* Public - statistics
+/************************************************************************************************************************************************/
+void I2C_Engine::ResetStatistics(S_I2C_STATISTICS * statistics)
+{
+    memset(statistics, 0, sizeof(S_I2C_STATISTICS));
+    statistics->latencyMin_us = 0xFFFF;
+}
+
+/** Count transaction in driver statistics
+ *
+ *  @param S_I2C_STATISTICS * statistics -
+ *  @param uint8_t bytes - data bytes written / read
+ *  @param bool acknowledged - (false): NACK / incomplete read
+ *  @param uint32_t latency_us - bus time of the transaction
+ *	@return /
+ */
+void I2C_Engine::AddTransaction(S_I2C_STATISTICS * statistics, uint8_t bytes, bool acknowledged, uint32_t latency_us)
+{
+    if(latency_us > 0xFFFF)
+    {
+        latency_us = 0xFFFF;
+    }
+
+    statistics->transactions++;
+    statistics->bytes += bytes;
+    statistics->latencySum_us += latency_us;
+
+    if(!acknowledged)
+    {
+        statistics->nacks++;
+    }
+    if(latency_us < statistics->latencyMin_us)
+    {
+        statistics->latencyMin_us = latency_us;
+    }
+    if(latency_us > statistics->latencyMax_us)
+    {
+        statistics->latencyMax_us = latency_us;
+    }
+}
+
+/************************************************************************************************************************************************/
+/* Private - queue
+/************************************************************************************************************************************************/
+void I2C_Engine::Remove(uint8_t position)
+{
+    for(uint8_t i=position;i+1<count;i++)
+    {
+        queue[(head + i) % I2C_ENGINE_QUEUE_SIZE] = queue[(head + i + 1) % I2C_ENGINE_QUEUE_SIZE];
+    }
+    count--;
+}
+
+/************************************************************************************************************************************************/
+/* Private - Wire interface
+/************************************************************************************************************************************************/
+void I2C_Engine::Execute(S_I2C_TRANSACTION * transaction)
+{
+#ifdef I2C_STATISTICS
+    uint32_t start_us = micros();
+#endif
+
+    if(transaction->type == I2C_TRANSACTION_WRITE)
+    {
+        Wire.beginTransmission(transaction->address);
+        for(uint8_t i=0;i<transaction->length;i++)
+        {
+            Wire.write(transaction->data[i]);
+        }
+        transaction->status = (Wire.endTransmission() == 0) ? I2C_STATUS_OK : I2C_STATUS_ERROR;
+    }
+    else
+    {
+        uint8_t received = Wire.requestFrom(transaction->address, transaction->length);
+        uint8_t i = 0;
+        while(Wire.available() && i < transaction->length)
+        {
+            transaction->data[i++] = Wire.read();
+        }
+        transaction->status = (received == transaction->length && i == received) ? I2C_STATUS_OK : I2C_STATUS_ERROR;
+    }
+
+#ifdef I2C_STATISTICS
+    uint32_t duration_us = micros() - start_us;
+    transaction->duration_us = (duration_us > 0xFFFF) ? 0xFFFF : duration_us;
+#endif
+}
@@ -0,0 +1,163 @@
+/**
+* \file    I2C_Engine.h
+* \brief    Queue based I2C transaction engine (non-blocking interface for MCP3428 and MCP47x6 drivers)
+* \brief    Required drivers: Wire.h
+*
+* \brief    basic functions:
+*               submit write/read transactions to a fixed size queue
+*               execute one queued transaction per Service() call (call frequently from loop)
+*               notify the submitting driver (I2C_Client) when a transaction is done
+*               bus time of each transaction for driver statistics (I2C_STATISTICS)
+*
+*               Drivers never wait for the device, they only wait for their turn on the bus.
+*               A single Wire transaction is still executed synchronously (max. 3 data bytes, ~0.4ms @100kHz).
+*
+* \par     Editor
+*           17.10.2026 first implementation: queue based I2C engine, non-blocking ADC conversions and DAC writes
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _I2C_Engine_H_
+#define _I2C_Engine_H_
+
+#include <Arduino.h>
+#include <Wire.h>
+
+/// max. data bytes of a single transaction (MCP3428 result read: 3, MCP47x6 command write: 3)
+#define I2C_ENGINE_MAX_DATA     3
+
+/// number of transactions which can be queued (per board: 1 ADC transaction + DAC writes, see RL021_LoadGroup.h;
+/// host simulation: no difference to 16 up to 8 boards, synchronized capture included)
+#ifndef I2C_ENGINE_QUEUE_SIZE
+#define I2C_ENGINE_QUEUE_SIZE   8
+#endif
+
+/// Drivers count transactions, bytes, NACKs and latency (S_I2C_STATISTICS), comment out to save RAM and flash
+#define I2C_STATISTICS
+
+/************************************************************************/
+/* Enums                                                                */
+/************************************************************************/
+typedef enum
+{
+    I2C_TRANSACTION_WRITE,
+    I2C_TRANSACTION_READ
+
+} E_I2C_TRANSACTION_TYPE;
+
+typedef enum
+{
+    I2C_STATUS_PENDING,
+    I2C_STATUS_OK,
+    I2C_STATUS_ERROR
+
+} E_I2C_STATUS;
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+class I2C_Client;
+
+typedef struct
+{
+    /// Driver to notify when transaction is done (NULL: fire and forget)
+    I2C_Client * client;
+    /// Client defined identifier of the transaction
+    uint8_t tag;
+
+    /// 7-bit device address
+    uint8_t address;
+    /// E_I2C_TRANSACTION_TYPE
+    uint8_t type;
+    /// bytes to write / bytes to read
+    uint8_t length;
+    /// write: data to send, read: received data
+    uint8_t data[I2C_ENGINE_MAX_DATA];
+    /// E_I2C_STATUS
+    uint8_t status;
+#ifdef I2C_STATISTICS
+    /// bus time of the transaction [us] (set by I2C_Engine)
+    uint16_t duration_us;
+#endif
+
+} S_I2C_TRANSACTION;
+
+/// Bus usage of a driver
+typedef struct
+{
+    uint32_t transactions;
+    /// data bytes (without address byte)
+    uint32_t bytes;
+    /// transactions not acknowledged
+    uint32_t nacks;
+    /// transaction latency (bus time) [us]
+    uint32_t latencySum_us;
+    uint16_t latencyMin_us;
+    uint16_t latencyMax_us;
+
+    /// ADC: completed conversions and result reads (data ready polls)
+    uint32_t conversions;
+    uint32_t polls;
+    /// max. polls of a single conversion
+    uint16_t pollsMax;
+
+} S_I2C_STATISTICS;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+/// Interface for drivers using the I2C_Engine
+class I2C_Client {
+  public:
+    /// Called by I2C_Engine::Service() after the transaction is executed
+    virtual void I2C_TransactionDone(const S_I2C_TRANSACTION * transaction) = 0;
+};
+
+
+class I2C_Engine {
+
+ public:
+    I2C_Engine();
+
+    /// Copy transaction to queue - returns false if queue is full
+    bool Submit(const S_I2C_TRANSACTION * transaction);
+
+    /// Execute next queued transaction - returns false if queue was empty
+    bool Service();
+
+    /// Execute all queued transactions (blocking)
+    void Flush();
+
+    /// Execute the queued transactions of a client only (blocking), the others stay queued in order
+    void Flush(const I2C_Client * client);
+
+    /// Number of queued transactions
+    uint8_t Pending();
+
+    /// Check for free queue entries
+    bool IsFull();
+
+    /// Remove queued transactions of a client without execution (no notification) - returns number removed
+    uint8_t Cancel(const I2C_Client * client);
+
+    /// Driver statistics helpers
+    static void ResetStatistics(S_I2C_STATISTICS * statistics);
+    static void AddTransaction(S_I2C_STATISTICS * statistics, uint8_t bytes, bool acknowledged, uint32_t latency_us);
+
+ private:
+    /// Execute transaction on bus and set status
+    void Execute(S_I2C_TRANSACTION * transaction);
+
+    /// Remove queue entry (position after head), order of the others is kept
+    void Remove(uint8_t position);
+
+    /// Ring buffer of queued transactions
+    S_I2C_TRANSACTION queue[I2C_ENGINE_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+};
+
+#endif /* _I2C_Engine_H_ */
@@ -19,14 +19,31 @@
 MCP3428::MCP3428(uint8_t devAddress)
 {
     Wire.begin();
-    devAddr = 1101<<3;
+    devAddr = 0b1101<<3;
     devAddr |= devAddress;
+    engine = NULL;
+    state = conversionidle;
+    armedValid = false;
+    SPS = 16;
+    MODE = 0;
+    conversionPolls = 0;
+    I2C_Engine::ResetStatistics(&statistics);
 }
 
 MCP3428::~MCP3428()
 {
 }
 
+/***************************************************************************/
+/*
+        7-bit I2C address (0x68 + A2, A1, A0)
+*/
+/***************************************************************************/
+uint8_t MCP3428::GetAddress()
+{
+    return devAddr;
+}
+
 /***************************************************************************/
 /*
         Verify the I2C connection and Sets up the Hardware
@@ -34,8 +51,15 @@ MCP3428::~MCP3428()
 /***************************************************************************/
 bool MCP3428::testConnection()
 {
+#ifdef I2C_STATISTICS
+    uint32_t start_us = micros();
+#endif
     Wire.beginTransmission(devAddr);
-    return (Wire.endTransmission() == 0);
+    bool acknowledged = (Wire.endTransmission() == 0);
+#ifdef I2C_STATISTICS
+    I2C_Engine::AddTransaction(&statistics, 0, acknowledged, micros() - start_us);
+#endif
+    return acknowledged;
 }
 
 /**************************************************************************/
@@ -48,6 +72,43 @@ bool MCP3428::testConnection()
 */
 /**************************************************************************/
 void MCP3428::SetConfiguration(uint8_t channel, uint8_t resolution, bool mode, uint8_t PGA)
+{
+    if(engine != NULL)
+    {
+        // queued transactions of this device first, then start conversion via engine
+        // (transactions of other devices on the bus stay queued)
+        engine->Flush(this);
+        StartConversion(channel, resolution, mode, PGA);
+        engine->Flush(this);
+        return;
+    }
+
+    config = BuildConfiguration(channel, resolution, mode, PGA);
+    armedValid = false;
+
+    // Start a conversion using configuration settings
+#ifdef I2C_STATISTICS
+    uint32_t start_us = micros();
+#endif
+    conversionPolls = 0;
+    Wire.beginTransmission(devAddr);
+    // 128: This bit is the data ready flag
+    // One-Shot Conversion mode
+    // Initiate a new conversion
+    Wire.write(config);
+    bool acknowledged = (Wire.endTransmission() == 0);
+#ifdef I2C_STATISTICS
+    I2C_Engine::AddTransaction(&statistics, 1, acknowledged, micros() - start_us);
+#endif
+}
+
+/**************************************************************************/
+/*
+        Build the Configuration register value (incl. data ready flag),
+        stores Resolution, Mode and PGA Gain for decoding the result
+*/
+/**************************************************************************/
+uint8_t MCP3428::BuildConfiguration(uint8_t channel, uint8_t resolution, bool mode, uint8_t PGA)
 {
     GAIN = PGA;
 
@@ -61,39 +122,34 @@ void MCP3428::SetConfiguration(uint8_t channel, uint8_t resolution, bool mode, u
     }
 
     MODE = mode;
-    config = 0;
-    config = config<<2;
+    uint8_t configuration = 0;
+    configuration = configuration<<2;
     // Setting the Channel
-    config |= (channel-1);
-    config = config<<1;
+    configuration |= (channel-1);
+    configuration = configuration<<1;
     // Setting the Conversion Mode
-    config |= mode;
-    config = config<<2;
+    configuration |= mode;
+    configuration = configuration<<2;
     // Setting the Resolution (Sample Rate)
-    config |= int((SPS-12)/2);
-    config = config<<2;
+    configuration |= int((SPS-12)/2);
+    configuration = configuration<<2;
     // Setting the PGA Gain
     //config|=int(log(PGA)/log(2));
     if(PGA == 2)
     {
-        config |= 0x01;
+        configuration |= 0x01;
     }
     else if(PGA == 4)
     {
-        config |= 0x02;
+        configuration |= 0x02;
     }
     else if(PGA == 8)
     {
-        config |= 0x03;
+        configuration |= 0x03;
     }
-    
-    // Start a conversion using configuration settings
-    Wire.beginTransmission(devAddr);
-    // 128: This bit is the data ready flag
-    // One-Shot Conversion mode
-    // Initiate a new conversion
-    Wire.write((config |= 128));
-    Wire.endTransmission();
+
+    // 128: This bit is the data ready flag, writing 1 initiates a new conversion
+    return (configuration | 128);
 }
 
 /**************************************************************************/
@@ -105,13 +161,21 @@ bool MCP3428::CheckConversion()
 {
     uint8_t i = 0;
     no_of_bytes = 3;
-    Wire.requestFrom(devAddr, no_of_bytes);
+#ifdef I2C_STATISTICS
+    uint32_t start_us = micros();
+#endif
+    uint8_t received = Wire.requestFrom(devAddr, no_of_bytes);
 
     while(Wire.available())
     {   data[i++] = Wire.read();
 
         testvar = data[no_of_bytes-1] >> 7;
     }
+#ifdef I2C_STATISTICS
+    I2C_Engine::AddTransaction(&statistics, received, received == no_of_bytes, micros() - start_us);
+    statistics.polls++;
+    conversionPolls++;
+#endif
     return testvar;
 }
 
@@ -126,10 +190,35 @@ bool MCP3428::CheckConversion()
 /**************************************************************************/
 int16_t MCP3428::readADC()
 {
-
-    raw_adc = 0;
+    if(engine != NULL)
+    {
+        // run the non-blocking state machine to completion, only the transactions of this device
+        // are executed (blocking call: use StartConversion() / Service() in tasks)
+        while(!ConversionReady())
+        {
+            if(Service() == conversionerror || state == conversionidle)
+            {
+                return 0;
+            }
+            engine->Flush(this);
+        }
+        return GetConversionResult();
+    }
 
     while(CheckConversion() == 1);
+    CountConversion();
+
+    return DecodeResult();
+}
+
+/**************************************************************************/
+/*
+        Decode the received result bytes (data[]) for the configured resolution
+*/
+/**************************************************************************/
+int16_t MCP3428::DecodeResult()
+{
+    raw_adc = 0;
 
     switch (SPS)
     {
@@ -183,3 +272,265 @@ int16_t MCP3428::readADC()
     }
     return raw_adc;
 }
+
+/**************************************************************************/
+/*
+        Non-blocking conversion via I2C_Engine
+        StartConversion() queues the configuration write, Service() has to be
+        called frequently: after the typical conversion time the result is
+        polled (data ready flag), the bus is not used while converting
+*/
+/**************************************************************************/
+void MCP3428::AttachEngine(I2C_Engine * i2cEngine)
+{
+    engine = i2cEngine;
+}
+
+bool MCP3428::StartConversion(uint8_t channel, uint8_t resolution, bool mode, uint8_t PGA)
+{
+    if(engine == NULL || state == conversionconfig || state == conversionpolling)
+    {
+        // no engine or transaction of this device still queued
+        return false;
+    }
+
+    S_I2C_TRANSACTION transaction;
+    transaction.client = this;
+    transaction.tag = TAG_CONFIG;
+    transaction.address = devAddr;
+    transaction.type = I2C_TRANSACTION_WRITE;
+    transaction.length = 1;
+    transaction.data[0] = BuildConfiguration(channel, resolution, mode, PGA);
+    config = transaction.data[0];
+    armedValid = false;
+
+    if(!engine->Submit(&transaction))
+    {
+        return false;
+    }
+
+    state = conversionconfig;
+    conversionPolls = 0;
+    return true;
+}
+
+/**************************************************************************/
+/*
+        Continuous mode only: wait for the next result of the running
+        configuration (no configuration write necessary)
+*/
+/**************************************************************************/
+bool MCP3428::NextConversion()
+{
+    if(engine == NULL || MODE == 0 || state == conversionconfig || state == conversionpolling)
+    {
+        return false;
+    }
+
+    // device converts with its own clock since the last result: poll a bit early, no conversion is skipped
+    state = conversionrunning;
+    conversionPolls = 0;
+    waitStart_us = micros();
+    waitTime_us = ConversionTime_us() - ConversionTime_us() / 8;
+    return true;
+}
+
+MCP3428::conversionstate_t MCP3428::Service()
+{
+    if(state == conversionrunning && (uint32_t)(micros() - waitStart_us) >= waitTime_us)
+    {
+        S_I2C_TRANSACTION transaction;
+        transaction.client = this;
+        transaction.tag = TAG_RESULT;
+        transaction.address = devAddr;
+        transaction.type = I2C_TRANSACTION_READ;
+        transaction.length = 3;
+
+        if(engine->Submit(&transaction))
+        {
+            state = conversionpolling;
+        }
+    }
+    return state;
+}
+
+bool MCP3428::ConversionReady()
+{
+    return (state == conversionready);
+}
+
+int16_t MCP3428::GetConversionResult()
+{
+    state = conversionidle;
+    return DecodeResult();
+}
+
+/**************************************************************************/
+/*
+        Typical conversion time for the configured resolution
+        12-bit: 240 SPS, 14-bit: 60 SPS, 16-bit: 15 SPS
+*/
+/**************************************************************************/
+uint32_t MCP3428::ConversionTime_us()
+{
+    switch (SPS)
+    {
+        case 12:
+            return 4167;
+        case 14:
+            return 16667;
+        default:
+            return 66667;
+    }
+}
+
+/**************************************************************************/
+/*
+        Synchronized conversion via I2C_Engine (several devices on one bus)
+        ArmConversion() queues the one-shot configuration with data ready
+        flag 0 (no conversion is started), the write is skipped if the device
+        already holds this configuration. When all devices are armed, one
+        general call conversion starts them at the same time, ConversionLatched()
+        then starts waiting for the result like StartConversion()
+*/
+/**************************************************************************/
+bool MCP3428::ArmConversion(uint8_t channel, uint8_t resolution, uint8_t PGA)
+{
+    if(engine == NULL || state == conversionconfig || state == conversionpolling)
+    {
+        return false;
+    }
+
+    uint8_t configuration = BuildConfiguration(channel, resolution, 0, PGA) & 0x7F;
+
+    if(armedValid && configuration == config)
+    {
+        state = conversionarmed;
+        conversionPolls = 0;
+        return true;
+    }
+
+    S_I2C_TRANSACTION transaction;
+    transaction.client = this;
+    transaction.tag = TAG_ARM;
+    transaction.address = devAddr;
+    transaction.type = I2C_TRANSACTION_WRITE;
+    transaction.length = 1;
+    transaction.data[0] = configuration;
+    config = configuration;
+    armedValid = false;
+
+    if(!engine->Submit(&transaction))
+    {
+        return false;
+    }
+
+    state = conversionconfig;
+    conversionPolls = 0;
+    return true;
+}
+
+bool MCP3428::ConversionLatched()
+{
+    if(state != conversionarmed)
+    {
+        return false;
+    }
+
+    state = conversionrunning;
+    waitStart_us = micros();
+    waitTime_us = ConversionTime_us();
+    return true;
+}
+
+/**************************************************************************/
+/*
+        General call conversion (blocking): all MCP342x on the bus start a
+        conversion with their actual configuration
+*/
+/**************************************************************************/
+bool MCP3428::GeneralCallConversion()
+{
+    Wire.beginTransmission(MCP3428_GENERAL_CALL_ADDRESS);
+    Wire.write(MCP3428_GENERAL_CALL_CONVERSION);
+    return (Wire.endTransmission() == 0);
+}
+
+void MCP3428::I2C_TransactionDone(const S_I2C_TRANSACTION * transaction)
+{
+#ifdef I2C_STATISTICS
+    I2C_Engine::AddTransaction(&statistics, transaction->length, transaction->status == I2C_STATUS_OK, transaction->duration_us);
+    if(transaction->tag == TAG_RESULT)
+    {
+        statistics.polls++;
+        conversionPolls++;
+    }
+#endif
+
+    if(transaction->status != I2C_STATUS_OK)
+    {
+        state = conversionerror;
+        armedValid = false;
+        return;
+    }
+
+    if(transaction->tag == TAG_ARM)
+    {
+        // wait for general call
+        state = conversionarmed;
+        armedValid = true;
+    }
+    else if(transaction->tag == TAG_CONFIG)
+    {
+        // first poll after typical conversion time
+        state = conversionrunning;
+        waitStart_us = micros();
+        waitTime_us = ConversionTime_us();
+    }
+    else
+    {
+        data[0] = transaction->data[0];
+        data[1] = transaction->data[1];
+        data[2] = transaction->data[2];
+
+        if(data[2] >> 7)
+        {
+            // data not ready yet (oscillator tolerance) - poll again after 1/16 conversion time
+            state = conversionrunning;
+            waitStart_us = micros();
+            waitTime_us = ConversionTime_us() / 16;
+        }
+        else
+        {
+            state = conversionready;
+            CountConversion();
+        }
+    }
+}
+
+/**************************************************************************/
+/*
+        Bus usage statistics (I2C_STATISTICS in I2C_Engine.h)
+*/
+/**************************************************************************/
+const S_I2C_STATISTICS * MCP3428::GetStatistics()
+{
+    return &statistics;
+}
+
+void MCP3428::ResetStatistics()
+{
+    I2C_Engine::ResetStatistics(&statistics);
+}
+
+void MCP3428::CountConversion()
+{
+#ifdef I2C_STATISTICS
+    statistics.conversions++;
+    if(conversionPolls > statistics.pollsMax)
+    {
+        statistics.pollsMax = conversionPolls;
+    }
+    conversionPolls = 0;
+#endif
+}
@@ -8,22 +8,73 @@
  */
 /****************************************************************************/
 
+#ifndef _MCP3428_H_
+#define _MCP3428_H_
+
 #include <Wire.h>
 #include <math.h>
 
-class MCP3428
+#include "I2C_Engine.h"
+
+// general call: address and second byte (all MCP342x on the bus)
+#define MCP3428_GENERAL_CALL_ADDRESS    0x00
+#define MCP3428_GENERAL_CALL_CONVERSION 0x08
+
+class MCP3428 : public I2C_Client
 {
     public:
 
+        // state of a non-blocking conversion (see StartConversion / Service)
+        enum conversionstate_t { conversionidle, conversionconfig, conversionrunning, conversionpolling, conversionready, conversionerror, conversionarmed };
+
         MCP3428(uint8_t i2cAddress);
         ~MCP3428();
         bool testConnection(void);
+        uint8_t GetAddress();
+        // blocking interface (with engine: only the queued transactions of this device are executed)
         void SetConfiguration(uint8_t channel, uint8_t resolution, bool mode, uint8_t PGA);
         bool CheckConversion();
         int16_t readADC();
 
+        // non-blocking interface, all bus traffic is queued to the engine
+        void AttachEngine(I2C_Engine * i2cEngine);
+        bool StartConversion(uint8_t channel, uint8_t resolution, bool mode, uint8_t PGA);
+        bool NextConversion();
+        conversionstate_t Service();
+        bool ConversionReady();
+        int16_t GetConversionResult();
+        uint32_t ConversionTime_us();
+
+        // synchronized conversion: configure one-shot without start, the general call starts all armed devices
+        bool ArmConversion(uint8_t channel, uint8_t resolution, uint8_t PGA);
+        bool ConversionLatched();
+        static bool GeneralCallConversion();
+
+        void I2C_TransactionDone(const S_I2C_TRANSACTION * transaction);
+
+        // bus usage of this device (all transactions, data ready polls per conversion)
+        const S_I2C_STATISTICS * GetStatistics();
+        void ResetStatistics();
+
     private:
 
+        // transaction tags
+        enum { TAG_CONFIG, TAG_RESULT, TAG_ARM };
+
+        uint8_t BuildConfiguration(uint8_t channel, uint8_t resolution, bool mode, uint8_t PGA);
+        int16_t DecodeResult();
+        void CountConversion();
+
+        I2C_Engine * engine;
+        conversionstate_t state;
+        uint32_t waitStart_us;
+        uint32_t waitTime_us;
+        // device holds the armed configuration (config without data ready flag), no write necessary
+        bool armedValid;
+
+        S_I2C_STATISTICS statistics;
+        uint16_t conversionPolls;
+
         uint8_t devAddr;
         int16_t raw_adc;
         uint8_t SPS;
@@ -35,3 +86,5 @@ class MCP3428
         uint8_t no_of_bytes;
         uint8_t data[3];
 };
+
+#endif /* _MCP3428_H_ */
@@ -7,23 +7,38 @@ MCP47x6base::MCP47x6base() {
   i2caddr = MCP47x6_defaultaddr;
   command = 0;
   commandneeded = false;
+  lastvalue = 0;
+  lastvaluevalid = false;
   writemode = eepromwritenot;
   vref = supplyunbuff;
   pwrdwn = powerdownnot;
+  engine = NULL;
+  I2C_Engine::ResetStatistics(&statistics);
 }
 
 MCP47x6base::MCP47x6base(uint8_t addr): i2caddr(addr) {
   i2caddr = addr;
   command = 0;
   commandneeded = false;
+  lastvalue = 0;
+  lastvaluevalid = false;
   writemode = eepromwritenot;
   vref = supplyunbuff;
   pwrdwn = powerdownnot;
+  engine = NULL;
+  I2C_Engine::ResetStatistics(&statistics);
 }
 
 boolean MCP47x6base::devicepresent(void) {
+#ifdef I2C_STATISTICS
+  uint32_t start_us = micros();
+#endif
   Wire.beginTransmission(i2caddr);
-  return (Wire.endTransmission() == 0);
+  boolean acknowledged = (Wire.endTransmission() == 0);
+#ifdef I2C_STATISTICS
+  I2C_Engine::AddTransaction(&statistics, 0, acknowledged, micros() - start_us);
+#endif
+  return acknowledged;
 }
 
 void MCP47x6base::setGain(const boolean set2xgain) {
@@ -69,8 +84,72 @@ void MCP47x6base::setEEPROMwritemode(const eeprommode_t write2eeprom)
   writemode = write2eeprom;
 }
 
+void MCP47x6base::attachEngine(I2C_Engine * i2cEngine)
+{
+  engine = i2cEngine;
+}
+
+void MCP47x6base::writeByte(const uint8_t abyte)
+{
+  if (engine) {
+    transaction.data[transaction.length] = abyte;
+  } else {
+    Wire.write(abyte);
+  }
+  transaction.length++;
+}
+
+const S_I2C_STATISTICS * MCP47x6base::getStatistics()
+{
+  return &statistics;
+}
+
+void MCP47x6base::resetStatistics()
+{
+  I2C_Engine::ResetStatistics(&statistics);
+}
+
+void MCP47x6base::invalidateVOut()
+{
+  lastvaluevalid = false;
+}
+
+void MCP47x6base::I2C_TransactionDone(const S_I2C_TRANSACTION * done)
+{
+  if (done->status != I2C_STATUS_OK) {
+    // register content unknown
+    lastvaluevalid = false;
+  } else if ((done->tag == TAG_COMMAND) && (((done->data[0] ^ command) & ~0b11100000) == 0)) {
+    // configuration is in the device (unless it was changed after the write was queued)
+    commandneeded = false;
+  }
+#ifdef I2C_STATISTICS
+  I2C_Engine::AddTransaction(&statistics, done->length, done->status == I2C_STATUS_OK, done->duration_us);
+#endif
+}
+
 boolean MCP47x6base::setVOut(const int avalue) {
-  Wire.beginTransmission(i2caddr);
+  // nothing would change, save the bus transaction
+  if (!commandneeded && lastvaluevalid && (avalue == lastvalue)) {
+    return true;
+  }
+
+  if (engine) {
+    // check first, command state must not change if write is not queued
+    if (engine->IsFull()) {
+      return false;
+    }
+    transaction.client = this;
+    transaction.tag = commandneeded ? TAG_COMMAND : TAG_VALUE;
+    transaction.address = i2caddr;
+    transaction.type = I2C_TRANSACTION_WRITE;
+  } else {
+    Wire.beginTransmission(i2caddr);
+  }
+  transaction.length = 0;
+#ifdef I2C_STATISTICS
+  uint32_t start_us = micros();
+#endif
 
   if (commandneeded) {
     // just in case these bits are set...
@@ -94,52 +173,129 @@ boolean MCP47x6base::setVOut(const int avalue) {
           break;
         }
     }
-    Wire.write((uint8_t) (command));
+    writeByte((uint8_t) (command));
 
     // as shown in "figure 6-2"
     setOutPutBytesCmd(avalue);
-    commandneeded = false;
   } else {
     // as shown in "figure 6-1"
     setOutPutBytesDev(avalue);
   }
-  return (Wire.endTransmission() == 0);
+
+  lastvalue = avalue;
+  if (engine) {
+    lastvaluevalid = engine->Submit(&transaction);
+    return lastvaluevalid;
+  }
+  boolean acknowledged = (Wire.endTransmission() == 0);
+  lastvaluevalid = acknowledged;
+  if (acknowledged) {
+    commandneeded = false;
+  }
+#ifdef I2C_STATISTICS
+  I2C_Engine::AddTransaction(&statistics, transaction.length, acknowledged, micros() - start_us);
+#endif
+  return acknowledged;
+}
+
+boolean MCP47x6base::setVOutImmediate(const int avalue) {
+  I2C_Engine * savedengine = engine;
+  if (engine) {
+    // a dropped write with the command byte leaves commandneeded set
+    engine->Cancel(this);
+    engine = NULL;
+  }
+
+  lastvaluevalid = false;
+  boolean acknowledged = setVOut(avalue);
+
+  engine = savedengine;
+  return acknowledged;
+}
+
+// the device accepts any number of fast write pairs in one transaction,
+// each pair updates the output on its last ACK (18 clocks per value)
+boolean MCP47x6base::setVOutBurst(const uint16_t * values, const uint8_t count) {
+  uint8_t index = 0;
+
+  if (count == 0) {
+    return true;
+  }
+
+  // queued writes must not overtake the burst, writeByte() has to use Wire
+  I2C_Engine * savedengine = engine;
+  if (engine) {
+    engine->Flush();
+    engine = NULL;
+  }
+
+  boolean acknowledged = true;
+  // pending configuration: first value as single write with command
+  if (commandneeded) {
+    acknowledged = setVOut(values[index++]);
+  }
+
+  while (acknowledged && (index < count)) {
+    uint8_t chunk = count - index;
+    if (chunk > MCP47x6_BURSTMAX) {
+      chunk = MCP47x6_BURSTMAX;
+    }
+#ifdef I2C_STATISTICS
+    uint32_t start_us = micros();
+#endif
+    Wire.beginTransmission(i2caddr);
+    transaction.length = 0;
+    for (uint8_t i = 0; i < chunk; i++) {
+      // as shown in "figure 6-1"
+      setOutPutBytesDev(values[index + i]);
+    }
+    acknowledged = (Wire.endTransmission() == 0);
+#ifdef I2C_STATISTICS
+    I2C_Engine::AddTransaction(&statistics, transaction.length, acknowledged, micros() - start_us);
+#endif
+    index += chunk;
+  }
+
+  engine = savedengine;
+  lastvalue = values[count - 1];
+  lastvaluevalid = acknowledged;
+  return acknowledged;
 }
 
 // as shown in "figure 6-1"
 const void MCP4706::setOutPutBytesDev(const int avalue) {
-  Wire.write((uint8_t) (0));
-  Wire.write((uint8_t) ((avalue) & 0xff));
+  writeByte((uint8_t) (0));
+  writeByte((uint8_t) ((avalue) & 0xff));
 }
 
 // as shown in "figure 6-2"
 const void MCP4706::setOutPutBytesCmd(const int avalue) {
-  Wire.write((uint8_t) ((avalue) & 0xff));
-  Wire.write((uint8_t) (0));
+  writeByte((uint8_t) ((avalue) & 0xff));
+  writeByte((uint8_t) (0));
 }
 
 // as shown in "figure 6-1"
 const void MCP4716::setOutPutBytesDev(const int avalue) {
-  Wire.write((uint8_t) ((avalue >> 6) & 0x0f));
-  Wire.write((uint8_t) ((avalue << 2) & 0xff));
+  writeByte((uint8_t) ((avalue >> 6) & 0x0f));
+  writeByte((uint8_t) ((avalue << 2) & 0xff));
 }
 
 // as shown in "figure 6-2"
 const void MCP4716::setOutPutBytesCmd(const int avalue) {
-  Wire.write((uint8_t) ((avalue >> 2) & 0xff));
-  Wire.write((uint8_t) ((avalue << 6) & 0xff));
+  writeByte((uint8_t) ((avalue >> 2) & 0xff));
+  writeByte((uint8_t) ((avalue << 6) & 0xff));
 }
 
 // as shown in "figure 6-1"
 const void MCP4726::setOutPutBytesDev(const int avalue) {
-  Wire.write((uint8_t) ((avalue >> 8) & 0x0f));
-  Wire.write((uint8_t) (avalue & 0xff));
+  writeByte((uint8_t) ((avalue >> 8) & 0x0f));
+  writeByte((uint8_t) (avalue & 0xff));
 }
 
 // as shown in "figure 6-2"
 const void MCP4726::setOutPutBytesCmd(const int avalue) {
-  Wire.write((uint8_t) ((avalue >> 4) & 0xff));
-  Wire.write((uint8_t) ((avalue << 4) & 0xff));
+  writeByte((uint8_t) ((avalue >> 4) & 0xff));
+  writeByte((uint8_t) ((avalue << 4) & 0xff));
 }
 
 
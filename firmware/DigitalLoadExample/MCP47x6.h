@@ -45,9 +45,14 @@
 #include <Arduino.h>
 #include <Wire.h>
 
+#include "I2C_Engine.h"
+
+// fast write: 2 bytes per value, limited by the Wire buffer (32 bytes on AVR)
+#define MCP47x6_BURSTMAX  16
+
 
 // base class, dont use directly (you can't anyway)
-class MCP47x6base {
+class MCP47x6base : public I2C_Client {
   public:
     enum eeprommode_t { eepromwritenot, eepromwriteonce, eepromwritealways };
     enum voltagereference_t { supplyunbuff, refpinunbuff, refpinbuff };
@@ -67,12 +72,36 @@ class MCP47x6base {
     // returns the ADC-Bit-Width
     byte getBits();
 
-    // the real deal.
+    // the real deal. writes are skipped if the value is already in the DAC register
     boolean setVOut(const int avalue);
+
+    // write count values back to back, fast write format, up to MCP47x6_BURSTMAX values per
+    // bus transaction. always blocking on Wire (queued engine writes are flushed first)
+    boolean setVOutBurst(const uint16_t * values, const uint8_t count);
+
+    // write at once on Wire (blocking, also if unchanged), queued writes of this device are dropped
+    // so they cannot overwrite the value later (emergency shutdown)
+    boolean setVOutImmediate(const int avalue);
+
+    // forget the last written value, next setVOut is written in any case (e.g. after device reset)
+    void invalidateVOut();
+
+    // queue writes to the engine instead of blocking on the bus (NULL: use Wire directly)
+    void attachEngine(I2C_Engine * i2cEngine);
+
+    // bus usage of this device (I2C_STATISTICS in I2C_Engine.h)
+    const S_I2C_STATISTICS * getStatistics();
+    void resetStatistics();
+
+    // result of queued writes
+    void I2C_TransactionDone(const S_I2C_TRANSACTION * done);
   protected:
     MCP47x6base();
     MCP47x6base(uint8_t addr);
 
+    // write to Wire or to the pending engine transaction
+    void writeByte(const uint8_t abyte);
+
     // abstracts
     virtual const void setOutPutBytesDev(const int avalue) = 0;
     virtual const void setOutPutBytesCmd(const int avalue) = 0;
@@ -80,8 +109,18 @@ class MCP47x6base {
     uint8_t i2caddr;
     byte bits = 0;
   private:
+    // transaction tags
+    enum { TAG_VALUE, TAG_COMMAND };
+
+    I2C_Engine * engine;
+    S_I2C_TRANSACTION transaction;
+    S_I2C_STATISTICS statistics;
     byte command;
+    // command byte not acknowledged by the device yet (engine: cleared by the completion of the write)
     boolean commandneeded;
+    // value in the DAC register (or queued), valid only if lastvaluevalid
+    int lastvalue;
+    boolean lastvaluevalid;
     eeprommode_t writemode;
     voltagereference_t vref;
     powerdownmode_t pwrdwn;
@@ -94,7 +133,7 @@ class MCP4706: public MCP47x6base {
     MCP4706() {
       bits = 8;
     };
-    MCP4706(uint8_t addr) {
+    MCP4706(uint8_t addr): MCP47x6base(addr) {
       bits = 8;
     };
   protected:
@@ -108,7 +147,7 @@ class MCP4716: public MCP47x6base {
     MCP4716() {
       bits = 10;
     };
-    MCP4716(uint8_t addr) {
+    MCP4716(uint8_t addr): MCP47x6base(addr) {
       bits = 10;
     };
   protected:
@@ -122,7 +161,7 @@ class MCP4726: public MCP47x6base {
     MCP4726() {
       bits = 12;
     };
-    MCP4726(uint8_t addr) {
+    MCP4726(uint8_t addr): MCP47x6base(addr) {
       bits = 12;
     };
   protected:
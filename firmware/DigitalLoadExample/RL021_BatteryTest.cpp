@@ -0,0 +1,257 @@
+#include "RL021_BatteryTest.h"
+
+/// [mA*us] per [uAh], [mW*us] per [uWh]
+#define BATTERY_US_PER_HOUR_MILLI   3600000ULL
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_BatteryTest::RL021_BatteryTest(RL021_DigitalLoad * newLoad):load(newLoad)
+{
+    cutoff_mV = 0;
+    hysteresis_mV = RL021_BATTERY_HYSTERESIS_MV;
+    tailCurrent_mA = 0;
+    curvePoints = 0;
+    memset(&summary, 0, sizeof(summary));
+    summary.state = BATTERY_IDLE;
+}
+
+/************************************************************************************************************************************************/
+/* Public - settings and control
+/************************************************************************************************************************************************/
+void RL021_BatteryTest::SetCutoff(uint16_t newCutoff_mV, uint16_t newHysteresis_mV)
+{
+    cutoff_mV = newCutoff_mV;
+    hysteresis_mV = newHysteresis_mV;
+}
+
+void RL021_BatteryTest::SetTailCurrent(uint16_t newTailCurrent_mA)
+{
+    tailCurrent_mA = newTailCurrent_mA;
+}
+
+/** Start discharge with constant current (CC mode of the load)
+ *
+ *  @param uint16_t current_mA - test current
+ *	@return bool - (false): ADC_CH_CURRENT / ADC_CH_VLOAD not acquired or load voltage not measured yet
+ */
+bool RL021_BatteryTest::Start(uint16_t current_mA)
+{
+    uint8_t required = (1<<ADC_CH_CURRENT) | (1<<ADC_CH_VLOAD);
+    if((load->GetAcquisitionMask() & required) != required || current_mA == 0)
+    {
+        return false;
+    }
+
+    const S_RL021_Measurement * voltage = load->GetMeasurement(ADC_CH_VLOAD);
+    if(!voltage->valid)
+    {
+        return false;
+    }
+
+    memset(&summary, 0, sizeof(summary));
+    chargeSum = 0;
+    tailChargeSum = 0;
+    energySum = 0;
+    elapsed_us = 0;
+    cutoffCount = 0;
+
+    lastVoltage_mV = constrain(voltage->value, (int32_t)0, (int32_t)UINT16_MAX);
+    voltageTimestamp_us = voltage->timestamp_us;
+    summary.startVoltage_mV = lastVoltage_mV;
+    summary.minVoltage_mV = lastVoltage_mV;
+    summary.endVoltage_mV = lastVoltage_mV;
+
+    /// integration starts with the first current measurement after the setpoint change
+    currentValid = false;
+    currentTimestamp_us = load->GetMeasurement(ADC_CH_CURRENT)->timestamp_us;
+    lastCurrent_mA = 0;
+
+    curvePoints = 0;
+    curveInterval_ms = RL021_BATTERY_CURVE_INTERVAL_MS;
+    nextCurvePoint_ms = 0;
+    AddCurvePoint(0);
+
+    summary.state = BATTERY_CC;
+    load->SetCurrent_mA(current_mA);
+    return true;
+}
+
+/// Abort test, load current 0
+void RL021_BatteryTest::Stop()
+{
+    if(IsRunning())
+    {
+        Finish(BATTERY_ABORTED);
+    }
+}
+
+bool RL021_BatteryTest::IsRunning()
+{
+    return summary.state == BATTERY_CC || summary.state == BATTERY_TAIL;
+}
+
+/** Process new measurements of the background acquisition
+ *
+ *  @param /
+ *	@return bool - (true): test ended (cutoff) with this call
+ */
+bool RL021_BatteryTest::Service()
+{
+    if(!IsRunning())
+    {
+        return false;
+    }
+
+    const S_RL021_Measurement * current = load->GetMeasurement(ADC_CH_CURRENT);
+    if(current->timestamp_us != currentTimestamp_us)
+    {
+        Integrate(current);
+    }
+
+    const S_RL021_Measurement * voltage = load->GetMeasurement(ADC_CH_VLOAD);
+    if(voltage->timestamp_us != voltageTimestamp_us)
+    {
+        voltageTimestamp_us = voltage->timestamp_us;
+        CheckCutoff(voltage);
+    }
+
+    return !IsRunning();
+}
+
+/************************************************************************************************************************************************/
+/* Public - result
+/************************************************************************************************************************************************/
+const S_RL021_BatterySummary * RL021_BatteryTest::GetSummary()
+{
+    return &summary;
+}
+
+uint8_t RL021_BatteryTest::GetCurvePoints()
+{
+    return curvePoints;
+}
+
+/// Curve point (0: start of test)
+const S_RL021_BatteryPoint * RL021_BatteryTest::GetCurvePoint(uint8_t index)
+{
+    return (index < curvePoints) ? &curve[index] : NULL;
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+/** Trapezoidal integration since previous current measurement
+ *  (first measurement after Start(): integration from Start() is skipped, max. one conversion rotation)
+ *
+ *  @param const S_RL021_Measurement * current -
+ *	@return /
+ */
+void RL021_BatteryTest::Integrate(const S_RL021_Measurement * current)
+{
+    uint16_t current_mA = constrain(current->value, (int32_t)0, (int32_t)UINT16_MAX);
+    uint32_t dt_us = current->timestamp_us - currentTimestamp_us;
+
+    currentTimestamp_us = current->timestamp_us;
+
+    if(!currentValid)
+    {
+        currentValid = true;
+        lastCurrent_mA = current_mA;
+        return;
+    }
+
+    /// [mA*us]
+    uint64_t charge = ((uint64_t)lastCurrent_mA + current_mA) * dt_us / 2;
+    lastCurrent_mA = current_mA;
+
+    chargeSum += charge;
+    if(summary.state == BATTERY_TAIL)
+    {
+        tailChargeSum += charge;
+    }
+    energySum += charge * lastVoltage_mV / 1000;
+    elapsed_us += dt_us;
+
+    summary.charge_uAh = chargeSum / BATTERY_US_PER_HOUR_MILLI;
+    summary.tailCharge_uAh = tailChargeSum / BATTERY_US_PER_HOUR_MILLI;
+    summary.energy_uWh = energySum / BATTERY_US_PER_HOUR_MILLI;
+    summary.duration_ms = elapsed_us / 1000;
+
+    if(summary.duration_ms >= nextCurvePoint_ms)
+    {
+        AddCurvePoint(current_mA);
+    }
+}
+
+/** Cutoff detection with hysteresis, CC -> tail -> done
+ *
+ *  @param const S_RL021_Measurement * voltage - load voltage
+ *	@return /
+ */
+void RL021_BatteryTest::CheckCutoff(const S_RL021_Measurement * voltage)
+{
+    lastVoltage_mV = constrain(voltage->value, (int32_t)0, (int32_t)UINT16_MAX);
+    summary.endVoltage_mV = lastVoltage_mV;
+    summary.minVoltage_mV = min(summary.minVoltage_mV, lastVoltage_mV);
+
+    if(lastVoltage_mV < cutoff_mV)
+    {
+        cutoffCount++;
+    }
+    else if((uint32_t)lastVoltage_mV >= (uint32_t)cutoff_mV + hysteresis_mV)
+    {
+        cutoffCount = 0;
+    }
+
+    if(cutoffCount < RL021_BATTERY_CUTOFF_SAMPLES)
+    {
+        return;
+    }
+    cutoffCount = 0;
+
+    if(summary.state == BATTERY_CC && tailCurrent_mA > 0)
+    {
+        summary.state = BATTERY_TAIL;
+        load->SetCurrent_mA(tailCurrent_mA);
+    }
+    else
+    {
+        Finish(BATTERY_DONE);
+    }
+}
+
+/** Add point with actual values at nominal time (curvePoints * interval), decimate by 2 if curve is full
+ *
+ *  @param uint16_t current_mA -
+ *	@return /
+ */
+void RL021_BatteryTest::AddCurvePoint(uint16_t current_mA)
+{
+    if(curvePoints >= RL021_BATTERY_CURVE_POINTS)
+    {
+        for(uint8_t i=1;i<RL021_BATTERY_CURVE_POINTS/2;i++)
+        {
+            curve[i] = curve[2*i];
+        }
+        curvePoints = RL021_BATTERY_CURVE_POINTS/2;
+        curveInterval_ms *= 2;
+    }
+
+    S_RL021_BatteryPoint * point = &curve[curvePoints++];
+    point->time_ms = summary.duration_ms;
+    point->charge_uAh = summary.charge_uAh;
+    point->voltage_mV = lastVoltage_mV;
+    point->current_mA = current_mA;
+
+    nextCurvePoint_ms = (uint32_t)curvePoints * curveInterval_ms;
+}
+
+/// End of test: last curve point, load current 0
+void RL021_BatteryTest::Finish(E_RL021_BATTERY_STATE state)
+{
+    AddCurvePoint(lastCurrent_mA);
+    summary.state = state;
+    load->SetCurrent_mA(0);
+}
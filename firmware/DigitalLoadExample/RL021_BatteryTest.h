@@ -0,0 +1,158 @@
+/**
+* \file    RL021_BatteryTest.h
+* \brief    Battery discharge test: capacity [mAh] and energy [mWh] counted on the device
+* \brief    Required drivers: RL021_DigitalLoad.h (background acquisition of ADC_CH_CURRENT and ADC_CH_VLOAD)
+*
+* \brief    basic functions:
+*               discharge with constant current, optional tail with reduced current after the first cutoff
+*               charge and energy are integrated on every new current measurement (trapezoidal rule, conversion
+*               timestamps), energy with the latest load voltage
+*               cutoff: load voltage < cutoff for RL021_BATTERY_CUTOFF_SAMPLES measurements, a measurement
+*               >= cutoff + hysteresis restarts the count (hysteresis against noise and recovery of the battery)
+*               summary (duration, capacity, energy, voltages) and decimated discharge curve
+*
+* \brief    curve: one point every curve interval (start: RL021_BATTERY_CURVE_INTERVAL_MS), if the curve is full
+*               every second point is removed and the interval is doubled. The curve always covers the whole test
+*               with RL021_BATTERY_CURVE_POINTS/2 ... RL021_BATTERY_CURVE_POINTS equidistant points.
+*
+* \par     Editor
+*           17.10.2026 first implementation: battery discharge test (capacity, energy, discharge curve)
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_BatteryTest_H_
+#define _RL021_BatteryTest_H_
+
+#include "RL021_DigitalLoad.h"
+
+/// Consecutive voltage measurements below cutoff
+#define RL021_BATTERY_CUTOFF_SAMPLES        4
+/// Default hysteresis of the cutoff [mV]
+#define RL021_BATTERY_HYSTERESIS_MV         50
+/// Points of the discharge curve (12 bytes RAM each, even number), e.g. -DRL021_BATTERY_CURVE_POINTS=32
+/// (finer curve: telemetry of the host during the test)
+#ifndef RL021_BATTERY_CURVE_POINTS
+#define RL021_BATTERY_CURVE_POINTS          8
+#endif
+/// Curve interval at start [ms]
+#define RL021_BATTERY_CURVE_INTERVAL_MS     10000
+
+
+/************************************************************************/
+/* Enums                                                                */
+/************************************************************************/
+typedef enum
+{
+    BATTERY_IDLE,
+    BATTERY_CC,         /// discharge with test current
+    BATTERY_TAIL,       /// discharge with reduced current after first cutoff
+    BATTERY_DONE,       /// cutoff reached
+    BATTERY_ABORTED     /// stopped by Stop()
+
+} E_RL021_BATTERY_STATE;
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+typedef struct
+{
+    E_RL021_BATTERY_STATE state;
+    /// integrated time [ms]
+    uint32_t duration_ms;
+    /// capacity [uAh], of it in tail phase
+    uint32_t charge_uAh;
+    uint32_t tailCharge_uAh;
+    /// energy [uWh]
+    uint32_t energy_uWh;
+    /// load voltage at start, min., at end [mV]
+    uint16_t startVoltage_mV;
+    uint16_t minVoltage_mV;
+    uint16_t endVoltage_mV;
+
+} S_RL021_BatterySummary;
+
+/// One point of the discharge curve
+typedef struct
+{
+    uint32_t time_ms;
+    uint32_t charge_uAh;
+    uint16_t voltage_mV;
+    uint16_t current_mA;
+
+} S_RL021_BatteryPoint;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_BatteryTest {
+
+ public:
+    RL021_BatteryTest(RL021_DigitalLoad * newLoad);
+
+    ///////////////////////////////////////////////////////////////
+    /// Settings of the next Start()
+    /// cutoff voltage and hysteresis [mV]
+    void SetCutoff(uint16_t cutoff_mV, uint16_t hysteresis_mV = RL021_BATTERY_HYSTERESIS_MV);
+    /// reduced current after first cutoff [mA] (0: no tail, test ends at first cutoff)
+    void SetTailCurrent(uint16_t tailCurrent_mA);
+
+    /// Start discharge with test current - returns false if load voltage is not measured yet
+    bool Start(uint16_t current_mA);
+    /// Abort test (load current 0)
+    void Stop();
+    bool IsRunning();
+
+    /// Integrate new measurements, check cutoff - call after RL021_DigitalLoad::Service()
+    /// returns true if the test ended with this call
+    bool Service();
+
+    ///////////////////////////////////////////////////////////////
+    /// Result of the actual / last test
+    const S_RL021_BatterySummary * GetSummary();
+    uint8_t GetCurvePoints();
+    const S_RL021_BatteryPoint * GetCurvePoint(uint8_t index);
+
+ private:
+    /// Integrate current measurement (time since previous current measurement)
+    void Integrate(const S_RL021_Measurement * current);
+    /// Check load voltage measurement against cutoff
+    void CheckCutoff(const S_RL021_Measurement * voltage);
+    /// Add curve point (decimate if full)
+    void AddCurvePoint(uint16_t current_mA);
+    /// Set final state, load current 0
+    void Finish(E_RL021_BATTERY_STATE state);
+
+    RL021_DigitalLoad * load;
+
+    uint16_t cutoff_mV;
+    uint16_t hysteresis_mV;
+    uint16_t tailCurrent_mA;
+
+    S_RL021_BatterySummary summary;
+
+    /// Sums: [mA*us], [mW*us], [us]
+    uint64_t chargeSum;
+    uint64_t tailChargeSum;
+    uint64_t energySum;
+    uint64_t elapsed_us;
+
+    /// Latest processed measurements
+    uint32_t currentTimestamp_us;
+    uint32_t voltageTimestamp_us;
+    uint16_t lastCurrent_mA;
+    uint16_t lastVoltage_mV;
+    bool currentValid;
+
+    uint8_t cutoffCount;
+
+    S_RL021_BatteryPoint curve[RL021_BATTERY_CURVE_POINTS];
+    uint8_t curvePoints;
+    uint32_t curveInterval_ms;
+    uint32_t nextCurvePoint_ms;
+};
+
+#endif /* _RL021_BatteryTest_H_ */
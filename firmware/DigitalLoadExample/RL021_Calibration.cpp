@@ -0,0 +1,515 @@
+#include "RL021_Calibration.h"
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_Calibration::RL021_Calibration(RL021_DigitalLoad * newLoad):load(newLoad)
+{
+    target = CAL_CURRENT;
+    state = CAL_IDLE;
+    points = 0;
+    pointCount = 0;
+    actualDac = 0;
+    referenceRequested = false;
+    pointGain = 0;
+    autoGainMask = 0;
+    adcFit.valid = false;
+    dacFit.valid = false;
+    for(uint8_t i=0;i<RL021_PGA_GAINS-1;i++)
+    {
+        pgaFit[i].valid = false;
+    }
+}
+
+/************************************************************************************************************************************************/
+/* Public - control
+/************************************************************************************************************************************************/
+/** Start calibration of the actual range (jumper setting)
+ *
+ *  @param E_RL021_CAL_TARGET newTarget -
+ *  @param uint8_t newPoints - number of points (2 ... RL021_CAL_MAX_POINTS)
+ *  @param uint16_t newDacStart - CAL_CURRENT: first DAC code
+ *  @param uint16_t newDacStop - CAL_CURRENT: last DAC code (max. 4095)
+ *	@return bool - (false): channel not acquired, regulation / load mode active, invalid sweep
+ */
+bool RL021_Calibration::Start(E_RL021_CAL_TARGET newTarget, uint8_t newPoints, uint16_t newDacStart, uint16_t newDacStop)
+{
+    Stop();
+    target = newTarget;
+
+    if(!(load->GetAcquisitionMask() & (1<<Channel())) || newPoints < 2 || newPoints > RL021_CAL_MAX_POINTS)
+    {
+        return false;
+    }
+
+    if((target == CAL_CURRENT || target == CAL_PGA) && (load->regulationEnabled || load->GetLoadMode() != LOAD_MODE_CC))
+    {
+        return false;
+    }
+
+    if(target == CAL_CURRENT && (newDacStop <= newDacStart || newDacStop > 4095))
+    {
+        return false;
+    }
+
+    if(target == CAL_PGA)
+    {
+        /// current of the x1 raw values in the actual range
+        pgaDac[0] = load->CalculateDAC(load->CalculateCurrent(RL021_CAL_PGA_RAW_LOW));
+        pgaDac[1] = load->CalculateDAC(load->CalculateCurrent(RL021_CAL_PGA_RAW_HIGH));
+        if(pgaDac[1] <= pgaDac[0])
+        {
+            return false;
+        }
+        newPoints = 2 * RL021_PGA_GAINS;
+    }
+
+    points = newPoints;
+    dacStart = newDacStart;
+    dacStop = newDacStop;
+    pointCount = 0;
+    adcFit.valid = false;
+    dacFit.valid = false;
+    for(uint8_t i=0;i<RL021_PGA_GAINS-1;i++)
+    {
+        pgaFit[i].valid = false;
+    }
+
+    /// calibration with fixed gain
+    autoGainMask = load->GetAutoGain();
+    load->SetAutoGain(autoGainMask & ~(1<<Channel()));
+    load->SetAdcGain(Channel(), 0);
+    pointGain = 0;
+
+    StartPoint();
+    return true;
+}
+
+void RL021_Calibration::Stop()
+{
+    if(state == CAL_IDLE || state == CAL_DONE)
+    {
+        return;
+    }
+
+    if(target == CAL_CURRENT || target == CAL_PGA)
+    {
+        load->SetCurrent_mA(0);
+    }
+    RestoreGain();
+    state = CAL_IDLE;
+    referenceRequested = false;
+}
+
+/// End voltage calibration with the measured points (min. 2), otherwise abort
+void RL021_Calibration::Finish()
+{
+    if(state != CAL_REFERENCE || target == CAL_CURRENT || target == CAL_PGA || pointCount < 2)
+    {
+        Stop();
+        return;
+    }
+    Done();
+}
+
+/** Settling of the DAC, averaging of the raw conversions after the reference is entered
+ *
+ *  @param /
+ *	@return bool - (true): reference value of the actual point is requested
+ */
+bool RL021_Calibration::Service()
+{
+    if(state == CAL_SETTLING && (uint32_t)(millis() - settleStart_ms) >= RL021_CAL_SETTLE_MS)
+    {
+        if(target == CAL_PGA)
+        {
+            StartAveraging();
+        }
+        else
+        {
+            state = CAL_REFERENCE;
+            referenceRequested = true;
+        }
+    }
+    else if(state == CAL_AVERAGING)
+    {
+        if(!(load->GetAcquisitionMask() & (1<<Channel())))
+        {
+            /// acquisition stopped
+            Stop();
+            return false;
+        }
+
+        const S_RL021_Measurement * measurement = load->GetMeasurement(Channel());
+        if(measurement->timestamp_us != lastTimestamp_us && measurement->gain == pointGain)
+        {
+            lastTimestamp_us = measurement->timestamp_us;
+            adcSum += measurement->raw;
+            adcCount++;
+        }
+
+        if(adcCount >= RL021_CAL_AVERAGE)
+        {
+            S_RL021_CalPoint * newPoint = &point[pointCount++];
+            newPoint->dac = actualDac;
+            newPoint->adc = (adcSum + RL021_CAL_AVERAGE / 2) / RL021_CAL_AVERAGE;
+            newPoint->reference = reference;
+
+            if(pointCount >= points)
+            {
+                Done();
+            }
+            else
+            {
+                StartPoint();
+            }
+        }
+    }
+
+    bool requested = referenceRequested;
+    referenceRequested = false;
+    return requested;
+}
+
+/** Reference value of the actual point, measured with a reference meter
+ *
+ *  @param int32_t newReference - current [mA] / voltage [mV]
+ *	@return bool - (false): no reference requested
+ */
+bool RL021_Calibration::EnterReference(int32_t newReference)
+{
+    if(state != CAL_REFERENCE)
+    {
+        return false;
+    }
+
+    reference = newReference;
+    StartAveraging();
+    return true;
+}
+
+/************************************************************************************************************************************************/
+/* Public - state
+/************************************************************************************************************************************************/
+E_RL021_CAL_STATE RL021_Calibration::GetState()
+{
+    return state;
+}
+
+E_RL021_CAL_TARGET RL021_Calibration::GetTarget()
+{
+    return target;
+}
+
+uint8_t RL021_Calibration::GetPointCount()
+{
+    return pointCount;
+}
+
+const S_RL021_CalPoint * RL021_Calibration::GetPoint(uint8_t index)
+{
+    return (index < pointCount) ? &point[index] : NULL;
+}
+
+uint16_t RL021_Calibration::GetActualDac()
+{
+    return actualDac;
+}
+
+/************************************************************************************************************************************************/
+/* Public - fit
+/************************************************************************************************************************************************/
+/** Least-squares fits of the measured points
+ *  ADC: reference over averaged raw ADC value, DAC (CAL_CURRENT): reference over DAC code
+ *
+ *  @param /
+ *	@return bool - (false): not done, less than 2 different points
+ */
+bool RL021_Calibration::Solve()
+{
+    uint16_t x[RL021_CAL_MAX_POINTS];
+    int32_t y[RL021_CAL_MAX_POINTS];
+
+    adcFit.valid = false;
+    dacFit.valid = false;
+
+    if(state != CAL_DONE || pointCount < 2)
+    {
+        return false;
+    }
+
+    if(target == CAL_PGA)
+    {
+        /// points: level * RL021_PGA_GAINS + gain index, raw(x1) over raw of the gain
+        bool valid = true;
+        for(uint8_t gain=1;gain<RL021_PGA_GAINS;gain++)
+        {
+            for(uint8_t level=0;level<2;level++)
+            {
+                x[level] = point[level * RL021_PGA_GAINS + gain].adc;
+                y[level] = point[level * RL021_PGA_GAINS].adc;
+            }
+            FitLine(x, y, 2, &pgaFit[gain-1]);
+            /// upper point near clipping: range too high for x8
+            if(x[1] >= RL021_PGA_HIGH_LIMIT)
+            {
+                pgaFit[gain-1].valid = false;
+            }
+            valid &= pgaFit[gain-1].valid;
+        }
+        return valid;
+    }
+
+    for(uint8_t i=0;i<pointCount;i++)
+    {
+        x[i] = point[i].adc;
+        y[i] = point[i].reference;
+    }
+    FitLine(x, y, pointCount, &adcFit);
+
+    if(target != CAL_CURRENT)
+    {
+        return adcFit.valid;
+    }
+
+    for(uint8_t i=0;i<pointCount;i++)
+    {
+        x[i] = point[i].dac;
+    }
+    FitLine(x, y, pointCount, &dacFit);
+
+    return adcFit.valid && dacFit.valid;
+}
+
+const S_RL021_CalFit * RL021_Calibration::GetAdcFit()
+{
+    return &adcFit;
+}
+
+const S_RL021_CalFit * RL021_Calibration::GetDacFit()
+{
+    return &dacFit;
+}
+
+/// Fit of gain index 1 ... 3 (NULL: invalid index)
+const S_RL021_CalFit * RL021_Calibration::GetPgaFit(uint8_t gain)
+{
+    return (gain > 0 && gain < RL021_PGA_GAINS) ? &pgaFit[gain-1] : NULL;
+}
+
+/** Write the fits to the calibration data of the actual range
+ *  Correction table: remaining error of the new transfer function at each point (sorted by raw ADC value)
+ *
+ *  @param S_RL021_CorrectionTable * table - storage of the correction table (NULL: linear calibration only)
+ *	@return bool - (false): no valid fit
+ */
+bool RL021_Calibration::Apply(S_RL021_CorrectionTable * table)
+{
+    E_ADC_CHANNEL channel = Channel();
+    uint8_t range;
+
+    if(target == CAL_PGA && state == CAL_DONE)
+    {
+        /// raw(x1) = slope * raw + offset = (raw - offset_pga) * (1 + gainError_pga) / PGA
+        for(uint8_t gain=1;gain<RL021_PGA_GAINS;gain++)
+        {
+            if(!pgaFit[gain-1].valid)
+            {
+                return false;
+            }
+        }
+        for(uint8_t gain=1;gain<RL021_PGA_GAINS;gain++)
+        {
+            const S_RL021_CalFit * fit = &pgaFit[gain-1];
+            float gainError_ppm = (fit->slope * (1<<gain) - 1.0) * 1e6;
+            float offset = -fit->offset / fit->slope;
+            load->SetCalibration_PGA(gain, constrain(lround(gainError_ppm), (long)INT16_MIN, (long)INT16_MAX),
+                                     constrain(lround(offset), (long)INT16_MIN, (long)INT16_MAX));
+        }
+        return true;
+    }
+
+    if(state != CAL_DONE || !adcFit.valid || (target == CAL_CURRENT && !dacFit.valid))
+    {
+        return false;
+    }
+
+    switch(target)
+    {
+        case CAL_CURRENT:
+            range = load->highRangeSelected_current;
+            load->SetCalibration_DAC_slope(dacFit.slope, (E_DAC_RANGE)range);
+            load->SetCalibration_DAC_offset(dacFit.offset, (E_DAC_RANGE)range);
+            break;
+        case CAL_VLOAD:
+            range = load->lowRangeSelected_Vload;
+            break;
+        default:
+            range = load->lowRangeSelected_Vext;
+            break;
+    }
+
+    /// ADC transfer function: value = slope * code - offset
+    load->SetCalibration_ADC_slope(adcFit.slope, channel, (E_ADC_RANGE)range);
+    load->SetCalibration_ADC_offset(-adcFit.offset, channel, (E_ADC_RANGE)range);
+    load->SetCorrectionTable(channel, NULL);
+
+    if(table == NULL)
+    {
+        return true;
+    }
+
+    /// insertion sort by raw ADC value
+    table->points = 0;
+    for(uint8_t i=0;i<pointCount;i++)
+    {
+        int32_t correction = point[i].reference - load->CalculateValue(point[i].adc, channel);
+        uint8_t j = table->points++;
+
+        while(j > 0 && table->adc[j-1] > point[i].adc)
+        {
+            table->adc[j] = table->adc[j-1];
+            table->correction[j] = table->correction[j-1];
+            j--;
+        }
+        table->adc[j] = point[i].adc;
+        table->correction[j] = constrain(correction, (int32_t)INT16_MIN, (int32_t)INT16_MAX);
+    }
+
+    load->SetCorrectionTable(channel, table);
+    return true;
+}
+
+/** Least-squares line through n points
+ *  Sums of the deviations from the mean values: no cancellation with large raw values in float
+ *
+ *  @param const uint16_t * x -
+ *  @param const int32_t * y -
+ *  @param uint8_t n -
+ *  @param S_RL021_CalFit * fit - result (valid: false if n < 2 or all x are equal)
+ *	@return bool - fit->valid
+ */
+bool RL021_Calibration::FitLine(const uint16_t * x, const int32_t * y, uint8_t n, S_RL021_CalFit * fit)
+{
+    fit->valid = false;
+
+    if(n < 2)
+    {
+        return false;
+    }
+
+    float meanX = 0;
+    float meanY = 0;
+    for(uint8_t i=0;i<n;i++)
+    {
+        meanX += x[i];
+        meanY += y[i];
+    }
+    meanX /= n;
+    meanY /= n;
+
+    float sxx = 0;
+    float sxy = 0;
+    for(uint8_t i=0;i<n;i++)
+    {
+        float dx = x[i] - meanX;
+        sxx += dx * dx;
+        sxy += dx * (y[i] - meanY);
+    }
+
+    if(sxx <= 0)
+    {
+        return false;
+    }
+
+    fit->slope = sxy / sxx;
+    fit->offset = meanY - fit->slope * meanX;
+
+    fit->maxResidual = 0;
+    for(uint8_t i=0;i<n;i++)
+    {
+        float residual = fabs(y[i] - (fit->slope * x[i] + fit->offset));
+        fit->maxResidual = max(fit->maxResidual, residual);
+    }
+
+    fit->valid = true;
+    return true;
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+E_ADC_CHANNEL RL021_Calibration::Channel()
+{
+    switch(target)
+    {
+        case CAL_VLOAD:
+            return ADC_CH_VLOAD;
+        case CAL_VEXT:
+            return ADC_CH_VEXT;
+        default:
+            return ADC_CH_CURRENT;
+    }
+}
+
+void RL021_Calibration::StartPoint()
+{
+    if(target == CAL_PGA)
+    {
+        /// all gains at one DAC code, then next code
+        pointGain = pointCount % RL021_PGA_GAINS;
+        reference = pointGain;
+        load->SetAdcGain(ADC_CH_CURRENT, pointGain);
+
+        if(pointGain == 0)
+        {
+            actualDac = pgaDac[pointCount / RL021_PGA_GAINS];
+            load->SetRawDac(actualDac);
+            settleStart_ms = millis();
+            state = CAL_SETTLING;
+        }
+        else
+        {
+            StartAveraging();
+        }
+    }
+    else if(target == CAL_CURRENT)
+    {
+        actualDac = dacStart + (uint32_t)(dacStop - dacStart) * pointCount / (points - 1);
+        load->SetRawDac(actualDac);
+        settleStart_ms = millis();
+        state = CAL_SETTLING;
+    }
+    else
+    {
+        state = CAL_REFERENCE;
+        referenceRequested = true;
+    }
+}
+
+void RL021_Calibration::StartAveraging()
+{
+    adcSum = 0;
+    adcCount = 0;
+    /// only conversions from now on
+    lastTimestamp_us = load->GetMeasurement(Channel())->timestamp_us;
+    state = CAL_AVERAGING;
+}
+
+void RL021_Calibration::Done()
+{
+    if(target == CAL_CURRENT || target == CAL_PGA)
+    {
+        load->SetCurrent_mA(0);
+    }
+    RestoreGain();
+    state = CAL_DONE;
+    Solve();
+}
+
+void RL021_Calibration::RestoreGain()
+{
+    load->SetAdcGain(Channel(), 0);
+    load->SetAutoGain(autoGainMask);
+}
@@ -0,0 +1,192 @@
+/**
+* \file    RL021_Calibration.h
+* \brief    Automated multi-point calibration: DAC sweep / applied voltages, reference values entered by the user,
+*           least-squares fit of slope and offset, optional piecewise linear correction table
+* \brief    Required drivers: RL021_DigitalLoad.h (background acquisition of the calibrated channel)
+*
+* \brief    basic functions (automated version of "CCS CALIBRATION.txt"):
+*               CAL_CURRENT: DAC codes from dacStart to dacStop (equidistant), for every point the current is measured
+*                            with a reference meter and entered -> fit of DAC (current setting) and ADC_CH_CURRENT
+*               CAL_VLOAD, CAL_VEXT: the user applies a voltage and enters it (max. RL021_CAL_MAX_POINTS points)
+*                            -> fit of the voltage channel
+*               point: settle (DAC changed) -> wait for reference value -> average RL021_CAL_AVERAGE raw conversions
+*               CAL_PGA:     two DAC codes (x1 raw values RL021_CAL_PGA_RAW_LOW / HIGH), at each code the current is
+*                            averaged with every PGA gain -> fit of raw(x1) over raw(x2 / x4 / x8), no reference needed
+*                            (use 16-bit resolution, x1 quantization limits the accuracy of the gain error)
+*               all targets are measured with a fixed gain (x1), auto-gain of the channel is restored afterwards
+*               fit: y = slope * x + offset, least squares over all points (x: DAC code / averaged raw ADC value)
+*               Apply(): calibration of the actual range (jumper setting) via SetCalibration_xxx(), optional
+*                        correction table with the remaining error at each point (ADC channel only, the DAC is
+*                        corrected by the current regulation)
+*                        CAL_PGA: gain error and offset of x2 / x4 / x8 (SetCalibration_PGA(), all channels and ranges)
+*
+* \brief    sign convention of the calibration data: DAC current = slope * code + offset,
+*           ADC value = slope * code - offset (see RL021_DigitalLoad::UpdateTransferFunctions())
+*
+* \par     Editor
+*           17.10.2026 first implementation: multi-point calibration with least-squares fit
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_Calibration_H_
+#define _RL021_Calibration_H_
+
+#include "RL021_DigitalLoad.h"
+
+/// max. points of one calibration (= points of the correction table)
+#define RL021_CAL_MAX_POINTS        RL021_CORRECTION_POINTS
+/// raw conversions averaged per point
+#define RL021_CAL_AVERAGE           16
+/// wait after DAC change before the reference is requested [ms]
+#define RL021_CAL_SETTLE_MS         200
+/// default DAC sweep of CAL_CURRENT
+#define RL021_CAL_DAC_START         100
+#define RL021_CAL_DAC_STOP          3500
+/// CAL_PGA: x1 raw values of the two DAC codes (x8: 25% / 88% of the span)
+#define RL021_CAL_PGA_RAW_LOW       1024
+#define RL021_CAL_PGA_RAW_HIGH      3584
+
+
+/************************************************************************/
+/* Enums                                                                */
+/************************************************************************/
+typedef enum
+{
+    CAL_CURRENT,        /// DAC sweep, current setting and current measurement
+    CAL_VLOAD,          /// applied voltages, load voltage measurement
+    CAL_VEXT,           /// applied voltages, external voltage measurement
+    CAL_PGA             /// two DAC codes, current measurement with all PGA gains
+
+} E_RL021_CAL_TARGET;
+
+typedef enum
+{
+    CAL_IDLE,
+    CAL_SETTLING,       /// DAC changed, waiting
+    CAL_REFERENCE,      /// waiting for EnterReference()
+    CAL_AVERAGING,      /// averaging raw conversions
+    CAL_DONE            /// all points measured, Solve() / Apply()
+
+} E_RL021_CAL_STATE;
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+typedef struct
+{
+    /// DAC code (CAL_CURRENT, CAL_PGA)
+    uint16_t dac;
+    /// averaged raw ADC value
+    uint16_t adc;
+    /// entered reference [mA] / [mV], CAL_PGA: gain index
+    int32_t reference;
+
+} S_RL021_CalPoint;
+
+/// Result of a line fit y = slope * x + offset
+typedef struct
+{
+    float slope;
+    float offset;
+    /// max. |y - fit| of all points [mA] / [mV]
+    float maxResidual;
+    bool valid;
+
+} S_RL021_CalFit;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_Calibration {
+
+ public:
+    RL021_Calibration(RL021_DigitalLoad * newLoad);
+
+    /// Start calibration - returns false if the channel is not acquired, regulation / load mode active
+    /// CAL_CURRENT: points (2 ... RL021_CAL_MAX_POINTS) DAC codes from dacStart to dacStop
+    /// CAL_VLOAD / CAL_VEXT: points, DAC range unused
+    /// CAL_PGA: 2 DAC codes x RL021_PGA_GAINS points, points and DAC range unused
+    bool Start(E_RL021_CAL_TARGET target, uint8_t points = RL021_CAL_MAX_POINTS,
+               uint16_t dacStart = RL021_CAL_DAC_START, uint16_t dacStop = RL021_CAL_DAC_STOP);
+    /// Abort (CAL_CURRENT: load current 0)
+    void Stop();
+    /// End a voltage calibration with the points measured so far
+    void Finish();
+
+    /// Settling and averaging - returns true if a reference value is requested with this call
+    bool Service();
+
+    /// Reference value of the actual point [mA] / [mV] - returns false if no reference is requested
+    bool EnterReference(int32_t reference);
+
+    E_RL021_CAL_STATE GetState();
+    E_RL021_CAL_TARGET GetTarget();
+    /// Measured points, actual point (DAC code of the requested reference)
+    uint8_t GetPointCount();
+    const S_RL021_CalPoint * GetPoint(uint8_t index);
+    uint16_t GetActualDac();
+
+    /// Least-squares fits of all points (CAL_DONE) - returns false if less than 2 different points
+    bool Solve();
+    const S_RL021_CalFit * GetAdcFit();
+    /// CAL_CURRENT only
+    const S_RL021_CalFit * GetDacFit();
+    /// CAL_PGA only: raw(x1) over raw at gain index 1 ... 3
+    const S_RL021_CalFit * GetPgaFit(uint8_t gain);
+
+    /// Write fit to the calibration data of the actual range, optional correction table (NULL: none)
+    bool Apply(S_RL021_CorrectionTable * table);
+
+    /// Least squares line y = slope * x + offset (centered sums, float)
+    static bool FitLine(const uint16_t * x, const int32_t * y, uint8_t n, S_RL021_CalFit * fit);
+
+ private:
+    /// ADC channel of the target
+    E_ADC_CHANNEL Channel();
+    /// Set DAC code / gain of the next point (CAL_CURRENT, CAL_PGA) / request reference
+    void StartPoint();
+    /// Average conversions from now on
+    void StartAveraging();
+    /// All points measured: load current 0, fit
+    void Done();
+    /// Gain settings of the channel like before Start()
+    void RestoreGain();
+
+    RL021_DigitalLoad * load;
+
+    E_RL021_CAL_TARGET target;
+    E_RL021_CAL_STATE state;
+
+    uint8_t points;
+    uint16_t dacStart;
+    uint16_t dacStop;
+    uint16_t actualDac;
+    uint32_t settleStart_ms;
+    /// reference requested, reported by the next Service()
+    bool referenceRequested;
+
+    /// averaging of the actual point (conversions with pointGain only)
+    int32_t reference;
+    uint8_t pointGain;
+    uint32_t adcSum;
+    uint8_t adcCount;
+    uint32_t lastTimestamp_us;
+
+    S_RL021_CalPoint point[RL021_CAL_MAX_POINTS];
+    uint8_t pointCount;
+
+    S_RL021_CalFit adcFit;
+    S_RL021_CalFit dacFit;
+    S_RL021_CalFit pgaFit[RL021_PGA_GAINS-1];
+
+    /// CAL_PGA: DAC codes of the two current levels
+    uint16_t pgaDac[2];
+    /// auto-gain channels of the load before Start()
+    uint8_t autoGainMask;
+};
+
+#endif /* _RL021_Calibration_H_ */
@@ -11,16 +11,7 @@
  */
 RL021_DigitalLoad::RL021_DigitalLoad()
 {
-  /*
-    MOCK_MCP47x6base mockDAC;
-    deviceDAC = &mockDAC;
-
-    MOCK_MCP3428 mockADC;
-    deviceADC = &mockADC;
-    */
-    
-  
-    SetDefaultCalibration();
+    Initialize();
 }
 
 /** Constructor 
@@ -30,8 +21,64 @@ RL021_DigitalLoad::RL021_DigitalLoad()
  *	@return /
  */
 RL021_DigitalLoad::RL021_DigitalLoad(MCP47x6base * newDeviceDAC, MCP3428 * newDeviceADC):deviceDAC(newDeviceDAC), deviceADC(newDeviceADC)
+{
+    Initialize();
+}
+
+
+/** Common initialization of all constructors
+ * 
+ *  @param /
+ *	@return /
+ */
+void RL021_DigitalLoad::Initialize()
 {
     SetDefaultCalibration();
+    
+    acquisitionMask = 0;
+    StopAcquisition();
+    for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+    {
+        measurement[ch].valid = false;
+        SetFilter((E_ADC_CHANNEL)ch, FILTER_NONE, 0);
+        correctionTable[ch] = NULL;
+        adcGain[ch] = 0;
+        gainUpCount[ch] = 0;
+    }
+    autoGainMask = 0;
+    conversionGain = 0;
+    
+    /// Default regulation: error is corrected within ~5 steps without overshoot
+    regulation.kp = 0.3;
+    regulation.ki = 0.3;
+    regulation.maxTrim = 400;
+    regulation.tolerance_mA = 5;
+    regulation.settledSteps = 3;
+    regulation.settlingTarget_ms = 1000;
+    regulationEnabled = false;
+    regulationIntegral = 0;
+    regulationInTolerance = 0;
+    regulationSettled = true;
+    settlingTargetMissed = false;
+    settlingTime_ms = 0;
+    setpointTimestamp_us = 0;
+    setpoint_mA = 0;
+    
+    adcResolution = 16;
+    streamActive = false;
+    streamBuffer = NULL;
+    streamSize = 0;
+    streamHead = 0;
+    streamCount = 0;
+    streamOverflows = 0;
+    
+    loadMode = LOAD_MODE_CC;
+    modeSetpoint = 0;
+    modeCurrentLimit_mA = 10000;
+    cvGain = 0.2;
+    
+    outputInhibited = false;
+    dacOutput = 0;
 }
 
 
@@ -82,12 +129,101 @@ void RL021_DigitalLoad::SetDefaultCalibration()
     calibrationData.slope_adc[RANGE_ADC_LOW][ADC_CH_VEXT] = 4000.0/32767; // 4V range
     calibrationData.offset_adc[RANGE_ADC_LOW][ADC_CH_VEXT] = 2;
     
+    /// PGA: nominal gains
+    for(uint8_t i=0;i<RL021_PGA_GAINS-1;i++)
+    {
+        calibrationData.gainError_pga[i] = 0;
+        calibrationData.offset_pga[i] = 0;
+    }
+    
     
     /// Set default jumper settings
     highRangeSelected_current = false; //jumper JP2 (true: closed, false: open)
     lowRangeSelected_Vload = false; //jumper JP3 (true: closed, false: open)
     lowRangeSelected_Vext = false; //jumper JP4 (true: closed, false: open)
- 
+    
+    UpdateTransferFunctions();
+}
+
+
+/************************************************************************************************************************************************/
+/* Private - Fixed-point transfer functions                                                                                                                          
+/************************************************************************************************************************************************/
+/** Convert float slope / offset to integer transfer function y = x * gain - offset (Q16.16)
+ * 
+ *  Worst-case deviation from float calculation (truncated to integer) over the full input range 0-65535:
+ *  1 LSB of the result (DAC count / mA / mV), caused by results close to an integer boundary
+ * 
+ *  @param float slope - 
+ *  @param float offset - 
+ *	@return S_RL021_FixedPoint - integer transfer function
+ */
+S_RL021_FixedPoint RL021_DigitalLoad::CalculateFixedPoint(float slope, float offset)
+{
+    S_RL021_FixedPoint transfer;
+    
+    transfer.gain = (int32_t)floor(slope * 65536.0 + 0.5);
+    transfer.offset = (int32_t)floor(offset * 65536.0 + 0.5);
+    
+    return transfer;
+}
+
+/** y = floor(x * gain - offset), Q16.16 product split in integer and fractional part 
+ *  (two 16x16 bit multiplications, no 64-bit arithmetic)
+ * 
+ *  @param const S_RL021_FixedPoint * transfer - 
+ *  @param uint16_t x - 
+ *	@return int32_t - 
+ */
+int32_t RL021_DigitalLoad::ApplyFixedPoint(const S_RL021_FixedPoint * transfer, uint16_t x)
+{
+    /// fractional product
+    uint32_t low = (uint32_t)x * (uint16_t)(transfer->gain & 0xFFFF);
+    
+    int32_t y = (int32_t)x * (transfer->gain >> 16) - (transfer->offset >> 16) + (int32_t)(low >> 16);
+    
+    /// borrow from fractional part of offset
+    if((uint16_t)low < (uint16_t)(transfer->offset & 0xFFFF))
+    {
+        y--;
+    }
+    
+    return y;
+}
+
+/** Precalculate integer transfer functions for actual calibration data and jumper settings
+ *  Called whenever calibration data or jumper settings change, 
+ *  CalculateDAC(), CalculateCurrent() and CalculateVoltage() only use integer multiply-add
+ * 
+ *  @param /
+ *	@return /
+ */
+void RL021_DigitalLoad::UpdateTransferFunctions()
+{
+    /// DAC: (current_mA - offset) / slope
+    float slope = calibrationData.slope_dac[highRangeSelected_current];
+    float offset = calibrationData.offset_dac[highRangeSelected_current];
+    dacTransfer = CalculateFixedPoint(1.0 / slope, offset / slope);
+    
+    /// ADC: slope * adcValue - offset of the actual range
+    uint8_t range[ADC_CH_NTC];
+    range[ADC_CH_CURRENT] = highRangeSelected_current;
+    range[ADC_CH_VLOAD] = lowRangeSelected_Vload;
+    range[ADC_CH_VEXT] = lowRangeSelected_Vext;
+    
+    for(uint8_t ch=0;ch<ADC_CH_NTC;ch++)
+    {
+        slope = calibrationData.slope_adc[range[ch]][ch];
+        offset = calibrationData.offset_adc[range[ch]][ch];
+        adcTransfer[ch][0] = CalculateFixedPoint(slope, offset);
+        
+        /// PGA: value = slope * (raw - offset_pga) * (1 + gainError_pga) / PGA - offset
+        for(uint8_t gain=1;gain<RL021_PGA_GAINS;gain++)
+        {
+            float slopeGain = slope * (1.0 + calibrationData.gainError_pga[gain-1] * 1e-6) / (1<<gain);
+            adcTransfer[ch][gain] = CalculateFixedPoint(slopeGain, offset + slopeGain * calibrationData.offset_pga[gain-1]);
+        }
+    }
 }
 
 
@@ -101,25 +237,15 @@ void RL021_DigitalLoad::SetDefaultCalibration()
  */
 uint16_t RL021_DigitalLoad::CalculateDAC(uint16_t current_mA)
 {
-    uint16_t dacValue = 0;
-    float slope = 0;
-    float offset = 0;
+    /// Transfer function of actual jumper settings: (current_mA - offset) / slope
+    int32_t dacValue = ApplyFixedPoint(&dacTransfer, current_mA);
     
-    /// Get calibration data for actual jumper settings
-    slope = calibrationData.slope_dac[highRangeSelected_current];
-    offset = calibrationData.offset_dac[highRangeSelected_current];
-
-    /// 
-    if(current_mA < offset)
+    /// Limit to 12-bit range
+    if(dacValue < 0)
     {
-        current_mA = offset;
+        dacValue = 0;
     }
-
-    /// get DAC value via transfer function    
-    dacValue = (current_mA - offset)/slope;
-    
-    /// Limit to 12-bit max value
-    if(dacValue > 4095)
+    else if(dacValue > 4095)
     {
         dacValue = 4095;
     }
@@ -131,94 +257,308 @@ uint16_t RL021_DigitalLoad::CalculateDAC(uint16_t current_mA)
 /* Private - ADC calculation                                                                                                                         
 /************************************************************************************************************************************************/
 /// Calculate Load/External Voltage from ADC raw data
-uint16_t RL021_DigitalLoad::CalculateVoltage(uint16_t adcValue, E_ADC_CHANNEL channel)
+uint16_t RL021_DigitalLoad::CalculateVoltage(uint16_t adcValue, E_ADC_CHANNEL channel, uint8_t gain)
+{
+    /// Transfer function of actual jumper settings and gain: slope * adcValue - offset
+    int32_t voltage_mV = ApplyFixedPoint(&adcTransfer[channel][gain], adcValue);
+    
+    return constrain(voltage_mV, (int32_t)0, (int32_t)65535);
+}
+
+
+/// Calculate Load Current from ADC raw data
+uint16_t RL021_DigitalLoad::CalculateCurrent(uint16_t adcValue, uint8_t gain)
 {
-    uint16_t voltage_mV; 
-    float slope = 0;
-    float offset = 0;
+    /// Transfer function of actual jumper settings and gain: slope * adcValue - offset
+    int32_t current_mA = ApplyFixedPoint(&adcTransfer[ADC_CH_CURRENT][gain], adcValue);
     
-    if(channel == ADC_CH_VLOAD)
+    return constrain(current_mA, (int32_t)0, (int32_t)65535);
+}
+
+
+/************************************************************************************************************************************************/
+/* NTC look-up table
+/************************************************************************************************************************************************/
+/// 16-bit signed ADC TOP value (ADC result with no NTC connected / pull-up shorted)
+#define NTC_ADC_TOP         32767
+/// Entries of NTC table (-55°C -> 150°C in 5°C steps)
+#define NTC_TABLE_ENTRIES   42
+
+/** ADC code of NTC voltage divider (10 kOhm pull-up, R(25°C) = 10 kOhm): code = TOP * R_T / (R_T + R_pullup)
+ *  evaluated by the compiler, only the integer result is stored in flash
+ * 
+ *  @param float RT_R25 - R_T / R_25 of NTC
+ *	@return uint16_t - ADC code (rounded)
+ */
+constexpr uint16_t NtcAdcCode(float RT_R25)
+{
+    return (uint16_t)(NTC_ADC_TOP * RT_R25 / (RT_R25 + 1.0f) + 0.5f);
+}
+
+/// ADC codes of NTC R/T characteristic for NTC Type: ("B57421V2103", R(25°C)=10kOhm, B_25/100=4000K), descending
+static const uint16_t NTC_ADC_TABLE_B57421V2103[NTC_TABLE_ENTRIES] PROGMEM = {
+    NtcAdcCode(96.158),  NtcAdcCode(66.892),  NtcAdcCode(47.127),  NtcAdcCode(33.606),  NtcAdcCode(24.243),   //-55 -> -35
+    NtcAdcCode(17.681),  NtcAdcCode(13.032),  NtcAdcCode(9.702),   NtcAdcCode(7.2923),  NtcAdcCode(5.5314),   //- 30 -> -10
+    NtcAdcCode(4.2325),  NtcAdcCode(3.2657),  NtcAdcCode(2.54),    NtcAdcCode(1.9907),  NtcAdcCode(1.5716),   //-5 -> 15
+    NtcAdcCode(1.2494),  NtcAdcCode(1.0000),  NtcAdcCode(0.80552), NtcAdcCode(0.65288), NtcAdcCode(0.53229),  // 20 -> 40
+    NtcAdcCode(0.43645), NtcAdcCode(0.35981), NtcAdcCode(0.29819), NtcAdcCode(0.24837), NtcAdcCode(0.20787),  // 45 -> 65
+    NtcAdcCode(0.17479), NtcAdcCode(0.14763), NtcAdcCode(0.12523), NtcAdcCode(0.10667), NtcAdcCode(0.091227), // 70 -> 90
+    NtcAdcCode(0.078319),NtcAdcCode(0.067488),NtcAdcCode(0.058363),NtcAdcCode(0.050647),NtcAdcCode(0.044098), //95 -> 115
+    NtcAdcCode(0.03852), NtcAdcCode(0.033752),NtcAdcCode(0.029663),NtcAdcCode(0.026146),NtcAdcCode(0.023111), //120 -> 140
+    NtcAdcCode(0.020484),NtcAdcCode(0.018203)};                                                                   // 145 -> 150
+
+/** Calculate Temperature from 16-bit ADC raw data (0-32767)
+ *  Binary search in NTC table (ADC codes), linear integer interpolation between the 5°C steps
+ *  (deviation from interpolation of R_T/R_25 (previous float calculation): < 0.6°C)
+ * 
+ *  @param uint16_t adcValue - 16-bit ADC value
+ *	@return int16_t - temperature [°C x10], limited to -55°C ... 150°C
+ */
+int16_t RL021_DigitalLoad::CalculateTemperature(uint16_t adcValue)
+{
+    /// Check valid range
+    if(adcValue >= pgm_read_word(&NTC_ADC_TABLE_B57421V2103[0]))
     {
-        slope = calibrationData.slope_adc[lowRangeSelected_Vload][ADC_CH_VLOAD];  
-        offset = calibrationData.offset_adc[lowRangeSelected_Vload][ADC_CH_VLOAD];  
+        return -550;
     }
-    else if(channel == ADC_CH_VEXT)
+    if(adcValue <= pgm_read_word(&NTC_ADC_TABLE_B57421V2103[NTC_TABLE_ENTRIES-1]))
     {
-        slope = calibrationData.slope_adc[lowRangeSelected_Vext][ADC_CH_VEXT];  
-        offset = calibrationData.offset_adc[lowRangeSelected_Vext][ADC_CH_VEXT];  
+        return 1500;
     }
-    else
+    
+    /// Find entry: table[entry] > adcValue >= table[entry+1]
+    uint8_t entry = 0;
+    uint8_t last = NTC_TABLE_ENTRIES-1;
+    while(last - entry > 1)
     {
-        
+        uint8_t middle = (entry + last) / 2;
+        if(adcValue < pgm_read_word(&NTC_ADC_TABLE_B57421V2103[middle]))
+        {
+            entry = middle;
+        }
+        else
+        {
+            last = middle;
+        }
     }
     
-    voltage_mV = slope*adcValue - offset;
-
-    return voltage_mV;
+    uint16_t codeHigh = pgm_read_word(&NTC_ADC_TABLE_B57421V2103[entry]);
+    uint16_t codeLow = pgm_read_word(&NTC_ADC_TABLE_B57421V2103[entry+1]);
+    
+    /// linear interpolation (5°C = 50 per entry)
+    int16_t temperaturex10C = -550 + entry*50 + (int16_t)((uint32_t)(codeHigh - adcValue) * 50 / (codeHigh - codeLow));
+    
+    return temperaturex10C;    
 }
 
-
-/// Calculate Load Current from ADC raw data
-uint16_t RL021_DigitalLoad::CalculateCurrent(uint16_t adcValue)
+/** Calculate calibrated value of selected channel from ADC raw data
+ *  NTC table and correction tables are valid for x1, they use the nominal x1 value raw / PGA.
+ * 
+ *  @param uint16_t adcValue - raw ADC value
+ *  @param E_ADC_CHANNEL channel - measured channel
+ *  @param uint8_t gain - PGA gain index of the raw value
+ *	@return int32_t - current [mA], voltage [mV], temperature [°C x10]
+ */
+int32_t RL021_DigitalLoad::CalculateValue(uint16_t adcValue, E_ADC_CHANNEL channel, uint8_t gain)
 {
-    uint16_t current_mA; 
-    float slope = 0;
-    float offset = 0;
+    int32_t value;
     
-    slope = calibrationData.slope_adc[highRangeSelected_current][ADC_CH_CURRENT];
-    offset = calibrationData.offset_adc[highRangeSelected_current][ADC_CH_CURRENT];
+    switch(channel)
+    {
+        case ADC_CH_CURRENT:
+            value = CalculateCurrent(adcValue, gain);
+            break;
+        case ADC_CH_VLOAD:
+        case ADC_CH_VEXT:
+            value = CalculateVoltage(adcValue, channel, gain);
+            break;
+        case ADC_CH_NTC:
+            return CalculateTemperature(adcValue >> gain);
+        default:
+            return 0;
+    }
     
-    current_mA = slope*adcValue - offset;
+    if(correctionTable[channel] != NULL)
+    {
+        value += InterpolateCorrection(correctionTable[channel], adcValue >> gain);
+        if(value < 0)
+        {
+            value = 0;
+        }
+    }
+    return value;
+}
+
+/** Correction of the linear transfer function at raw ADC value (piecewise linear, see RL021_Calibration)
+ *  Outside of the table the correction of the first / last point is used.
+ * 
+ *  @param const S_RL021_CorrectionTable * table - points sorted by raw ADC value
+ *  @param uint16_t adcValue - raw ADC value
+ *	@return int16_t - correction [mA] / [mV]
+ */
+int16_t RL021_DigitalLoad::InterpolateCorrection(const S_RL021_CorrectionTable * table, uint16_t adcValue)
+{
+    if(table->points == 0)
+    {
+        return 0;
+    }
+    if(adcValue <= table->adc[0])
+    {
+        return table->correction[0];
+    }
     
-    return current_mA;
+    for(uint8_t i=1;i<table->points;i++)
+    {
+        if(adcValue < table->adc[i])
+        {
+            int32_t delta = table->correction[i] - table->correction[i-1];
+            return table->correction[i-1] + delta * (int32_t)(adcValue - table->adc[i-1]) / (int32_t)(table->adc[i] - table->adc[i-1]);
+        }
+    }
+    return table->correction[table->points-1];
 }
 
+/************************************************************************************************************************************************/
+/* Private - Measurement cache                                                                                                                         
+/************************************************************************************************************************************************/
+/// Store raw value and calculated value in measurement cache (fresh read: not filtered)
+void RL021_DigitalLoad::StoreMeasurement(E_ADC_CHANNEL channel, uint16_t rawAdc, uint8_t gain)
+{
+    measurement[channel].raw = rawAdc;
+    measurement[channel].filtered = rawAdc;
+    measurement[channel].gain = gain;
+    measurement[channel].value = CalculateValue(rawAdc, channel, gain);
+    measurement[channel].timestamp_us = micros();
+    measurement[channel].valid = true;
+}
 
-/// Calculate Temperature from 16-bit ADC raw data (0-32767)
-int16_t RL021_DigitalLoad::CalculateTemperature(uint16_t adcValue)
+/** Store conversion of the acquisition: raw value, filter of the channel, calculated value of the filter output
+ *  Decimation: filtered / calculated value are only updated with every 2^shift-th conversion
+ * 
+ *  PGA auto-gain: the gain of the next conversion is selected, a clipped conversion with a gain > x1 is not stored.
+ * 
+ *  @param E_ADC_CHANNEL channel - 
+ *  @param uint16_t rawAdc - raw ADC value [0-32767]
+ *  @param uint8_t gain - PGA gain index of the conversion
+ *  @param uint32_t timestamp_us - micros() at the end of the conversion
+ *	@return bool - (true): new filter output
+ */
+bool RL021_DigitalLoad::StoreFilteredMeasurement(E_ADC_CHANNEL channel, uint16_t rawAdc, uint8_t gain, uint32_t timestamp_us)
 {
-    float Rf = 10000.0; //pullup in kOhm
-    float REF = 32767.0; // 16-bit signed ADC TOP value (ADC result with no ADC connected / pull-up shorted)
+    if(gain > 0 && IsClipped(rawAdc))
+    {
+        UpdateGain(channel, gain, rawAdc);
+        return false;
+    }
+    
+    measurement[channel].raw = rawAdc;
+    measurement[channel].gain = gain;
+    measurement[channel].timestamp_us = timestamp_us;
     
-    /// Calculate Resistance of NTC
-    float RT = (adcValue / (REF-adcValue)) * Rf;
-    /// Calculate R_T / R_25 (10k at 25°C)
-    float RT_R25 = RT / 10000.0;
+    bool newValue = ApplyFilter(&filter[channel], rawAdc);
+    if(newValue)
+    {
+        measurement[channel].filtered = filter[channel].output;
+        measurement[channel].value = CalculateValue(filter[channel].output, channel, gain);
+        measurement[channel].valid = true;
+    }
     
-    /// Calculation for ideal pull-up (10.0 kOhm)
-    //float RT_R25 = ADC / (REF-ADC);
+    UpdateGain(channel, gain, rawAdc);
+    return newValue;
+}
 
-    /// Look through NTC look-up table     
-    uint8_t entry = 0;
-    for(uint8_t i=0;i<41;i++) //42 entrys
+/** Auto-gain step after a conversion of the channel
+ *  clipped (x2 ... x8): x1, >= RL021_PGA_HIGH_LIMIT: next lower gain,
+ *  RL021_PGA_UP_SAMPLES conversions < RL021_PGA_LOW_LIMIT: highest gain with the latest value below 2 * RL021_PGA_LOW_LIMIT
+ *  The filter state of the channel is scaled to the new gain.
+ * 
+ *  @param E_ADC_CHANNEL channel - 
+ *  @param uint8_t gain - PGA gain index of the conversion
+ *  @param uint16_t rawAdc - raw ADC value at this gain
+ *	@return bool - (true): gain changed
+ */
+bool RL021_DigitalLoad::UpdateGain(E_ADC_CHANNEL channel, uint8_t gain, uint16_t rawAdc)
+{
+    /// gain changed since start of the conversion (SetAdcGain(), previous result)
+    if(!(autoGainMask & (1<<channel)) || gain != adcGain[channel])
+    {
+        return false;
+    }
+    
+    uint8_t newGain = gain;
+    
+    if(gain > 0 && rawAdc >= RL021_PGA_HIGH_LIMIT)
+    {
+        newGain = IsClipped(rawAdc) ? 0 : gain - 1;
+        gainUpCount[channel] = 0;
+    }
+    else if(gain < RL021_PGA_GAINS-1 && rawAdc < RL021_PGA_LOW_LIMIT)
     {
-        if(RT_R25 < NTC_TABLE_B57421V2103[i] && RT_R25 > NTC_TABLE_B57421V2103[i+1])
+        if(++gainUpCount[channel] >= RL021_PGA_UP_SAMPLES)
         {
-            entry = i;
+            gainUpCount[channel] = 0;
+            while(newGain < RL021_PGA_GAINS-1 && ((uint32_t)rawAdc << (newGain + 1 - gain)) < 2 * RL021_PGA_LOW_LIMIT)
+            {
+                newGain++;
+            }
         }
     }
+    else
+    {
+        gainUpCount[channel] = 0;
+    }
     
-    // temperature in 5 °C steps:
-    // int16_t temperaturex10C = -55+(entry*5) * 10;
+    if(newGain == gain)
+    {
+        return false;
+    }
     
-    //linear interpolation
-    float faktor = (NTC_TABLE_B57421V2103[entry] - RT_R25) / (NTC_TABLE_B57421V2103[entry] - NTC_TABLE_B57421V2103[entry+1]);   
-    float temperature = -55+(entry*5) + faktor*5;
+    RescaleFilter(&filter[channel], newGain - gain);
+    adcGain[channel] = newGain;
+    return true;
+}
 
-    /// Check valid range
-    if(temperature > 150)
+/// Result at full scale of the actual resolution (16-bit range: 32768 - one LSB)
+bool RL021_DigitalLoad::IsClipped(uint16_t rawAdc)
+{
+    return rawAdc >= 32768 - (1 << (16 - adcResolution));
+}
+
+/// Next channel of acquisitionMask after actual channel (actual channel if it is the only one)
+E_ADC_CHANNEL RL021_DigitalLoad::NextAcquisitionChannel(E_ADC_CHANNEL channel)
+{
+    for(uint8_t i=1;i<=ADC_CH_LAST;i++)
     {
-        temperature = 150;
+        uint8_t next = (channel + i) % ADC_CH_LAST;
+        if(acquisitionMask & (1<<next))
+        {
+            return (E_ADC_CHANNEL)next;
+        }
     }
-    else if(temperature < -55)
+    return channel;
+}
+
+/// New conversion of channel: stream (raw value), on new filter output regulation step (current) / load mode step (load voltage)
+void RL021_DigitalLoad::ProcessMeasurement(E_ADC_CHANNEL channel, bool newValue)
+{
+    if(streamActive)
     {
-        temperature = -55;
+        PushStreamSample(channel);
     }
     
-    int16_t temperaturex10C = (int16_t)(temperature * 10);
-
+    if(!newValue)
+    {
+        return;
+    }
     
-    return temperaturex10C;    
+    if(channel == ADC_CH_CURRENT && regulationEnabled)
+    {
+        RegulationStep();
+    }
+    else if(channel == ADC_CH_VLOAD && loadMode != LOAD_MODE_CC)
+    {
+        LoadModeStep();
+    }
 }
 
 /************************************************************************************************************************************************/
@@ -227,28 +567,81 @@ int16_t RL021_DigitalLoad::CalculateTemperature(uint16_t adcValue)
 
 uint16_t RL021_DigitalLoad::GetRawAdc(E_ADC_CHANNEL channel)
 {
-    /// Configure ADC: Channel, 16-bit, oneShot, gain=1
-    deviceADC->SetConfiguration(channel+1, 16, 0, 1);
+    /// Configure ADC: Channel, resolution, oneShot, PGA of the channel
+    deviceADC->SetConfiguration(channel+1, adcResolution, 0, 1<<adcGain[channel]);
 
     /// read raw ADC value
     /// long readADC();
     int16_t rawAdcRead = deviceADC->readADC();
-    uint16_t rawAdc = 0;
+    
+    //printf(" raw adc: %i\n",rawAdc);
+    return ScaleRawAdc(rawAdcRead);
+    
+    //return 32767/2; //debug return
+}
 
+/** Scale ADC result of actual resolution to 16-bit range (calibration data is valid for all resolutions)
+ *  negative values are limited to 0
+ * 
+ *  @param int16_t rawAdcRead - ADC result (12/14/16-bit signed)
+ *	@return uint16_t - raw ADC value [0-32767]
+ */
+uint16_t RL021_DigitalLoad::ScaleRawAdc(int16_t rawAdcRead)
+{
     if(rawAdcRead > 0)
     {
-      rawAdc = rawAdcRead;
+      return (uint16_t)rawAdcRead << (16 - adcResolution);
     }
-    else
+    
+    return 0;
+}
+
+
+/** Start non-blocking conversion of selected channel
+ *  ADC configuration like GetRawAdc(), conversion is handled by the I2C_Engine
+ *  attached to the ADC driver, poll RawAdcReady() until result is available
+ * 
+ *  @param E_ADC_CHANNEL channel - channel to convert
+ *	@return bool - (true): conversion started, (false): ADC busy / I2C queue full
+ */
+bool RL021_DigitalLoad::StartRawAdc(E_ADC_CHANNEL channel)
+{
+    /// Configure ADC: Channel, resolution, oneShot, PGA of the channel
+    conversionGain = adcGain[channel];
+    return deviceADC->StartConversion(channel+1, adcResolution, 0, 1<<conversionGain);
+}
+
+/** Service non-blocking conversion, call frequently
+ * 
+ *  @param /
+ *	@return bool - (true): result available (or conversion failed, result is 0)
+ */
+bool RL021_DigitalLoad::RawAdcReady()
+{
+    if(deviceADC->Service() == MCP3428::conversionerror)
     {
-      rawAdc = 0;
+        return true;
     }
     
+    return deviceADC->ConversionReady();
+}
+
+/** Get result of non-blocking conversion (negative values are limited to 0)
+ * 
+ *  @param /
+ *	@return uint16_t - raw ADC value
+ */
+uint16_t RL021_DigitalLoad::GetRawAdcResult()
+{
+    bool failed = !deviceADC->ConversionReady();
+    int16_t rawAdcRead = deviceADC->GetConversionResult();
     
-    //printf(" raw adc: %i\n",rawAdc);
-    return rawAdc;
+    if(failed)
+    {
+      return 0;
+    }
     
-    //return 32767/2; //debug return
+    return ScaleRawAdc(rawAdcRead);
 }
 
 
@@ -256,9 +649,90 @@ uint16_t RL021_DigitalLoad::GetRawAdc(E_ADC_CHANNEL channel)
 void RL021_DigitalLoad::SetRawDac(uint16_t dacValue)
 {
     //printf(" raw DAC: %i\n",dacValue);
+    if(outputInhibited)
+    {
+        return;
+    }
+    dacOutput = dacValue;
     deviceDAC->setVOut(dacValue);
 }
 
+/** DAC - write a sequence of raw DAC values with the max. update rate of the bus
+ *  (fast write, one transaction per 16 values: ~5.3k values/s @100kHz, ~21k values/s @400kHz)
+ * 
+ *  @param const uint16_t * dacValues - 
+ *  @param uint8_t count - 
+ *	@return bool - (false): DAC not acknowledged
+ */
+bool RL021_DigitalLoad::SetRawDacBurst(const uint16_t * dacValues, uint8_t count)
+{
+    if(outputInhibited)
+    {
+        return false;
+    }
+    if(count > 0)
+    {
+        dacOutput = dacValues[count-1];
+    }
+    return deviceDAC->setVOutBurst(dacValues, count);
+}
+
+/** DAC - write a raw DAC value directly on the bus without executing the I2C engine queue first 
+ *  (SetRawDacBurst() flushes the queue of all devices on the bus). Queued writes of the DAC are dropped,
+ *  they would overwrite the value later.
+ * 
+ *  @param uint16_t dacValue - 
+ *	@return bool - (false): DAC not acknowledged or output inhibited
+ */
+bool RL021_DigitalLoad::SetRawDacImmediate(uint16_t dacValue)
+{
+    if(outputInhibited)
+    {
+        return false;
+    }
+    dacOutput = dacValue;
+    return deviceDAC->setVOutImmediate(dacValue);
+}
+
+/************************************************************************************************************************************************/
+/* Public - shutdown                                                                                                                           
+/************************************************************************************************************************************************/
+/** Switch the load off at once: DAC 0 is written on the bus without waiting for queued transactions,
+ *  queued DAC writes are dropped (they must not overwrite the shutdown). Load mode CC with 0mA,
+ *  DAC writes are blocked until ReleaseShutdown().
+ * 
+ *  @param /
+ *	@return bool - (false): DAC not acknowledged (DAC writes are blocked anyway)
+ */
+bool RL021_DigitalLoad::Shutdown()
+{
+    outputInhibited = true;
+    
+    loadMode = LOAD_MODE_CC;
+    modeSetpoint = 0;
+    setpoint_mA = 0;
+    regulationIntegral = 0;
+    dacOutput = 0;
+    
+    return deviceDAC->setVOutImmediate(0);
+}
+
+/// Allow DAC writes again, the load restarts with 0mA
+void RL021_DigitalLoad::ReleaseShutdown()
+{
+    if(!outputInhibited)
+    {
+        return;
+    }
+    outputInhibited = false;
+    SetCurrent_mA(0);
+}
+
+bool RL021_DigitalLoad::IsShutdown()
+{
+    return outputInhibited;
+}
+
 /************************************************************************************************************************************************/
 /* Public - Calibration / Settings                                                                                                                           
 /************************************************************************************************************************************************/
@@ -270,24 +744,58 @@ void RL021_DigitalLoad::SetRawDac(uint16_t dacValue)
 void RL021_DigitalLoad::SetCalibrationData(S_RL021_Calibration newCalibrationData)
 {
     calibrationData = newCalibrationData;
+    UpdateTransferFunctions();
 }
 
 void RL021_DigitalLoad::SetCalibration_DAC_slope(float calValue, E_DAC_RANGE range)
 {
-    
+    calibrationData.slope_dac[range] = calValue;
+    UpdateTransferFunctions();
 }
 void RL021_DigitalLoad::SetCalibration_DAC_offset(float calValue, E_DAC_RANGE range)
 {
-    
+    calibrationData.offset_dac[range] = calValue;
+    UpdateTransferFunctions();
+}
+
+/** Piecewise linear correction of the calibrated value of a channel (NULL: linear calibration only)
+ *  The table belongs to the actual jumper setting, SetJumperSetting() removes it.
+ *  The table is not copied, it has to exist as long as it is used.
+ * 
+ *  @param E_ADC_CHANNEL channel - ADC_CH_CURRENT, ADC_CH_VLOAD, ADC_CH_VEXT
+ *  @param const S_RL021_CorrectionTable * table - 
+ *	@return /
+ */
+void RL021_DigitalLoad::SetCorrectionTable(E_ADC_CHANNEL channel, const S_RL021_CorrectionTable * table)
+{
+    if(channel < ADC_CH_NTC)
+    {
+        correctionTable[channel] = table;
+    }
 }
 
+/// ADC_CH_CURRENT: range index like DAC (RANGE_DAC_LOW / RANGE_DAC_HIGH)
 void RL021_DigitalLoad::SetCalibration_ADC_slope(float calValue, E_ADC_CHANNEL channel, E_ADC_RANGE range)
 {
-    
+    calibrationData.slope_adc[range][channel] = calValue;
+    UpdateTransferFunctions();
 }
 void RL021_DigitalLoad::SetCalibration_ADC_offset(float calValue, E_ADC_CHANNEL channel, E_ADC_RANGE range)
 {
-    
+    calibrationData.offset_adc[range][channel] = calValue;
+    UpdateTransferFunctions();
+}
+
+/// PGA gain index 1 ... 3 (x2, x4, x8) relative to x1
+void RL021_DigitalLoad::SetCalibration_PGA(uint8_t gain, int16_t gainError_ppm, int16_t offset)
+{
+    if(gain == 0 || gain >= RL021_PGA_GAINS)
+    {
+        return;
+    }
+    calibrationData.gainError_pga[gain-1] = gainError_ppm;
+    calibrationData.offset_pga[gain-1] = offset;
+    UpdateTransferFunctions();
 }
 
 
@@ -304,15 +812,20 @@ void RL021_DigitalLoad::SetJumperSetting(E_JUMPER jumper,bool closed)
     if(jumper == JP2_CURRENT)
     {
        highRangeSelected_current = closed;
+       correctionTable[ADC_CH_CURRENT] = NULL;
     }
     else if(jumper == JP3_VLOAD)
     {
         lowRangeSelected_Vload = closed;
+        correctionTable[ADC_CH_VLOAD] = NULL;
     }
     else if(jumper == JP4_VEXT)
     {
         lowRangeSelected_Vext = closed;
+        correctionTable[ADC_CH_VEXT] = NULL;
     }
+    
+    UpdateTransferFunctions();
 }
 
 /************************************************************************************************************************************************/
@@ -325,70 +838,797 @@ void RL021_DigitalLoad::SetJumperSetting(E_JUMPER jumper,bool closed)
  */
 void RL021_DigitalLoad::SetCurrent_mA(uint16_t current_mA)
 {
-    /// Calculate DAC value
-    uint16_t dacValue = CalculateDAC(current_mA);
+    loadMode = LOAD_MODE_CC;
+    modeSetpoint = current_mA;
     
-    /// Write value to DAC
-    SetRawDac(dacValue);
+    if(regulationEnabled)
+    {
+        /// Restart settling detection, keep learned integral correction
+        setpointTimestamp_us = micros();
+        settlingTime_ms = 0;
+        regulationInTolerance = 0;
+        regulationSettled = false;
+        settlingTargetMissed = false;
+    }
+    
+    WriteCurrentSetpoint(current_mA);
 }
 
+/** Write calculated DAC value for current setpoint, 
+ *  incl. the learned integral correction if regulation is enabled
+ * 
+ *  @param uint16_t current_mA - 
+ *	@return /
+ */
+void RL021_DigitalLoad::WriteCurrentSetpoint(uint16_t current_mA)
+{
+    /// Calculate DAC value
+    int32_t dacValue = CalculateDAC(current_mA);
+    
+    setpoint_mA = current_mA;
+    
+    if(regulationEnabled && current_mA > 0)
+    {
+        dacValue += (int32_t)regulationIntegral;
+        dacValue = constrain(dacValue, (int32_t)0, (int32_t)4095);
+    }
+    
+    /// Write value to DAC
+    SetRawDac(dacValue);
+}
 
 /************************************************************************************************************************************************/
-/* Public - get                                                                                                                           
+/* Public - load modes                                                                                                                           
 /************************************************************************************************************************************************/
+/** Set load mode and setpoint
+ *  CV/CP/CR: the current setpoint is calculated on every new load voltage measurement (see LoadModeStep())
+ * 
+ *  @param E_LOAD_MODE mode - 
+ *  @param uint32_t setpoint - CC [mA], CV [mV], CP [mW], CR [mOhm]
+ *	@return /
+ */
+void RL021_DigitalLoad::SetLoadMode(E_LOAD_MODE mode, uint32_t setpoint)
+{
+    if(mode == LOAD_MODE_CC)
+    {
+        SetCurrent_mA(setpoint);
+        return;
+    }
+    
+    /// Settling of the underlying current regulation is restarted
+    SetCurrent_mA(0);
+    
+    loadMode = mode;
+    modeSetpoint = setpoint;
+    
+    /// CP / CR: start with latest voltage, CV: start at 0 mA
+    if(mode != LOAD_MODE_CV && measurement[ADC_CH_VLOAD].valid)
+    {
+        LoadModeStep();
+    }
+}
 
-/// Get measured current from ADC
-uint16_t RL021_DigitalLoad::GetCurrent_mA()
+E_LOAD_MODE RL021_DigitalLoad::GetLoadMode()
+{
+    return loadMode;
+}
+
+/// Max. current in CV/CP/CR mode [mA]
+void RL021_DigitalLoad::SetModeCurrentLimit_mA(uint16_t limit_mA)
+{
+    modeCurrentLimit_mA = limit_mA;
+}
+
+/// CV mode: current change per voltage error [mA/mV]
+void RL021_DigitalLoad::SetCvGain(float gain_mA_per_mV)
+{
+    cvGain = gain_mA_per_mV;
+}
+
+/** Calculate current setpoint of actual mode from latest load voltage
+ *  CP: I = P / V
+ *  CR: I = V / R
+ *  CV: I += cvGain * (V - Vset)  (sink more current if voltage is above setpoint)
+ * 
+ *  @param /
+ *	@return /
+ */
+void RL021_DigitalLoad::LoadModeStep()
 {
-    uint16_t current_mA;
+    int32_t voltage_mV = measurement[ADC_CH_VLOAD].value;
+    int32_t current_mA = 0;
     
-    /// Get adc raw data from Vload channel 
-    uint16_t rawAdc = GetRawAdc(ADC_CH_CURRENT);
+    if(voltage_mV < 0)
+    {
+        voltage_mV = 0;
+    }
     
-    /// Calculate Load Current from ADC raw data
-    current_mA =  CalculateCurrent(rawAdc);
+    switch(loadMode)
+    {
+        case LOAD_MODE_CP:
+            /// mW * 1000 / mV = mA, no voltage: max. current
+            current_mA = (voltage_mV > 0) ? (int32_t)((modeSetpoint * 1000) / voltage_mV) : modeCurrentLimit_mA;
+            break;
+        case LOAD_MODE_CR:
+            /// mV * 1000 / mOhm = mA
+            current_mA = (modeSetpoint > 0) ? (int32_t)(((uint32_t)voltage_mV * 1000) / modeSetpoint) : modeCurrentLimit_mA;
+            break;
+        case LOAD_MODE_CV:
+            current_mA = setpoint_mA + (int32_t)(cvGain * (voltage_mV - (int32_t)modeSetpoint));
+            break;
+        default:
+            return;
+    }
+    
+    current_mA = constrain(current_mA, (int32_t)0, (int32_t)modeCurrentLimit_mA);
     
-    return current_mA;
+    WriteCurrentSetpoint(current_mA);
 }
 
-/// Get measured load voltage from ADC
-uint16_t RL021_DigitalLoad::GetVoltageLoad_mV()
+/************************************************************************************************************************************************/
+/* Public - closed-loop current regulation                                                                                                                           
+/************************************************************************************************************************************************/
+/** Set regulation parameters (gains, anti-windup, settling criteria)
+ * 
+ *  @param S_RL021_Regulation newParameters - 
+ *	@return /
+ */
+void RL021_DigitalLoad::SetRegulationParameters(S_RL021_Regulation newParameters)
+{
+    regulation = newParameters;
+}
+
+/** Enable / disable closed-loop current regulation
+ *  The DAC value of SetCurrent_mA() is trimmed by a PI controller on every new measurement of ADC_CH_CURRENT.
+ *  Regulation rate is the acquisition rate of the current channel, use StartAcquisition(1<<ADC_CH_CURRENT) 
+ *  for the max. rate (one regulation step per conversion).
+ * 
+ *  @param bool enable - 
+ *	@return /
+ */
+void RL021_DigitalLoad::EnableRegulation(bool enable)
 {
-    uint16_t voltage_mV;    
+    bool wasEnabled = regulationEnabled;
     
-    /// Get adc raw data from Vload channel 
-    uint16_t rawAdc = GetRawAdc(ADC_CH_VLOAD);
+    regulationEnabled = enable;
+    regulationIntegral = 0;
+    regulationInTolerance = 0;
+    regulationSettled = !enable;
+    settlingTargetMissed = false;
+    settlingTime_ms = 0;
+    setpointTimestamp_us = micros();
+    
+    /// Back to open loop value
+    if(wasEnabled && !enable)
+    {
+        WriteCurrentSetpoint(setpoint_mA);
+    }
+}
+
+/// Current is within tolerance since last setpoint change
+bool RL021_DigitalLoad::IsSettled()
+{
+    return regulationSettled;
+}
+
+/// Settling target was missed since last setpoint change
+bool RL021_DigitalLoad::IsSettlingTargetMissed()
+{
+    return settlingTargetMissed;
+}
+
+/// Settling time of the last setpoint change [ms] (0: not settled yet)
+uint16_t RL021_DigitalLoad::GetSettlingTime_ms()
+{
+    return settlingTime_ms;
+}
+
+/** One PI regulation step with the latest current measurement
+ *  DAC = CalculateDAC(setpoint) + kp * error + integral, error in DAC LSB
+ *  Anti-windup: integral is limited to maxTrim and frozen while the DAC is saturated
+ * 
+ *  @param /
+ *	@return /
+ */
+void RL021_DigitalLoad::RegulationStep()
+{
+    if(setpoint_mA == 0)
+    {
+        /// Load off: nothing to regulate
+        regulationSettled = true;
+        return;
+    }
     
-    /// Get calculated voltage
-    voltage_mV = CalculateVoltage(rawAdc, ADC_CH_VLOAD);
+    float slope = calibrationData.slope_dac[highRangeSelected_current];
+    int32_t error_mA = (int32_t)setpoint_mA - measurement[ADC_CH_CURRENT].value;
+    float error = error_mA / slope;
     
-    return voltage_mV; 
+    float integral = regulationIntegral + regulation.ki * error;
+    integral = constrain(integral, -(float)regulation.maxTrim, (float)regulation.maxTrim);
+    
+    float output = CalculateDAC(setpoint_mA) + regulation.kp * error + integral;
+    
+    if(output > 4095)
+    {
+        output = 4095;
+        if(error > 0)
+        {
+            integral = regulationIntegral;
+        }
+    }
+    else if(output < 0)
+    {
+        output = 0;
+        if(error < 0)
+        {
+            integral = regulationIntegral;
+        }
+    }
+    
+    regulationIntegral = integral;
+    SetRawDac((uint16_t)(output + 0.5));
+    
+    /// Settled detection
+    uint32_t sinceSetpoint_ms = (measurement[ADC_CH_CURRENT].timestamp_us - setpointTimestamp_us) / 1000;
+    
+    if(abs(error_mA) <= regulation.tolerance_mA)
+    {
+        if(regulationInTolerance < 255)
+        {
+            regulationInTolerance++;
+        }
+    }
+    else
+    {
+        regulationInTolerance = 0;
+    }
+    
+    if(!regulationSettled && regulationInTolerance >= regulation.settledSteps)
+    {
+        regulationSettled = true;
+        settlingTime_ms = sinceSetpoint_ms;
+    }
+    
+    if(!regulationSettled && sinceSetpoint_ms > regulation.settlingTarget_ms)
+    {
+        settlingTargetMissed = true;
+    }
 }
 
-/// Get measured external voltage from ADC
-uint16_t RL021_DigitalLoad::GetVoltageExt_mV()
+
+/************************************************************************************************************************************************/
+/* Public - background acquisition                                                                                                                           
+/************************************************************************************************************************************************/
+/** Start background acquisition
+ *  ADC runs in continuous mode, the selected channels are converted in rotation 
+ *  (a single channel is converted without any configuration write).
+ *  Each result is stored in the measurement cache, the getters return the cached values.
+ *  Requires an I2C_Engine attached to the ADC driver.
+ * 
+ *  @param uint8_t channelMask - channels to convert (bit: 1<<E_ADC_CHANNEL)
+ *	@return /
+ */
+void RL021_DigitalLoad::StartAcquisition(uint8_t channelMask)
+{
+    acquisitionMask = channelMask & ((1<<ADC_CH_LAST)-1);
+    InvalidateMeasurements(~acquisitionMask);
+    acquisitionActive = (acquisitionMask != 0);
+    acquisitionStarted = false;
+    acquisitionExternal = false;
+    acquisitionChannel = NextAcquisitionChannel((E_ADC_CHANNEL)(ADC_CH_LAST-1));
+}
+
+/** Start acquisition by an external sequencer (synchronized capture of RL021_LoadGroup)
+ *  Service() does not use the ADC, measurements are stored with StoreExternalMeasurement().
+ *  Getters return the cached values of the selected channels like with StartAcquisition().
+ * 
+ *  @param uint8_t channelMask - channels converted by the sequencer (bit: 1<<E_ADC_CHANNEL)
+ *	@return /
+ */
+void RL021_DigitalLoad::StartExternalAcquisition(uint8_t channelMask)
 {
-    uint16_t voltage_mV;    
+    StartAcquisition(channelMask);
+    acquisitionExternal = acquisitionActive;
+}
+
+/** Store result of an external conversion, regulation / load mode step like Service()
+ * 
+ *  @param E_ADC_CHANNEL channel - 
+ *  @param int16_t rawAdcRead - ADC result (actual resolution)
+ *  @param uint32_t timestamp_us - micros() at the end of the conversion
+ *	@return /
+ */
+void RL021_DigitalLoad::StoreExternalMeasurement(E_ADC_CHANNEL channel, int16_t rawAdcRead, uint32_t timestamp_us)
+{
+    /// armed with GetAdcGain()
+    bool newValue = StoreFilteredMeasurement(channel, ScaleRawAdc(rawAdcRead), adcGain[channel], timestamp_us);
+    ProcessMeasurement(channel, newValue);
+}
+
+/// Stop background acquisition, cached measurements are invalid until GetFreshMeasurement() / next acquisition
+void RL021_DigitalLoad::StopAcquisition()
+{
+    acquisitionActive = false;
+    acquisitionStarted = false;
+    acquisitionExternal = false;
+    InvalidateMeasurements((1<<ADC_CH_LAST)-1);
+}
+
+/// Mark cached measurements as not valid (value and timestamp are kept)
+void RL021_DigitalLoad::InvalidateMeasurements(uint8_t channelMask)
+{
+    for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+    {
+        if(channelMask & (1<<ch))
+        {
+            measurement[ch].valid = false;
+        }
+    }
+}
+
+/** Service background acquisition, call frequently (together with I2C_Engine::Service())
+ * 
+ *  @param /
+ *	@return bool - (true): new measurement stored in cache
+ */
+bool RL021_DigitalLoad::Service()
+{
+    if(!acquisitionActive || acquisitionExternal)
+    {
+        return false;
+    }
+    
+    if(!acquisitionStarted)
+    {
+        /// Configure ADC: Channel, resolution, continuous, PGA of the channel (retry with next call if I2C queue is full)
+        conversionGain = adcGain[acquisitionChannel];
+        acquisitionStarted = deviceADC->StartConversion(acquisitionChannel+1, adcResolution, 1, 1<<conversionGain);
+        return false;
+    }
+    
+    MCP3428::conversionstate_t state = deviceADC->Service();
+    
+    if(state == MCP3428::conversionerror || state == MCP3428::conversionidle)
+    {
+        /// bus error or conversion taken by a fresh read: restart channel
+        deviceADC->GetConversionResult();
+        acquisitionStarted = false;
+        return false;
+    }
+    
+    if(state != MCP3428::conversionready)
+    {
+        return false;
+    }
     
-    /// Get adc raw data from Vext channel 
-    uint16_t rawAdc = GetRawAdc(ADC_CH_VEXT);
+    bool newValue = StoreFilteredMeasurement(acquisitionChannel, GetRawAdcResult(), conversionGain, micros());
+    ProcessMeasurement(acquisitionChannel, newValue);
     
-    /// Get calculated voltage
-    voltage_mV = CalculateVoltage(rawAdc, ADC_CH_VEXT);
+    E_ADC_CHANNEL next = NextAcquisitionChannel(acquisitionChannel);
+    if(next == acquisitionChannel && adcGain[next] == conversionGain)
+    {
+        /// single channel: wait for next result of continuous conversion
+        acquisitionStarted = deviceADC->NextConversion();
+    }
+    else
+    {
+        acquisitionChannel = next;
+        conversionGain = adcGain[acquisitionChannel];
+        acquisitionStarted = deviceADC->StartConversion(acquisitionChannel+1, adcResolution, 1, 1<<conversionGain);
+    }
     
-    return voltage_mV;
+    return true;
 }
 
-/// Get NTC temperature in °C x10
-int16_t RL021_DigitalLoad::GetTemperature()
+/** Get latest measurement of channel from the cache (never blocks, safe in scheduler tasks)
+ *  valid is false if the channel is not acquired in background or not converted yet, the entry then holds
+ *  the last value - the caller decides (e.g. skip the value or read it with GetFreshMeasurement())
+ * 
+ *  @param E_ADC_CHANNEL channel - 
+ *	@return const S_RL021_Measurement * - measurement of channel
+ */
+const S_RL021_Measurement * RL021_DigitalLoad::GetMeasurement(E_ADC_CHANNEL channel)
 {
-    int16_t tempCelsiusX10 = 0;
+    return &measurement[channel];
+}
+
+/** Get fresh measurement of channel (blocking read, result is stored in cache)
+ * 
+ *  @param E_ADC_CHANNEL channel - 
+ *	@return const S_RL021_Measurement * - measurement of channel
+ */
+const S_RL021_Measurement * RL021_DigitalLoad::GetFreshMeasurement(E_ADC_CHANNEL channel)
+{
+    uint8_t gain = adcGain[channel];
+    uint16_t rawAdc = GetRawAdc(channel);
+    
+    /// clipped: repeat with x1 (auto-gain)
+    if(gain > 0 && IsClipped(rawAdc) && UpdateGain(channel, gain, rawAdc))
+    {
+        gain = adcGain[channel];
+        rawAdc = GetRawAdc(channel);
+    }
+    
+    StoreMeasurement(channel, rawAdc, gain);
+    UpdateGain(channel, gain, rawAdc);
+    
+    return &measurement[channel];
+}
+
+
+/************************************************************************************************************************************************/
+/* Public - filter                                                                                                                           
+/************************************************************************************************************************************************/
+/** Set filter of the acquisition of one channel (filter state is reset)
+ *  FILTER_BOXCAR:   moving average of the last 2^shift conversions (shift 1 ... RL021_FILTER_BOXCAR_SHIFT_MAX)
+ *  FILTER_EMA:      exponential average, alpha = 2^-shift (shift 1 ... RL021_FILTER_EMA_SHIFT_MAX)
+ *  FILTER_DECIMATE: average of 2^shift conversions, one output per block (shift 1 ... RL021_FILTER_DECIMATE_SHIFT_MAX)
+ * 
+ *  @param E_ADC_CHANNEL channel - 
+ *  @param E_RL021_FILTER type - 
+ *  @param uint8_t shift - filter length 2^shift
+ *	@return bool - (false): shift out of range, filter unchanged
+ */
+bool RL021_DigitalLoad::SetFilter(E_ADC_CHANNEL channel, E_RL021_FILTER type, uint8_t shift)
+{
+    uint8_t shiftMax;
+    switch(type)
+    {
+        case FILTER_BOXCAR:
+            shiftMax = RL021_FILTER_BOXCAR_SHIFT_MAX;
+            break;
+        case FILTER_EMA:
+            shiftMax = RL021_FILTER_EMA_SHIFT_MAX;
+            break;
+        case FILTER_DECIMATE:
+            shiftMax = RL021_FILTER_DECIMATE_SHIFT_MAX;
+            break;
+        default:
+            type = FILTER_NONE;
+            shift = 1;
+            shiftMax = 1;
+            break;
+    }
+    
+    if(channel >= ADC_CH_LAST || shift < 1 || shift > shiftMax)
+    {
+        return false;
+    }
+    
+    memset(&filter[channel], 0, sizeof(S_RL021_Filter));
+    filter[channel].type = type;
+    filter[channel].shift = (type == FILTER_NONE) ? 0 : shift;
+    return true;
+}
+
+E_RL021_FILTER RL021_DigitalLoad::GetFilterType(E_ADC_CHANNEL channel)
+{
+    return (E_RL021_FILTER)filter[channel].type;
+}
+
+uint8_t RL021_DigitalLoad::GetFilterShift(E_ADC_CHANNEL channel)
+{
+    return filter[channel].shift;
+}
+
+/** One filter step, O(1), integer only
+ *  Boxcar / EMA start with the first sample (window filled / average = first sample, no ramp up)
+ * 
+ *  @param S_RL021_Filter * filter - 
+ *  @param uint16_t x - raw ADC value [0-32767]
+ *	@return bool - (true): new output (decimation: every 2^shift-th call)
+ */
+bool RL021_DigitalLoad::ApplyFilter(S_RL021_Filter * filter, uint16_t x)
+{
+    switch(filter->type)
+    {
+        case FILTER_BOXCAR:
+            if(filter->count == 0)
+            {
+                for(uint8_t i=0;i<(1<<filter->shift);i++)
+                {
+                    filter->window[i] = x;
+                }
+                filter->sum = (uint32_t)x << filter->shift;
+                filter->count = 1;
+            }
+            else
+            {
+                filter->sum += x;
+                filter->sum -= filter->window[filter->index];
+            }
+            filter->window[filter->index] = x;
+            filter->index = (filter->index + 1) & ((1<<filter->shift) - 1);
+            filter->output = filter->sum >> filter->shift;
+            return true;
+            
+        case FILTER_EMA:
+            /// sum: average << shift
+            if(filter->count == 0)
+            {
+                filter->sum = (uint32_t)x << filter->shift;
+                filter->count = 1;
+            }
+            else
+            {
+                filter->sum = filter->sum - (filter->sum >> filter->shift) + x;
+            }
+            filter->output = (filter->sum + (1UL << (filter->shift - 1))) >> filter->shift;
+            return true;
+            
+        case FILTER_DECIMATE:
+            filter->sum += x;
+            if(++filter->count < (1<<filter->shift))
+            {
+                return false;
+            }
+            filter->output = filter->sum >> filter->shift;
+            filter->sum = 0;
+            filter->count = 0;
+            return true;
+            
+        default:
+            filter->output = x;
+            return true;
+    }
+}
+
+/** Scale filter state to another PGA gain (nominal factor 2^shift), the average continues without restart
+ *  Boxcar window values are limited to the 16-bit range.
+ * 
+ *  @param S_RL021_Filter * filter - 
+ *  @param int8_t shift - new gain index - old gain index
+ *	@return /
+ */
+void RL021_DigitalLoad::RescaleFilter(S_RL021_Filter * filter, int8_t shift)
+{
+    if(filter->type == FILTER_NONE)
+    {
+        return;
+    }
     
-    /// Get adc raw data from NTC channel 
-    uint16_t rawAdc = GetRawAdc(ADC_CH_NTC);
+    if(filter->type == FILTER_BOXCAR)
+    {
+        filter->sum = 0;
+        for(uint8_t i=0;i<(1<<filter->shift);i++)
+        {
+            uint32_t x = (shift > 0) ? ((uint32_t)filter->window[i] << shift) : (filter->window[i] >> -shift);
+            filter->window[i] = min(x, (uint32_t)UINT16_MAX);
+            filter->sum += filter->window[i];
+        }
+    }
+    else
+    {
+        filter->sum = (shift > 0) ? (filter->sum << shift) : (filter->sum >> -shift);
+    }
     
-    tempCelsiusX10 = CalculateTemperature(rawAdc);
+    uint32_t output = (shift > 0) ? ((uint32_t)filter->output << shift) : (filter->output >> -shift);
+    filter->output = min(output, (uint32_t)UINT16_MAX);
+}
+
+
+/************************************************************************************************************************************************/
+/* Public - streaming                                                                                                                           
+/************************************************************************************************************************************************/
+/** Set ADC resolution for all conversions
+ *  12-bit: 240 SPS, 14-bit: 60 SPS, 16-bit: 15 SPS
+ *  Raw values are always scaled to 16-bit range, calibration data stays valid
+ * 
+ *  @param uint8_t resolution - 12, 14, 16
+ *	@return /
+ */
+void RL021_DigitalLoad::SetAdcResolution(uint8_t resolution)
+{
+    if(resolution != 12 && resolution != 14)
+    {
+        resolution = 16;
+    }
+    adcResolution = resolution;
     
-    return tempCelsiusX10;
+    /// Running acquisition is restarted with new resolution
+    acquisitionStarted = false;
+}
+
+uint8_t RL021_DigitalLoad::GetAdcResolution()
+{
+    return adcResolution;
+}
+
+/** PGA auto-gain: each conversion of a selected channel chooses the gain of the next conversion of this channel
+ *  (highest gain without clipping, hysteresis between RL021_PGA_LOW_LIMIT and RL021_PGA_HIGH_LIMIT).
+ *  Resolution at low signal levels: x8 with 12-bit like x1 with 15-bit, without averaging.
+ *  Fixed gain (SetAdcGain()) of the other channels, x1 after Initialize().
+ * 
+ *  @param uint8_t channelMask - bit: 1<<E_ADC_CHANNEL
+ *	@return /
+ */
+void RL021_DigitalLoad::SetAutoGain(uint8_t channelMask)
+{
+    autoGainMask = channelMask & ((1<<ADC_CH_LAST)-1);
     
+    for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+    {
+        gainUpCount[ch] = 0;
+    }
+}
+
+uint8_t RL021_DigitalLoad::GetAutoGain()
+{
+    return autoGainMask;
+}
+
+/** Set PGA gain of the next conversion of a channel, filter state follows
+ * 
+ *  @param E_ADC_CHANNEL channel - 
+ *  @param uint8_t gain - gain index 0 ... 3 (x1, x2, x4, x8)
+ *	@return /
+ */
+void RL021_DigitalLoad::SetAdcGain(E_ADC_CHANNEL channel, uint8_t gain)
+{
+    if(channel >= ADC_CH_LAST || gain >= RL021_PGA_GAINS || gain == adcGain[channel])
+    {
+        return;
+    }
+    
+    RescaleFilter(&filter[channel], gain - adcGain[channel]);
+    adcGain[channel] = gain;
+    gainUpCount[channel] = 0;
+    
+    /// single channel acquisition: continuous conversion is restarted with the new gain
+    acquisitionStarted = false;
+}
+
+uint8_t RL021_DigitalLoad::GetAdcGain(E_ADC_CHANNEL channel)
+{
+    return (channel < ADC_CH_LAST) ? adcGain[channel] : 0;
+}
+
+/** Ring buffer of the stream, stops streaming
+ *  The buffer is not copied, it has to exist as long as it is used.
+ * 
+ *  @param S_RL021_StreamSample * buffer - NULL: no streaming
+ *  @param uint8_t size - number of samples, e.g. RL021_STREAM_BUFFER_SIZE
+ *	@return /
+ */
+void RL021_DigitalLoad::SetStreamBuffer(S_RL021_StreamSample * buffer, uint8_t size)
+{
+    streamActive = false;
+    streamBuffer = buffer;
+    streamSize = (buffer != NULL) ? size : 0;
+    streamHead = 0;
+    streamCount = 0;
+}
+
+/** Start streaming: background acquisition of the selected channels, 
+ *  every conversion is stored in the stream ring buffer (with its timestamp) 
+ *  until it is read by the host interface. If the buffer is full, new samples 
+ *  are dropped and counted (GetStreamOverflows()).
+ * 
+ *  @param uint8_t channelMask - channels to stream (bit: 1<<E_ADC_CHANNEL)
+ *  @param uint8_t resolution - ADC resolution 12, 14, 16
+ *	@return bool - (false): no stream buffer (SetStreamBuffer())
+ */
+bool RL021_DigitalLoad::StartStreaming(uint8_t channelMask, uint8_t resolution)
+{
+    if(streamSize == 0)
+    {
+        return false;
+    }
+    
+    streamHead = 0;
+    streamCount = 0;
+    streamOverflows = 0;
+    streamActive = true;
+    
+    SetAdcResolution(resolution);
+    StartAcquisition(channelMask);
+    return true;
+}
+
+/// Stop storing samples in the stream buffer (acquisition continues)
+void RL021_DigitalLoad::StopStreaming()
+{
+    streamActive = false;
+}
+
+bool RL021_DigitalLoad::IsStreaming()
+{
+    return streamActive;
+}
+
+/// Channels of background acquisition / stream (bit: 1<<E_ADC_CHANNEL)
+uint8_t RL021_DigitalLoad::GetAcquisitionMask()
+{
+    return acquisitionMask;
+}
+
+/// Number of samples in stream buffer
+uint8_t RL021_DigitalLoad::StreamAvailable()
+{
+    return streamCount;
+}
+
+/** Read stream sample without removing it
+ * 
+ *  @param uint8_t index - 0: oldest sample
+ *  @param S_RL021_StreamSample * sample - 
+ *	@return bool - (false): no sample at index
+ */
+bool RL021_DigitalLoad::PeekStreamSample(uint8_t index, S_RL021_StreamSample * sample)
+{
+    if(index >= streamCount)
+    {
+        return false;
+    }
+    
+    *sample = streamBuffer[(streamHead + index) % streamSize];
+    return true;
+}
+
+/// Remove oldest samples from stream buffer
+void RL021_DigitalLoad::DropStreamSamples(uint8_t count)
+{
+    if(count > streamCount)
+    {
+        count = streamCount;
+    }
+    if(count == 0)
+    {
+        return;
+    }
+
+    streamHead = (streamHead + count) % streamSize;
+    streamCount -= count;
+}
+
+/// Number of samples lost since StartStreaming() because the stream buffer was full
+uint32_t RL021_DigitalLoad::GetStreamOverflows()
+{
+    return streamOverflows;
+}
+
+/// Store latest measurement of channel in stream buffer
+void RL021_DigitalLoad::PushStreamSample(E_ADC_CHANNEL channel)
+{
+    if(streamCount >= streamSize)
+    {
+        streamOverflows++;
+        return;
+    }
+    
+    S_RL021_StreamSample * sample = &streamBuffer[(streamHead + streamCount) % streamSize];
+    sample->timestamp_us = measurement[channel].timestamp_us;
+    sample->raw = measurement[channel].raw;
+    sample->channel = channel;
+    sample->gain = measurement[channel].gain;
+    streamCount++;
+}
+
+
+/************************************************************************************************************************************************/
+/* Public - get                                                                                                                           
+/************************************************************************************************************************************************/
+
+/// Get measured current from ADC
+uint16_t RL021_DigitalLoad::GetCurrent_mA()
+{
+    return GetMeasurement(ADC_CH_CURRENT)->value;
+}
+
+/// Get measured load voltage from ADC
+uint16_t RL021_DigitalLoad::GetVoltageLoad_mV()
+{
+    return GetMeasurement(ADC_CH_VLOAD)->value;
+}
+
+/// Get measured external voltage from ADC
+uint16_t RL021_DigitalLoad::GetVoltageExt_mV()
+{
+    return GetMeasurement(ADC_CH_VEXT)->value;
+}
+
+/// Get NTC temperature in °C x10
+int16_t RL021_DigitalLoad::GetTemperature()
+{
+    return GetMeasurement(ADC_CH_NTC)->value;
 }
@@ -2,7 +2,7 @@
 * \file    RL021_DigitalLoad.h
 * \brief    Control of Digital Constant Current Source (DAC + NFET) with feedback (ADC)
 * \brief    Required hardware: PCB RL-021/xx, I2C communication (via MCU / USB bridge / ...)    
-* \brief    Required drivers: MCP47x6.h, MCP3428.h
+* \brief    Required drivers: MCP47x6.h, MCP3428.h, I2C_Engine.h
 * 
 * \brief    basic functions: 
 *               set constant load current [mA] 
@@ -12,6 +12,30 @@
 *               measure actual NTC temperature [°C x10]
 * 
 *               set calibration values for used PCB
+*
+*               load modes CC, CV, CP, CR (calculated on device, see SetLoadMode())
+*
+*               filter per channel on the acquisition path: moving average, exponential, decimation (see SetFilter())
+*
+*               PGA auto-gain per channel (see SetAutoGain()): highest gain x1 ... x8 without clipping,
+*               calibration of the gains relative to x1 (S_RL021_Calibration: gainError_pga, offset_pga)
+*
+*               shutdown of the output (see Shutdown(), used by RL021_Supervisor)
+*
+* \brief    worst-case update latency of the load modes (load voltage/current step -> DAC write):
+*               T_conv: ADC conversion time (12-bit: 4.2ms, 14-bit: 16.7ms, 16-bit: 66.7ms)
+*               T_io:   period of I2C_Engine::Service() / Service() calls (sketch loop)
+*               N:      number of acquired channels (ADC_CH_CURRENT + ADC_CH_VLOAD: N=2)
+*               Each conversion needs 2 queued transactions (configuration, result) and max. T_conv/16 re-poll.
+*               T_ch = T_conv*17/16 + 2*T_io
+*
+*               CC open loop: T_io                    (DAC write queued)
+*               CC regulated: (N+1)*T_ch + T_io       per regulation step
+*               CP, CR:       (N+1)*T_ch + T_io       voltage step fully converted, then one DAC write
+*               CV:           (N+1)*T_ch + T_io       per step, integrating over several steps
+*
+*               e.g. N=2, T_io=10ms: 16-bit: 283ms, 12-bit: 83ms
+*                    N=2, T_io=1ms (acquisition task of DigitalLoadExample): 16-bit: 220ms, 12-bit: 20ms
 * 
 * \author  Julian Schindler
 *
@@ -29,31 +53,17 @@
 #include <stdio.h>
 #include <stdint.h>
 
-// Use the following define for code tests without required hardware (ADC and DAC is simulated)
-//#define MOCK_ADC_DAC
-
-//////////////////////////////////////////////////////
-#ifndef MOCK_ADC_DAC
+/// I2C
+//#include <Wire.h>
 
-	/// I2C
-	//#include <Wire.h>
+/// DAC
+/// https://github.com/holgerlembke/MCP47x6
+#include "MCP47x6.h"
 
-	/// DAC
-	/// https://github.com/holgerlembke/MCP47x6
-	#include "MCP47x6.h"
-
-	/// ADC
-	/// This code is designed to work with the MCP3428_I2CADC I2C Mini Module available from ControlEverything.com.
-	/// https://www.controleverything.com/content/Analog-Digital-Converters?sku=MCP3428_I2CADC#tabs-0-product_tabset-2
-	#include "MCP3428.h"
-
-
-#else
-
-  #include "MOCK-DAC-ADC.h"
-  
-#endif
-//////////////////////////////////////////////////////
+/// ADC
+/// This code is designed to work with the MCP3428_I2CADC I2C Mini Module available from ControlEverything.com.
+/// https://www.controleverything.com/content/Analog-Digital-Converters?sku=MCP3428_I2CADC#tabs-0-product_tabset-2
+#include "MCP3428.h"
 
 
 /************************************************************************/
@@ -102,6 +112,29 @@ typedef enum
     
 } E_ADC_RANGE;
 
+/// Load regulation mode (setpoint unit)
+typedef enum
+{
+    LOAD_MODE_CC,   /// constant current [mA]
+    LOAD_MODE_CV,   /// constant voltage [mV]
+    LOAD_MODE_CP,   /// constant power [mW]
+    LOAD_MODE_CR    /// constant resistance [mOhm]
+    
+} E_LOAD_MODE;
+
+/// Filter of the acquisition of one channel (length 2^shift)
+typedef enum
+{
+    FILTER_NONE,
+    FILTER_BOXCAR,      /// moving average, one output per conversion
+    FILTER_EMA,         /// exponential average, alpha = 2^-shift
+    FILTER_DECIMATE     /// block average, one output per 2^shift conversions
+    
+} E_RL021_FILTER;
+
+/// PGA gains of the MCP3428: gain index 0 ... 3 (x1, x2, x4, x8)
+#define RL021_PGA_GAINS             4
+
 /************************************************************************/
 /* Structs                                                              */
 /************************************************************************/
@@ -117,9 +150,129 @@ typedef struct
     float slope_dac[2]; 
     float offset_dac[2];
 
+    /// ADC - PGA x2, x4, x8 [gain index - 1] relative to x1, all channels (one PGA for all inputs)
+    /// raw(x1) = (raw - offset_pga) * (1 + gainError_pga / 10^6) / PGA
+    /// gain error [ppm]
+    int16_t gainError_pga[RL021_PGA_GAINS-1];
+    /// offset [raw ADC value at the gain]
+    int16_t offset_pga[RL021_PGA_GAINS-1];
+
 } S_RL021_Calibration;
 
+/// Points of a correction table
+#define RL021_CORRECTION_POINTS     8
 
+/// Piecewise linear correction of a calibrated channel: value += correction interpolated at raw ADC value
+typedef struct
+{
+    uint8_t points;
+    /// raw ADC value, ascending
+    uint16_t adc[RL021_CORRECTION_POINTS];
+    /// [mA] / [mV]
+    int16_t correction[RL021_CORRECTION_POINTS];
+
+} S_RL021_CorrectionTable;
+
+/// Integer transfer function y = x * gain - offset
+typedef struct
+{
+    /// Q16.16
+    int32_t gain;
+    /// Q16.16
+    int32_t offset;
+
+} S_RL021_FixedPoint;
+
+/// Closed-loop current regulation parameters
+/// Gains are normalized to the DAC calibration (current error is converted to DAC LSB), 
+/// so they are independent of the selected current range
+typedef struct
+{
+    /// proportional gain: fraction of the current error corrected per regulation step
+    float kp;
+    /// integral gain: fraction of the current error integrated per regulation step
+    float ki;
+    /// anti-windup: max. integral correction [DAC LSB]
+    uint16_t maxTrim;
+    /// settled: |error| <= tolerance [mA] ...
+    uint16_t tolerance_mA;
+    /// ... for this number of consecutive regulation steps
+    uint8_t settledSteps;
+    /// max. time from setpoint change to settled [ms], status flag if missed
+    uint16_t settlingTarget_ms;
+
+} S_RL021_Regulation;
+
+/// Latest measurement of one ADC channel
+typedef struct
+{
+    /// raw ADC value (latest conversion)
+    uint16_t raw;
+    /// raw ADC value at filter output (= raw without filter)
+    uint16_t filtered;
+    /// PGA gain index of raw / filtered
+    uint8_t gain;
+    /// calibrated value of filtered: current [mA], voltage [mV], temperature [°C x10]
+    int32_t value;
+    /// micros() at the end of the conversion
+    uint32_t timestamp_us;
+    /// (false): channel not measured yet
+    bool valid;
+
+} S_RL021_Measurement;
+
+
+
+
+
+/// PGA auto-gain (raw value at the actual gain, 16-bit range):
+/// next lower gain at / above RL021_PGA_HIGH_LIMIT (x1 if the conversion is clipped),
+/// higher gain after RL021_PGA_UP_SAMPLES conversions below RL021_PGA_LOW_LIMIT (max. 75% of the span at the new gain)
+#define RL021_PGA_HIGH_LIMIT        30720
+#define RL021_PGA_LOW_LIMIT         12288
+#define RL021_PGA_UP_SAMPLES        4
+
+/// Max. filter length 2^shift: boxcar (window RAM: 2 bytes per sample and channel), EMA, decimation
+#define RL021_FILTER_BOXCAR_SHIFT_MAX       3
+#define RL021_FILTER_EMA_SHIFT_MAX          8
+#define RL021_FILTER_DECIMATE_SHIFT_MAX     6
+
+/// State of one channel filter (integer, O(1) per conversion)
+typedef struct
+{
+    /// E_RL021_FILTER
+    uint8_t type;
+    /// length 2^shift
+    uint8_t shift;
+    /// boxcar: next window entry
+    uint8_t index;
+    /// boxcar / EMA: 0 until first sample, decimation: conversions of the actual block
+    uint8_t count;
+    /// boxcar: window sum, EMA: average << shift, decimation: block sum
+    uint32_t sum;
+    uint16_t window[1<<RL021_FILTER_BOXCAR_SHIFT_MAX];
+    uint16_t output;
+
+} S_RL021_Filter;
+
+/// One conversion of the stream buffer
+typedef struct
+{
+    /// micros() at the end of the conversion
+    uint32_t timestamp_us;
+    /// raw ADC value (16-bit range)
+    uint16_t raw;
+    /// E_ADC_CHANNEL
+    uint8_t channel;
+    /// PGA gain index of raw
+    uint8_t gain;
+
+} S_RL021_StreamSample;
+
+/// Number of conversions of a stream ring buffer (SetStreamBuffer(), 8 bytes each), e.g. -DRL021_STREAM_BUFFER_SIZE=48
+#ifndef RL021_STREAM_BUFFER_SIZE
+#define RL021_STREAM_BUFFER_SIZE    16
+#endif
 
 
 
@@ -140,17 +293,6 @@ class RL021_DigitalLoad {
     bool lowRangeSelected_Vload;
     /// Vext Range (JP4)
     bool lowRangeSelected_Vext;
-
-  /// NTC R/T characteristic for NTC Type: ("B57421V2103", R(25°C)=10kOhm, B_25/100=4000K
-  float NTC_TABLE_B57421V2103[42] = {96.158, 66.892, 47.127, 33.606, 24.243, //-55 -> -35
-                                 17.681, 13.032, 9.702, 7.2923, 5.5314, //- 30 -> -10
-                                4.2325, 3.2657, 2.54, 1.9907, 1.5716, //-5 -> 15
-                                1.2494, 1.0000, 0.80552, 0.65288,0.53229, // 20 -> 40
-                                0.43645, 0.35981, 0.29819, 0.24837,0.20787, // 45 -> 65
-                                0.17479, 0.14763, 0.12523, 0.10667, 0.091227, // 70 -> 90 
-                                0.078319, 0.067488, 0.058363, 0.050647, 0.044098, //95 -> 115
-                                0.03852, 0.033752, 0.029663, 0.026146, 0.023111, //120 -> 140
-                                0.020484, 0.018203}; // 145 -> 150
     
     ///////////////////////////////////////////////////////////////
     /// Values for transfer function ( DAC -> Current )
@@ -159,6 +301,9 @@ class RL021_DigitalLoad {
     /// Use default calibration data
     void SetDefaultCalibration();
     
+    /// Common initialization of all constructors
+    void Initialize();
+    
     ///////////////////////////////////////////////////////////////
     /// Pointer to used DAC Device (MCP47x6)
     MCP47x6base * deviceDAC;
@@ -166,19 +311,141 @@ class RL021_DigitalLoad {
     /// Pointer to used ADC Device (MCP3428)
     MCP3428 * deviceADC;
        
+    ///////////////////////////////////////////////////////////////
+    /// Integer transfer functions of actual calibration data and jumper settings
+    S_RL021_FixedPoint dacTransfer;
+    /// [channel][PGA gain index], current / Vload / Vext
+    S_RL021_FixedPoint adcTransfer[ADC_CH_NTC][RL021_PGA_GAINS];
+    
+    /// Precalculate transfer functions (calibration data or jumper settings changed)
+    void UpdateTransferFunctions();
+    static S_RL021_FixedPoint CalculateFixedPoint(float slope, float offset);
+    static int32_t ApplyFixedPoint(const S_RL021_FixedPoint * transfer, uint16_t x);
+    
     ///////////////////////////////////////////////////////////////
     /// Calculate raw DAC register value from desired current 
     uint16_t CalculateDAC(uint16_t current_mA);
     
-    /// Calculate Load Current from ADC raw data
-    uint16_t CalculateCurrent(uint16_t adcValue);
+    /// Calculate Load Current from ADC raw data (at PGA gain index)
+    uint16_t CalculateCurrent(uint16_t adcValue, uint8_t gain = 0);
     
-    /// Calculate Load/External Voltage from ADC raw data
-    uint16_t CalculateVoltage(uint16_t adcValue, E_ADC_CHANNEL channel);
+    /// Calculate Load/External Voltage from ADC raw data (at PGA gain index)
+    uint16_t CalculateVoltage(uint16_t adcValue, E_ADC_CHANNEL channel, uint8_t gain = 0);
 
     /// Calculate Temperature from ADC raw data
     int16_t CalculateTemperature(uint16_t adcValue);
     
+    /// Calculate calibrated value of selected channel from ADC raw data at PGA gain index (incl. correction table)
+    int32_t CalculateValue(uint16_t adcValue, E_ADC_CHANNEL channel, uint8_t gain = 0);
+    
+    /// Piecewise linear correction of each channel (NULL: none)
+    const S_RL021_CorrectionTable * correctionTable[ADC_CH_LAST];
+    static int16_t InterpolateCorrection(const S_RL021_CorrectionTable * table, uint16_t adcValue);
+    
+    ///////////////////////////////////////////////////////////////
+    /// Background acquisition (continuous conversion, channels in rotation)
+    bool acquisitionActive;
+    bool acquisitionStarted;
+    /// Measurements are stored by an external sequencer (RL021_LoadGroup synchronized capture)
+    bool acquisitionExternal;
+    uint8_t acquisitionMask;
+    E_ADC_CHANNEL acquisitionChannel;
+    
+    /// Latest measurement of each channel
+    S_RL021_Measurement measurement[ADC_CH_LAST];
+    
+    /// Store raw value (at PGA gain index) and calculated value in measurement cache
+    void StoreMeasurement(E_ADC_CHANNEL channel, uint16_t rawAdc, uint8_t gain);
+    /// Channels (bit mask) are not acquired any more
+    void InvalidateMeasurements(uint8_t channelMask);
+    
+    /// Filter of each channel (acquisition only, fresh reads are not filtered)
+    S_RL021_Filter filter[ADC_CH_LAST];
+    
+    /// Store conversion of the acquisition through the channel filter - returns true if filter output is new
+    bool StoreFilteredMeasurement(E_ADC_CHANNEL channel, uint16_t rawAdc, uint8_t gain, uint32_t timestamp_us);
+    static bool ApplyFilter(S_RL021_Filter * filter, uint16_t x);
+    /// Filter state to another gain (x 2^shift, shift < 0: divide)
+    static void RescaleFilter(S_RL021_Filter * filter, int8_t shift);
+    
+    /// Stream of a new conversion, regulation and load mode step of a new filter output
+    void ProcessMeasurement(E_ADC_CHANNEL channel, bool newValue);
+    
+    /// Next channel of acquisitionMask after actual channel
+    E_ADC_CHANNEL NextAcquisitionChannel(E_ADC_CHANNEL channel);
+    
+    /// ADC resolution of all conversions (12, 14, 16)
+    uint8_t adcResolution;
+    
+    /// Scale ADC result of actual resolution to 16-bit range
+    uint16_t ScaleRawAdc(int16_t rawAdcRead);
+    
+    ///////////////////////////////////////////////////////////////
+    /// PGA: gain index of the next conversion of each channel, auto-gain channels (bit: 1<<E_ADC_CHANNEL)
+    uint8_t adcGain[ADC_CH_LAST];
+    uint8_t autoGainMask;
+    /// Consecutive conversions below RL021_PGA_LOW_LIMIT
+    uint8_t gainUpCount[ADC_CH_LAST];
+    /// Gain index of the running conversion (acquisition, StartRawAdc())
+    uint8_t conversionGain;
+    
+    /// Auto-gain step after a conversion at gain index (filter state follows) - returns true if the gain changed
+    bool UpdateGain(E_ADC_CHANNEL channel, uint8_t gain, uint16_t rawAdc);
+    /// Result at full scale of the actual resolution
+    bool IsClipped(uint16_t rawAdc);
+    
+    ///////////////////////////////////////////////////////////////
+    /// Streaming: ring buffer of conversions (SetStreamBuffer(), NULL: streaming not possible)
+    bool streamActive;
+    S_RL021_StreamSample * streamBuffer;
+    uint8_t streamSize;
+    uint8_t streamHead;
+    uint8_t streamCount;
+    uint32_t streamOverflows;
+    
+    /// Store latest measurement of channel in stream buffer
+    void PushStreamSample(E_ADC_CHANNEL channel);
+    
+    ///////////////////////////////////////////////////////////////
+    /// Closed-loop current regulation (PI, executed on every new current measurement)
+    S_RL021_Regulation regulation;
+    bool regulationEnabled;
+    
+    /// Desired current of SetCurrent_mA()
+    uint16_t setpoint_mA;
+    /// Integral part [DAC LSB]
+    float regulationIntegral;
+    /// Consecutive steps within tolerance
+    uint8_t regulationInTolerance;
+    /// micros() of last setpoint change
+    uint32_t setpointTimestamp_us;
+    /// Settling time of last setpoint change [ms]
+    uint16_t settlingTime_ms;
+    bool regulationSettled;
+    bool settlingTargetMissed;
+    
+    /// One regulation step with the latest current measurement
+    void RegulationStep();
+    
+    /// Write DAC for current setpoint (incl. integral correction of regulation)
+    void WriteCurrentSetpoint(uint16_t current_mA);
+    
+    ///////////////////////////////////////////////////////////////
+    /// CV / CP / CR load modes (executed on every new load voltage measurement)
+    E_LOAD_MODE loadMode;
+    uint32_t modeSetpoint;
+    uint16_t modeCurrentLimit_mA;
+    float cvGain;
+    
+    /// Calculate current setpoint of actual mode from latest load voltage
+    void LoadModeStep();
+    
+    ///////////////////////////////////////////////////////////////
+    /// Shutdown (RL021_Supervisor): DAC writes are blocked until ReleaseShutdown()
+    bool outputInhibited;
+    /// Last DAC value written or queued, RL021_Supervisor: load on if above CalculateDAC(0)
+    uint16_t dacOutput;
+    
 ///public:
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /// Default constructor (use default calibrationData)
@@ -198,21 +465,135 @@ class RL021_DigitalLoad {
     void SetCalibration_ADC_slope(float calValue, E_ADC_CHANNEL channel, E_ADC_RANGE range);
     void SetCalibration_ADC_offset(float calValue, E_ADC_CHANNEL channel, E_ADC_RANGE range);
     
+    /// PGA gain index 1 ... 3 relative to x1: gain error [ppm], offset [raw ADC value at the gain]
+    void SetCalibration_PGA(uint8_t gain, int16_t gainError_ppm, int16_t offset);
+    
+    /// Piecewise linear correction of a channel for the actual jumper setting (NULL: none), see RL021_Calibration
+    void SetCorrectionTable(E_ADC_CHANNEL channel, const S_RL021_CorrectionTable * table);
+    
     ///////////////////////////////////////////////////////////////
     /// Set actual jumper state like set on PCB
     void SetJumperSetting(E_JUMPER jumper,bool closed);
     
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    /// Set DAC output for desired current
+    /// Set DAC output for desired current (setpoint of the regulation if enabled)
     void SetCurrent_mA(uint16_t current_mA);
+    
+    ///////////////////////////////////////////////////////////////
+    /// Closed-loop current regulation (requires background acquisition of ADC_CH_CURRENT)
+    void SetRegulationParameters(S_RL021_Regulation newParameters);
+    void EnableRegulation(bool enable);
+    
+    /// Current is within tolerance since last setpoint change
+    bool IsSettled();
+    
+    /// Settling target was missed since last setpoint change
+    bool IsSettlingTargetMissed();
+    
+    /// Settling time of the last setpoint change [ms] (0: not settled yet)
+    uint16_t GetSettlingTime_ms();
+    
+    ///////////////////////////////////////////////////////////////
+    /// Load mode and setpoint: CC [mA], CV [mV], CP [mW], CR [mOhm]
+    /// CV/CP/CR require background acquisition of ADC_CH_VLOAD (and ADC_CH_CURRENT for regulation)
+    void SetLoadMode(E_LOAD_MODE mode, uint32_t setpoint);
+    E_LOAD_MODE GetLoadMode();
+    
+    /// Max. current in CV/CP/CR mode [mA]
+    void SetModeCurrentLimit_mA(uint16_t limit_mA);
+    
+    /// CV mode: current change per voltage error [mA/mV], depends on source impedance
+    void SetCvGain(float gain_mA_per_mV);
     ///////////////////////////////////////////////////////////////
     /// DAC - set raw DAC data (interface method to DAC driver)
     void SetRawDac(uint16_t dacValue);
+    /// DAC - write raw DAC values back to back (blocking, fast write burst)
+    bool SetRawDacBurst(const uint16_t * dacValues, uint8_t count);
+    /// DAC - write raw DAC value at once (blocking), queued transactions of other devices stay queued, 
+    /// queued DAC writes are dropped (waveform samples)
+    bool SetRawDacImmediate(uint16_t dacValue);
+    
+    ///////////////////////////////////////////////////////////////
+    /// Output off at once (DAC 0 written directly on the bus, queued DAC writes dropped), load stays off
+    /// until ReleaseShutdown() - all DAC writes (setpoint, regulation, load modes, waveform) are blocked
+    bool Shutdown();
+    /// Allow DAC writes again, load restarts with 0mA in CC mode
+    void ReleaseShutdown();
+    bool IsShutdown();
     
     //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     /// ADC - get raw ADC data from selected channel (interface method to ADC driver)
     uint16_t GetRawAdc(E_ADC_CHANNEL channel);
     
+    /// ADC - start non-blocking conversion of selected channel (ADC driver needs an attached I2C_Engine)
+    bool StartRawAdc(E_ADC_CHANNEL channel);
+    
+    /// ADC - service non-blocking conversion, true if result of StartRawAdc() is available
+    bool RawAdcReady();
+    
+    /// ADC - get result of StartRawAdc()
+    uint16_t GetRawAdcResult();
+    
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Start background acquisition of selected channels (bit mask: 1<<E_ADC_CHANNEL), call Service() frequently
+    void StartAcquisition(uint8_t channelMask = (1<<ADC_CH_LAST)-1);
+    
+    /// Stop background acquisition, cached measurements are invalid (getters return the last values)
+    void StopAcquisition();
+    
+    /// Acquisition by an external sequencer (RL021_LoadGroup): Service() leaves the ADC alone,
+    /// results are stored with StoreExternalMeasurement() (regulation / load modes like Service())
+    void StartExternalAcquisition(uint8_t channelMask);
+    void StoreExternalMeasurement(E_ADC_CHANNEL channel, int16_t rawAdcRead, uint32_t timestamp_us);
+    
+    /// Service background acquisition - returns true if a new measurement is stored
+    bool Service();
+    
+    /// Get latest measurement of channel from the cache, never blocks (valid: false if not acquired / not converted yet)
+    const S_RL021_Measurement * GetMeasurement(E_ADC_CHANNEL channel);
+    
+    /// Get fresh measurement of channel (blocking read, also updates cache)
+    const S_RL021_Measurement * GetFreshMeasurement(E_ADC_CHANNEL channel);
+    
+    /// Filter of background acquisition per channel: measurement value is calculated from the filter output
+    /// (regulation / load modes use the filtered value, stream the raw value) - returns false if shift is out of range
+    bool SetFilter(E_ADC_CHANNEL channel, E_RL021_FILTER type, uint8_t shift);
+    E_RL021_FILTER GetFilterType(E_ADC_CHANNEL channel);
+    uint8_t GetFilterShift(E_ADC_CHANNEL channel);
+    
+    /// ADC resolution 12-bit (240 SPS), 14-bit (60 SPS), 16-bit (15 SPS), raw values are scaled to 16-bit range
+    void SetAdcResolution(uint8_t resolution);
+    uint8_t GetAdcResolution();
+    
+    /// PGA auto-gain of channels (bit: 1<<E_ADC_CHANNEL), other channels keep their fixed gain
+    void SetAutoGain(uint8_t channelMask);
+    uint8_t GetAutoGain();
+    /// PGA gain index (0: x1 ... 3: x8) of the next conversion of a channel
+    void SetAdcGain(E_ADC_CHANNEL channel, uint8_t gain);
+    uint8_t GetAdcGain(E_ADC_CHANNEL channel);
+    
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Streaming: every conversion of the background acquisition is stored in a ring buffer (call Service() frequently)
+    /// buffer is not copied (only boards which stream need one) - StartStreaming() returns false without buffer
+    void SetStreamBuffer(S_RL021_StreamSample * buffer, uint8_t size);
+    bool StartStreaming(uint8_t channelMask, uint8_t resolution);
+    void StopStreaming();
+    bool IsStreaming();
+    
+    /// Channels of background acquisition / stream (bit: 1<<E_ADC_CHANNEL)
+    uint8_t GetAcquisitionMask();
+    
+    /// Read stream buffer: number of samples, read sample (0: oldest), remove oldest samples
+    uint8_t StreamAvailable();
+    bool PeekStreamSample(uint8_t index, S_RL021_StreamSample * sample);
+    void DropStreamSamples(uint8_t count);
+    
+    /// Samples lost because stream buffer was full
+    uint32_t GetStreamOverflows();
+    
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// Getters return the cached measurement (last value if the channel is not acquired, see GetMeasurement())
+
     /// Get measured current from ADC
     uint16_t GetCurrent_mA();
     
@@ -0,0 +1,366 @@
+#include "RL021_LoadGroup.h"
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_LoadGroup::RL021_LoadGroup(I2C_Engine * newEngine):engine(newEngine)
+{
+    boardCount = 0;
+    startMask = 0;
+    startPending = 0;
+    firstBoard = 0;
+    measurementCount = 0;
+    syncActive = false;
+    syncMask = 0;
+    syncState = SYNC_ARM;
+    snapshotCount = 0;
+    syncErrors = 0;
+}
+
+/************************************************************************************************************************************************/
+/* Public - boards
+/************************************************************************************************************************************************/
+/** Add board to group, all bus traffic of the board is queued to the group's engine
+ *
+ *  @param RL021_DigitalLoad * load - load with its own DAC / ADC address
+ *	@return int8_t - board number, -1: group full
+ */
+int8_t RL021_LoadGroup::AddBoard(RL021_DigitalLoad * load)
+{
+    if(boardCount >= LOAD_BOARDS || load == NULL)
+    {
+        return -1;
+    }
+
+    load->deviceDAC->attachEngine(engine);
+    load->deviceADC->AttachEngine(engine);
+
+    boards[boardCount] = load;
+    return boardCount++;
+}
+
+uint8_t RL021_LoadGroup::GetBoardCount()
+{
+    return boardCount;
+}
+
+RL021_DigitalLoad * RL021_LoadGroup::GetBoard(uint8_t board)
+{
+    return (board < boardCount) ? boards[board] : NULL;
+}
+
+/************************************************************************************************************************************************/
+/* Public - acquisition
+/************************************************************************************************************************************************/
+/** Start background acquisition of all boards
+ *  Board n starts n * T_conv / N later: the result polls of the boards are spread over the conversion time
+ *
+ *  @param uint8_t channelMask - channels of every board (1<<E_ADC_CHANNEL)
+ *	@return /
+ */
+void RL021_LoadGroup::StartAcquisition(uint8_t channelMask)
+{
+    if(boardCount == 0)
+    {
+        return;
+    }
+
+    /// conversion time of the first board's resolution (see MCP3428::ConversionTime_us())
+    uint32_t conversion_us;
+    switch(boards[0]->GetAdcResolution())
+    {
+        case 12:
+            conversion_us = 4167;
+            break;
+        case 14:
+            conversion_us = 16667;
+            break;
+        default:
+            conversion_us = 66667;
+            break;
+    }
+
+    uint32_t now_us = micros();
+    syncActive = false;
+    startMask = channelMask;
+    startPending = 0;
+
+    for(uint8_t i=0;i<boardCount;i++)
+    {
+        startTime_us[i] = now_us + i * (conversion_us / boardCount);
+        startPending |= (1<<i);
+    }
+}
+
+void RL021_LoadGroup::StopAcquisition()
+{
+    startPending = 0;
+    syncActive = false;
+
+    for(uint8_t i=0;i<boardCount;i++)
+    {
+        boards[i]->StopAcquisition();
+    }
+}
+
+/** Start synchronized capture: all boards convert the same channel at the same time
+ *  Staggered acquisition is stopped, the boards' getters return the captured values.
+ *
+ *  @param uint8_t channelMask - channels of every board (1<<E_ADC_CHANNEL), captured one after the other
+ *	@return /
+ */
+void RL021_LoadGroup::StartSyncCapture(uint8_t channelMask)
+{
+    startPending = 0;
+    syncMask = channelMask & ((1<<ADC_CH_LAST)-1);
+    syncActive = (syncMask != 0 && boardCount > 0);
+
+    for(uint8_t i=0;i<boardCount;i++)
+    {
+        boards[i]->StartExternalAcquisition(syncMask);
+    }
+
+    syncChannel = (E_ADC_CHANNEL)(ADC_CH_LAST-1);
+    NextSyncChannel();
+    snapshotCount = 0;
+}
+
+bool RL021_LoadGroup::IsSyncCapture()
+{
+    return syncActive;
+}
+
+uint32_t RL021_LoadGroup::GetSnapshotCount()
+{
+    return snapshotCount;
+}
+
+uint32_t RL021_LoadGroup::GetSyncErrors()
+{
+    return syncErrors;
+}
+
+/** Service all boards: pending starts, acquisition, one queued transaction per board
+ *  The board serviced first rotates, no board is preferred if the bus is saturated.
+ *
+ *  @param /
+ *	@return uint8_t - number of new measurements (all boards)
+ */
+uint8_t RL021_LoadGroup::Service()
+{
+    uint8_t measurements = 0;
+
+    if(syncActive)
+    {
+        measurements += ServiceSync();
+    }
+
+    for(uint8_t n=0;n<boardCount;n++)
+    {
+        uint8_t i = (firstBoard + n) % boardCount;
+
+        if((startPending & (1<<i)) && (int32_t)(micros() - startTime_us[i]) >= 0)
+        {
+            startPending &= ~(1<<i);
+            boards[i]->StartAcquisition(startMask);
+        }
+
+        if(boards[i]->Service())
+        {
+            measurements++;
+        }
+
+        engine->Service();
+    }
+
+    firstBoard = (boardCount > 0) ? (firstBoard + 1) % boardCount : 0;
+    measurementCount += measurements;
+    return measurements;
+}
+
+uint32_t RL021_LoadGroup::GetMeasurementCount()
+{
+    return measurementCount;
+}
+
+void RL021_LoadGroup::ResetMeasurementCount()
+{
+    measurementCount = 0;
+}
+
+/************************************************************************************************************************************************/
+/* Private - synchronized capture
+/************************************************************************************************************************************************/
+/** One step of the synchronized capture
+ *  SYNC_ARM:     arm every board (retry if the ADC is busy / queue is full), queue general call when all are armed
+ *  SYNC_LATCH:   wait for I2C_TransactionDone() of the general call
+ *  SYNC_CONVERT: results of all latched boards with the common timestamp, then next channel
+ *
+ *  @param /
+ *	@return uint8_t - number of new measurements
+ */
+uint8_t RL021_LoadGroup::ServiceSync()
+{
+    uint8_t all = (1<<boardCount) - 1;
+    uint8_t measurements = 0;
+
+    if(syncState == SYNC_ARM)
+    {
+        uint8_t failed = 0;
+
+        for(uint8_t i=0;i<boardCount;i++)
+        {
+            MCP3428 * adc = boards[i]->deviceADC;
+
+            if(!(syncRequested & (1<<i)))
+            {
+                if(adc->ArmConversion(syncChannel+1, boards[i]->GetAdcResolution(), 1<<boards[i]->GetAdcGain(syncChannel)))
+                {
+                    syncRequested |= (1<<i);
+                }
+                continue;
+            }
+
+            MCP3428::conversionstate_t state = adc->Service();
+            if(state == MCP3428::conversionarmed)
+            {
+                syncArmed |= (1<<i);
+            }
+            else if(state == MCP3428::conversionerror)
+            {
+                failed |= (1<<i);
+            }
+            else if(state != MCP3428::conversionconfig)
+            {
+                /// configuration changed by a fresh read: arm again
+                syncRequested &= ~(1<<i);
+            }
+        }
+
+        if(syncRequested != all || (syncArmed | failed) != all)
+        {
+            return 0;
+        }
+
+        if(failed)
+        {
+            /// not acknowledged: board is left out of this channel
+            for(uint8_t i=0;i<boardCount;i++)
+            {
+                if(failed & (1<<i))
+                {
+                    boards[i]->deviceADC->GetConversionResult();
+                    syncErrors++;
+                }
+            }
+            if(syncArmed == 0)
+            {
+                NextSyncChannel();
+                return 0;
+            }
+        }
+
+        S_I2C_TRANSACTION transaction;
+        transaction.client = this;
+        transaction.tag = 0;
+        transaction.address = MCP3428_GENERAL_CALL_ADDRESS;
+        transaction.type = I2C_TRANSACTION_WRITE;
+        transaction.length = 1;
+        transaction.data[0] = MCP3428_GENERAL_CALL_CONVERSION;
+
+        if(engine->Submit(&transaction))
+        {
+            syncState = SYNC_LATCH;
+        }
+    }
+    else if(syncState == SYNC_CONVERT)
+    {
+        for(uint8_t i=0;i<boardCount;i++)
+        {
+            if(!(syncConverting & (1<<i)))
+            {
+                continue;
+            }
+
+            MCP3428 * adc = boards[i]->deviceADC;
+            MCP3428::conversionstate_t state = adc->Service();
+
+            if(state == MCP3428::conversionready)
+            {
+                boards[i]->StoreExternalMeasurement(syncChannel, adc->GetConversionResult(), syncLatch_us + adc->ConversionTime_us());
+                syncConverting &= ~(1<<i);
+                measurements++;
+            }
+            else if(state != MCP3428::conversionrunning && state != MCP3428::conversionpolling)
+            {
+                /// bus error or conversion taken by a fresh read
+                adc->GetConversionResult();
+                syncConverting &= ~(1<<i);
+                syncErrors++;
+            }
+        }
+
+        if(syncConverting == 0)
+        {
+            NextSyncChannel();
+        }
+    }
+
+    return measurements;
+}
+
+void RL021_LoadGroup::NextSyncChannel()
+{
+    for(uint8_t i=1;i<=ADC_CH_LAST;i++)
+    {
+        uint8_t next = (syncChannel + i) % ADC_CH_LAST;
+        if(syncMask & (1<<next))
+        {
+            if(next <= syncChannel && syncState == SYNC_CONVERT)
+            {
+                snapshotCount++;
+            }
+            syncChannel = (E_ADC_CHANNEL)next;
+            break;
+        }
+    }
+
+    syncState = SYNC_ARM;
+    syncRequested = 0;
+    syncArmed = 0;
+    syncConverting = 0;
+}
+
+/** General call executed: all armed ADCs convert from now on
+ *
+ *  @param const S_I2C_TRANSACTION * transaction -
+ *	@return /
+ */
+void RL021_LoadGroup::I2C_TransactionDone(const S_I2C_TRANSACTION * transaction)
+{
+    if(!syncActive || syncState != SYNC_LATCH)
+    {
+        return;
+    }
+
+    if(transaction->status != I2C_STATUS_OK)
+    {
+        /// ADCs stay armed, general call is queued again
+        syncErrors++;
+        syncState = SYNC_ARM;
+        return;
+    }
+
+    syncLatch_us = micros();
+    syncConverting = 0;
+
+    for(uint8_t i=0;i<boardCount;i++)
+    {
+        if((syncArmed & (1<<i)) && boards[i]->deviceADC->ConversionLatched())
+        {
+            syncConverting |= (1<<i);
+        }
+    }
+    syncState = SYNC_CONVERT;
+}
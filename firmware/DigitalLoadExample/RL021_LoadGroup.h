@@ -0,0 +1,132 @@
+/**
+* \file    RL021_LoadGroup.h
+* \brief    Several RL-021 boards on one I2C bus: shared I2C_Engine, interleaved background acquisition
+* \brief    Required drivers: RL021_DigitalLoad.h, I2C_Engine.h
+*
+* \brief    basic functions:
+*               up to LOAD_BOARDS (max. RL021_GROUP_MAX_BOARDS) boards (DAC 0x60 + n: MCP4726(0x60 + n), ADC 0x68 + n: MCP3428(n))
+*               board number = order of AddBoard(), board 0 is the first board
+*               DAC and ADC of all boards queue their transactions to one I2C_Engine
+*               acquisition start of the boards is staggered by T_conv / N, each ADC converts while the bus
+*               serves the other boards (no bus traffic during a conversion, see MCP3428::Service())
+*               Service(): every board gets one queued transaction per call, bus capacity per call grows with N
+*
+* \brief    synchronized capture (StartSyncCapture()): time-aligned snapshots of all boards
+*               all ADCs are armed with the same channel (one-shot configuration without start, skipped if the
+*               ADC already holds it), one general call conversion (MCP3428_GENERAL_CALL_CONVERSION) starts all
+*               of them, the results get the same timestamp (general call + T_conv)
+*               channels of the mask are captured one after the other (one general call per channel)
+*               bus per channel and snapshot: N + 1 transactions with a single channel (configuration unchanged),
+*               2N + 1 with several channels; staggered acquisition: 2N, blocking GetRawAdc(): N + polls
+*               (host benchmark, 4 boards, 12-bit current: 5 transactions, snapshot every 6.0ms @100kHz, 4.7ms @400kHz)
+*               a board which does not acknowledge is left out of the snapshot (GetSyncErrors())
+*
+* \brief    throughput: N boards x conversions/s of one board, as long as the bus is not saturated
+*               (12-bit: ~210 conversions/s per board, 2 transactions / ~0.58ms bus time per conversion @100kHz
+*               -> bus limit @100kHz: ~8 boards with 12-bit, all boards with 14/16-bit; host benchmark 12-bit:
+*               1 board 210/s, 2 boards 420/s, 4 boards 840/s, 8 boards 1540/s)
+*
+* \par     Editor
+*           17.10.2026 first implementation: several boards on one I2C bus, interleaved / synchronized acquisition
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_LoadGroup_H_
+#define _RL021_LoadGroup_H_
+
+#include "RL021_DigitalLoad.h"
+
+/// max. boards on one bus (DAC / ADC address range)
+#define RL021_GROUP_MAX_BOARDS      8
+
+/// Boards of the application, sizes the board arrays of RL021_LoadGroup and RL021_Supervisor
+/// (has to be the same in all files: set it as build flag, e.g. -DLOAD_BOARDS=4)
+#ifndef LOAD_BOARDS
+#define LOAD_BOARDS                 1
+#endif
+
+#if LOAD_BOARDS < 1 || LOAD_BOARDS > RL021_GROUP_MAX_BOARDS
+#error "LOAD_BOARDS: 1 ... RL021_GROUP_MAX_BOARDS"
+#endif
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_LoadGroup : public I2C_Client {
+
+ public:
+    RL021_LoadGroup(I2C_Engine * newEngine);
+
+    /// Add board, DAC and ADC are attached to the engine - returns board number, -1 if group is full
+    int8_t AddBoard(RL021_DigitalLoad * load);
+    uint8_t GetBoardCount();
+    /// Board (NULL if not existing)
+    RL021_DigitalLoad * GetBoard(uint8_t board);
+
+    /// Start background acquisition of all boards, staggered by conversion time / number of boards
+    void StartAcquisition(uint8_t channelMask = (1<<ADC_CH_LAST)-1);
+    void StopAcquisition();
+
+    /// Synchronized capture of all boards (general call conversion), ends staggered acquisition
+    void StartSyncCapture(uint8_t channelMask = (1<<ADC_CH_CURRENT) | (1<<ADC_CH_VLOAD));
+    bool IsSyncCapture();
+    /// Complete snapshots (all channels of the mask) and boards left out of a channel since start
+    uint32_t GetSnapshotCount();
+    uint32_t GetSyncErrors();
+
+    /// Service acquisition of all boards and the bus - returns number of new measurements
+    uint8_t Service();
+
+    /// General call done (I2C_Engine)
+    void I2C_TransactionDone(const S_I2C_TRANSACTION * transaction);
+
+    /// Measurements of all boards since start / ResetMeasurementCount()
+    uint32_t GetMeasurementCount();
+    void ResetMeasurementCount();
+
+ private:
+    I2C_Engine * engine;
+
+    RL021_DigitalLoad * boards[LOAD_BOARDS];
+    uint8_t boardCount;
+
+    /// Staggered start: channels and micros() of the acquisition start of each board
+    uint8_t startMask;
+    uint8_t startPending;
+    uint32_t startTime_us[LOAD_BOARDS];
+
+    /// Synchronized capture: arm all ADCs -> general call -> collect results
+    typedef enum
+    {
+        SYNC_ARM,       /// arm configuration queued / written
+        SYNC_LATCH,     /// general call queued
+        SYNC_CONVERT    /// waiting for the results
+
+    } E_SYNC_STATE;
+
+    /// Arm, latch or collect step of the synchronized capture - returns number of new measurements
+    uint8_t ServiceSync();
+    /// Next channel of the capture mask, counts complete snapshots
+    void NextSyncChannel();
+
+    bool syncActive;
+    uint8_t syncMask;
+    E_ADC_CHANNEL syncChannel;
+    E_SYNC_STATE syncState;
+    /// Boards (bit: 1<<board): arm requested, armed, conversion running
+    uint8_t syncRequested;
+    uint8_t syncArmed;
+    uint8_t syncConverting;
+    uint32_t syncLatch_us;
+    uint32_t snapshotCount;
+    uint32_t syncErrors;
+
+    /// First board of the next Service() (round robin)
+    uint8_t firstBoard;
+    uint32_t measurementCount;
+};
+
+#endif /* _RL021_LoadGroup_H_ */
@@ -0,0 +1,295 @@
+#include "RL021_Protocol.h"
+
+/// payload offset of sample count in FRAME_BLOCK
+#define BLOCK_OFFSET_COUNT  1
+
+/// max. encoded size of one block sample: varint time (5) + zigzag varint per channel (3)
+#define BLOCK_SAMPLE_MAX_SIZE(channels)   (5 + 3*(channels))
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_Protocol::RL021_Protocol(Print * newPort):port(newPort)
+{
+    sequence = 0;
+    payloadLength = 0;
+    blockCount = 0;
+}
+
+/************************************************************************************************************************************************/
+/* Public - frames
+/************************************************************************************************************************************************/
+/** Send latest measurement of all channels in one frame
+ *
+ *  @param RL021_DigitalLoad * load - measurements are taken from (cached) load measurements
+ *  @param bool raw - (true): raw ADC values, (false): calibrated values
+ *	@return /
+ */
+void RL021_Protocol::SendSnapshot(RL021_DigitalLoad * load, bool raw)
+{
+    Begin(raw ? FRAME_RAW_SNAPSHOT : FRAME_SNAPSHOT, micros());
+
+    for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+    {
+        const S_RL021_Measurement * measurement = load->GetMeasurement((E_ADC_CHANNEL)ch);
+        Put16(raw ? measurement->raw : (uint16_t)measurement->value);
+    }
+
+    Finish();
+}
+
+/** Send latest measurement of all channels of one board (several boards on one bus)
+ *
+ *  @param uint8_t board - board number (0 ... 127)
+ *  @param RL021_DigitalLoad * load -
+ *  @param bool raw - (true): raw ADC values, (false): calibrated values
+ *	@return /
+ */
+void RL021_Protocol::SendBoardSnapshot(uint8_t board, RL021_DigitalLoad * load, bool raw)
+{
+    Begin(FRAME_BOARD_SNAPSHOT, micros());
+
+    frame[RL021_FRAME_HEADER_SIZE + payloadLength++] = (board & ~RL021_BOARD_RAW) | (raw ? RL021_BOARD_RAW : 0);
+
+    for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+    {
+        const S_RL021_Measurement * measurement = load->GetMeasurement((E_ADC_CHANNEL)ch);
+        Put16(raw ? measurement->raw : (uint16_t)measurement->value);
+    }
+
+    Finish();
+}
+
+/** Start delta encoded block
+ *
+ *  @param uint8_t channelMask - channels of each sample (1<<E_ADC_CHANNEL)
+ *  @param bool raw - (true): raw ADC values, (false): calibrated values
+ *  @param uint32_t timestamp_us - frame timestamp (time of first sample is encoded relative to it)
+ *	@return /
+ */
+void RL021_Protocol::BeginBlock(uint8_t channelMask, bool raw, uint32_t timestamp_us)
+{
+    Begin(FRAME_BLOCK, timestamp_us);
+
+    blockMask = channelMask & ((1<<ADC_CH_LAST)-1);
+    blockCount = 0;
+    blockChannels = 0;
+    blockTimestamp_us = timestamp_us;
+
+    for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+    {
+        if(blockMask & (1<<ch))
+        {
+            blockChannels++;
+        }
+    }
+
+    frame[RL021_FRAME_HEADER_SIZE + payloadLength++] = blockMask | (raw ? RL021_BLOCK_RAW : 0);
+    frame[RL021_FRAME_HEADER_SIZE + payloadLength++] = 0; /// sample count, set by EndBlock()
+}
+
+/** Add sample to block (first sample absolute, following samples as delta to previous sample)
+ *
+ *  @param const int16_t * values - one value per channel in mask (ascending channel order)
+ *  @param uint32_t timestamp_us - time of the sample
+ *	@return bool - (false): block full, sample not added
+ */
+bool RL021_Protocol::AddSample(const int16_t * values, uint32_t timestamp_us)
+{
+    if(blockCount == 255 || payloadLength + BLOCK_SAMPLE_MAX_SIZE(blockChannels) > RL021_FRAME_MAX_PAYLOAD)
+    {
+        return false;
+    }
+
+    PutVarint(timestamp_us - blockTimestamp_us);
+    blockTimestamp_us = timestamp_us;
+
+    for(uint8_t i=0;i<blockChannels;i++)
+    {
+        if(blockCount == 0)
+        {
+            Put16(values[i]);
+        }
+        else
+        {
+            /// zigzag: small positive and negative deltas are small varints
+            int32_t delta = (int32_t)values[i] - blockLast[i];
+            PutVarint(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+        }
+        blockLast[i] = values[i];
+    }
+
+    blockCount++;
+    return true;
+}
+
+/// Send block (nothing is sent for an empty block)
+void RL021_Protocol::EndBlock()
+{
+    if(blockCount == 0)
+    {
+        return;
+    }
+
+    frame[RL021_FRAME_HEADER_SIZE + BLOCK_OFFSET_COUNT] = blockCount;
+    Finish();
+    blockCount = 0;
+}
+
+/** Send stream buffer content of load as one FRAME_BLOCK
+ *  One block sample contains one conversion of each streamed channel (one rotation),
+ *  time of the block sample is the conversion time of the first channel of the rotation.
+ *  Incomplete rotations (samples lost by stream buffer overflow) are dropped.
+ *
+ *  @param RL021_DigitalLoad * load - load in streaming mode
+ *  @param bool raw - (true): raw ADC values, (false): calibrated values
+ *	@return uint8_t - number of stream samples sent (and removed from stream buffer)
+ */
+uint8_t RL021_Protocol::SendStream(RL021_DigitalLoad * load, bool raw)
+{
+    uint8_t mask = load->GetAcquisitionMask();
+    uint8_t channels = 0;
+    uint8_t first = ADC_CH_LAST;
+    uint8_t sent = 0;
+    bool begun = false;
+    S_RL021_StreamSample sample;
+    int16_t values[ADC_CH_LAST];
+
+    for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+    {
+        if(mask & (1<<ch))
+        {
+            if(first == ADC_CH_LAST)
+            {
+                first = ch;
+            }
+            channels++;
+        }
+    }
+
+    while(channels > 0 && load->StreamAvailable() >= channels)
+    {
+        /// Rotation has to start with first channel of mask
+        load->PeekStreamSample(0, &sample);
+        if(sample.channel != first)
+        {
+            load->DropStreamSamples(1);
+            continue;
+        }
+        uint32_t timestamp_us = sample.timestamp_us;
+
+        uint8_t i = 0;
+        for(uint8_t ch=0;ch<ADC_CH_LAST;ch++)
+        {
+            if(!(mask & (1<<ch)))
+            {
+                continue;
+            }
+            load->PeekStreamSample(i, &sample);
+            if(sample.channel != ch)
+            {
+                break;
+            }
+            values[i++] = raw ? sample.raw : load->CalculateValue(sample.raw, (E_ADC_CHANNEL)ch, sample.gain);
+        }
+
+        if(i < channels)
+        {
+            /// Incomplete rotation
+            load->DropStreamSamples(i);
+            continue;
+        }
+
+        if(!begun)
+        {
+            BeginBlock(mask, raw, timestamp_us);
+            begun = true;
+        }
+
+        if(!AddSample(values, timestamp_us))
+        {
+            break;
+        }
+        load->DropStreamSamples(channels);
+        sent += channels;
+    }
+
+    if(begun)
+    {
+        EndBlock();
+    }
+
+    return sent;
+}
+
+/** CRC-16/CCITT-FALSE (poly 0x1021, no reflection)
+ *
+ *  @param const uint8_t * data -
+ *  @param uint16_t length -
+ *  @param uint16_t crc - start value (0xFFFF or CRC of previous data)
+ *	@return uint16_t - CRC
+ */
+uint16_t RL021_Protocol::CRC16(const uint8_t * data, uint16_t length, uint16_t crc)
+{
+    for(uint16_t i=0;i<length;i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(uint8_t bit=0;bit<8;bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/************************************************************************************************************************************************/
+/* Private - frame buffer
+/************************************************************************************************************************************************/
+void RL021_Protocol::Begin(E_RL021_FRAME_TYPE type, uint32_t timestamp_us)
+{
+    frame[0] = RL021_FRAME_SYNC1;
+    frame[1] = RL021_FRAME_SYNC2;
+    frame[2] = RL021_FRAME_VERSION;
+    frame[3] = type;
+    frame[4] = 0; /// payload length, set by Finish()
+    frame[5] = sequence & 0xFF;
+    frame[6] = sequence >> 8;
+    frame[7] = timestamp_us & 0xFF;
+    frame[8] = (timestamp_us >> 8) & 0xFF;
+    frame[9] = (timestamp_us >> 16) & 0xFF;
+    frame[10] = timestamp_us >> 24;
+
+    payloadLength = 0;
+}
+
+void RL021_Protocol::Put16(uint16_t value)
+{
+    frame[RL021_FRAME_HEADER_SIZE + payloadLength++] = value & 0xFF;
+    frame[RL021_FRAME_HEADER_SIZE + payloadLength++] = value >> 8;
+}
+
+/// 7 bit per byte, MSB set: more bytes follow
+void RL021_Protocol::PutVarint(uint32_t value)
+{
+    while(value >= 0x80)
+    {
+        frame[RL021_FRAME_HEADER_SIZE + payloadLength++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    frame[RL021_FRAME_HEADER_SIZE + payloadLength++] = value;
+}
+
+void RL021_Protocol::Finish()
+{
+    frame[4] = payloadLength;
+
+    uint8_t length = RL021_FRAME_HEADER_SIZE + payloadLength;
+    uint16_t crc = CRC16(&frame[2], length - 2);
+    frame[length++] = crc & 0xFF;
+    frame[length++] = crc >> 8;
+
+    /// one write call per frame
+    port->write(frame, length);
+    sequence++;
+}
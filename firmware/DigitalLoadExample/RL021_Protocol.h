@@ -0,0 +1,120 @@
+/**
+* \file    RL021_Protocol.h
+* \brief    Binary framed telemetry protocol (alternative to the ASCII protocol 's'x'...'e')
+* \brief    Required drivers: RL021_DigitalLoad.h
+*
+* \brief    frame format (version 1, all values little endian):
+*               offset  size  content
+*               0       2     sync word 0xA5 0x5A
+*               2       1     protocol version
+*               3       1     frame type (E_RL021_FRAME_TYPE)
+*               4       1     payload length N
+*               5       2     sequence number (incremented per frame, lost frames are detectable)
+*               7       4     timestamp [us] (micros(), wraps after 71.6 min)
+*               11      N     payload
+*               11+N    2     CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over offset 2 ... 10+N
+*
+* \brief    payload:
+*               FRAME_SNAPSHOT:     4x int16 calibrated values (current [mA], Vload [mV], Vext [mV], NTC [°C x10])
+*               FRAME_RAW_SNAPSHOT: 4x uint16 raw ADC values (same channel order)
+*               FRAME_BOARD_SNAPSHOT: board number (bit 7: raw values), 4x int16 / uint16 like FRAME_SNAPSHOT / FRAME_RAW_SNAPSHOT
+*                                   (several boards on one bus, see RL021_LoadGroup.h)
+*               FRAME_BLOCK:        channel mask (1<<E_ADC_CHANNEL, bit 7: raw values), sample count,
+*                                   1st sample:    varint time [us] since frame timestamp, int16 value per channel in mask
+*                                   next samples:  varint time [us] since previous sample, zigzag varint delta per channel
+*                                   (stream: one sample per rotation of the streamed channels, time of the first channel's conversion)
+*               raw values are ADC codes at the PGA gain of the conversion (x1 unless auto-gain is enabled, see
+*               RL021_DigitalLoad::SetAutoGain()), calibrated values are independent of the gain
+*
+* \par     Editor
+*           17.10.2026 first implementation: binary telemetry frames with sequence number, timestamp and CRC
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_Protocol_H_
+#define _RL021_Protocol_H_
+
+#include "RL021_DigitalLoad.h"
+
+#define RL021_FRAME_SYNC1           0xA5
+#define RL021_FRAME_SYNC2           0x5A
+#define RL021_FRAME_VERSION         1
+
+#define RL021_FRAME_HEADER_SIZE     11
+#define RL021_FRAME_CRC_SIZE        2
+/// max. payload of a frame (limits RAM of frame buffer, min. 36: block of two samples of all channels)
+#ifndef RL021_FRAME_MAX_PAYLOAD
+#define RL021_FRAME_MAX_PAYLOAD     48
+#endif
+
+/// FRAME_BLOCK channel mask flag: samples are raw ADC values
+#define RL021_BLOCK_RAW             0x80
+/// FRAME_BOARD_SNAPSHOT board number flag: raw ADC values
+#define RL021_BOARD_RAW             0x80
+
+/************************************************************************/
+/* Enums                                                                */
+/************************************************************************/
+typedef enum
+{
+    FRAME_SNAPSHOT = 1,
+    FRAME_RAW_SNAPSHOT = 2,
+    FRAME_BLOCK = 3,
+    FRAME_BOARD_SNAPSHOT = 4
+
+} E_RL021_FRAME_TYPE;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_Protocol {
+
+ public:
+    /// Frames are written to port (e.g. &Serial)
+    RL021_Protocol(Print * newPort);
+
+    /// Send latest measurement of all channels (calibrated or raw values)
+    void SendSnapshot(RL021_DigitalLoad * load, bool raw);
+    /// Snapshot tagged with board number
+    void SendBoardSnapshot(uint8_t board, RL021_DigitalLoad * load, bool raw);
+
+    /// Delta encoded block of samples: BeginBlock(), AddSample() until false, EndBlock()
+    void BeginBlock(uint8_t channelMask, bool raw, uint32_t timestamp_us);
+    /// Add sample (one value per channel in mask) - returns false if block is full (sample not added)
+    bool AddSample(const int16_t * values, uint32_t timestamp_us);
+    /// Send block (nothing is sent for an empty block)
+    void EndBlock();
+
+    /// Send content of stream buffer of load as one block - returns number of stream samples sent
+    uint8_t SendStream(RL021_DigitalLoad * load, bool raw);
+
+    /// CRC-16/CCITT-FALSE
+    static uint16_t CRC16(const uint8_t * data, uint16_t length, uint16_t crc = 0xFFFF);
+
+ private:
+    /// Start new frame in frame buffer
+    void Begin(E_RL021_FRAME_TYPE type, uint32_t timestamp_us);
+    /// Append to payload
+    void Put16(uint16_t value);
+    void PutVarint(uint32_t value);
+    /// Set length and CRC, write frame to port
+    void Finish();
+
+    Print * port;
+    uint16_t sequence;
+
+    uint8_t frame[RL021_FRAME_HEADER_SIZE + RL021_FRAME_MAX_PAYLOAD + RL021_FRAME_CRC_SIZE];
+    uint8_t payloadLength;
+
+    /// Block encoding state
+    uint8_t blockMask;
+    uint8_t blockCount;
+    uint8_t blockChannels;
+    uint32_t blockTimestamp_us;
+    int16_t blockLast[ADC_CH_LAST];
+};
+
+#endif /* _RL021_Protocol_H_ */
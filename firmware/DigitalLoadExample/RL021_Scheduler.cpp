@@ -0,0 +1,122 @@
+#include "RL021_Scheduler.h"
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_Scheduler::RL021_Scheduler()
+{
+    taskCount = 0;
+}
+
+/************************************************************************************************************************************************/
+/* Public - tasks
+/************************************************************************************************************************************************/
+/** Add periodic task
+ *
+ *  @param const char * name - for statistics output
+ *  @param RL021_TaskFunction function -
+ *  @param uint32_t period_us - release period (> 0)
+ *  @param uint8_t priority - 0: highest, due tasks of equal priority run in order of AddTask()
+ *	@return int8_t - task index, -1: no free task
+ */
+int8_t RL021_Scheduler::AddTask(const char * name, RL021_TaskFunction function, uint32_t period_us, uint8_t priority)
+{
+    if(taskCount >= RL021_SCHEDULER_MAX_TASKS || function == NULL || period_us == 0)
+    {
+        return -1;
+    }
+
+    S_RL021_Task * task = &tasks[taskCount];
+    memset(task, 0, sizeof(S_RL021_Task));
+    task->name = name;
+    task->function = function;
+    task->period_us = period_us;
+    task->priority = priority;
+    task->release_us = micros() + period_us;
+
+    return taskCount++;
+}
+
+void RL021_Scheduler::SetPeriod(uint8_t task, uint32_t period_us)
+{
+    if(task < taskCount && period_us > 0)
+    {
+        tasks[task].release_us += period_us - tasks[task].period_us;
+        tasks[task].period_us = period_us;
+    }
+}
+
+/// First release of all tasks one period after now
+void RL021_Scheduler::Start()
+{
+    uint32_t now_us = micros();
+
+    for(uint8_t i=0;i<taskCount;i++)
+    {
+        tasks[i].release_us = now_us + tasks[i].period_us;
+    }
+}
+
+/** Execute the due task with the highest priority (cooperative: the task runs to completion)
+ *
+ *  @param /
+ *	@return bool - (false): idle, no task due
+ */
+bool RL021_Scheduler::Run()
+{
+    uint32_t now_us = micros();
+    S_RL021_Task * due = NULL;
+
+    for(uint8_t i=0;i<taskCount;i++)
+    {
+        if((int32_t)(now_us - tasks[i].release_us) >= 0 && (due == NULL || tasks[i].priority < due->priority))
+        {
+            due = &tasks[i];
+        }
+    }
+
+    if(due == NULL)
+    {
+        return false;
+    }
+
+    /// Start delay, missed releases are dropped
+    uint32_t delay_us = now_us - due->release_us;
+    uint32_t missed = delay_us / due->period_us;
+
+    if(missed)
+    {
+        due->overruns++;
+    }
+    due->release_us += (missed + 1) * due->period_us;
+    due->delayMax_us = max(due->delayMax_us, delay_us);
+
+    due->function();
+
+    uint32_t duration_us = micros() - now_us;
+    due->durationMax_us = max(due->durationMax_us, duration_us);
+    due->runs++;
+    return true;
+}
+
+uint8_t RL021_Scheduler::GetTaskCount()
+{
+    return taskCount;
+}
+
+const S_RL021_Task * RL021_Scheduler::GetTask(uint8_t task)
+{
+    return (task < taskCount) ? &tasks[task] : NULL;
+}
+
+void RL021_Scheduler::ResetStatistics()
+{
+    for(uint8_t i=0;i<taskCount;i++)
+    {
+        tasks[i].runs = 0;
+        tasks[i].overruns = 0;
+        tasks[i].delayMax_us = 0;
+        tasks[i].durationMax_us = 0;
+    }
+}
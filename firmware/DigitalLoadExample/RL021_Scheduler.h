@@ -0,0 +1,90 @@
+/**
+* \file    RL021_Scheduler.h
+* \brief    Cooperative fixed-period task scheduler (replaces delay() based main loop)
+* \brief    Required drivers: /
+*
+* \brief    basic functions:
+*               tasks with period [us] and priority (0: highest), max. RL021_SCHEDULER_MAX_TASKS
+*               Run() is called in loop(): executes the due task with the highest priority (one task per call),
+*               so a long task delays the others by max. its duration
+*               release times are fixed (next = previous + period), they do not drift with the task duration
+*               statistics per task: runs, overruns, max. start delay, max. duration
+*
+* \brief    overrun: a task starts one period or more after its release time, i.e. at least one release was missed.
+*               Missed releases are dropped (not executed later), the task keeps its phase.
+*
+* \par     Editor
+*           17.10.2026 first implementation: fixed-period task scheduler replacing the delay() main loop
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_Scheduler_H_
+#define _RL021_Scheduler_H_
+
+#include <Arduino.h>
+
+/// max. number of tasks (~29 bytes RAM each, DigitalLoadExample: 5)
+#ifndef RL021_SCHEDULER_MAX_TASKS
+#define RL021_SCHEDULER_MAX_TASKS   5
+#endif
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+typedef void (*RL021_TaskFunction)();
+
+typedef struct
+{
+    const char * name;
+    RL021_TaskFunction function;
+    uint32_t period_us;
+    /// 0: highest
+    uint8_t priority;
+    /// micros() of next release
+    uint32_t release_us;
+
+    /// statistics since start / ResetStatistics()
+    uint32_t runs;
+    uint32_t overruns;
+    /// max. time release -> start [us]
+    uint32_t delayMax_us;
+    /// max. execution time [us]
+    uint32_t durationMax_us;
+
+} S_RL021_Task;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_Scheduler {
+
+ public:
+    RL021_Scheduler();
+
+    /// Add task (first release: one period after Start()) - returns task index, -1 if no task is free
+    int8_t AddTask(const char * name, RL021_TaskFunction function, uint32_t period_us, uint8_t priority);
+
+    /// Change period (next release: one period after actual release)
+    void SetPeriod(uint8_t task, uint32_t period_us);
+
+    /// Set first release of all tasks
+    void Start();
+
+    /// Execute the due task with the highest priority - returns false if no task was due (idle)
+    bool Run();
+
+    /// Task data and statistics
+    uint8_t GetTaskCount();
+    const S_RL021_Task * GetTask(uint8_t task);
+    void ResetStatistics();
+
+ private:
+    S_RL021_Task tasks[RL021_SCHEDULER_MAX_TASKS];
+    uint8_t taskCount;
+};
+
+#endif /* _RL021_Scheduler_H_ */
@@ -0,0 +1,438 @@
+#include "RL021_Scpi.h"
+
+#include <ctype.h>
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_Scpi::RL021_Scpi(Print * newPort, const S_RL021_ScpiCommand * newCommands, uint8_t newCommandCount):port(newPort), commands(newCommands), commandCount(newCommandCount)
+{
+    lineLength = 0;
+    overrun = false;
+    parameter = NULL;
+    lineResult = false;
+    commandResult = false;
+    errorCount = 0;
+}
+
+/************************************************************************************************************************************************/
+/* Public - input
+/************************************************************************************************************************************************/
+/** Collect one character, the line is executed with '\n'
+ *
+ *  @param char c - received character
+ *	@return bool - (false): no SCPI line (character for the single character commands)
+ */
+bool RL021_Scpi::Feed(char c)
+{
+    /// Start of a line: header (upper case mnemonic, common command, root)
+    if(lineLength == 0 && !overrun && !((c >= 'A' && c <= 'Z') || c == '*' || c == ':'))
+    {
+        return false;
+    }
+
+    if(c == '\n')
+    {
+        if(!overrun)
+        {
+            line[lineLength] = '\0';
+            ExecuteLine();
+        }
+        overrun = false;
+        lineLength = 0;
+    }
+    else if(c != '\r' && !overrun)
+    {
+        if(lineLength < RL021_SCPI_LINE_LENGTH)
+        {
+            line[lineLength++] = c;
+        }
+        else
+        {
+            /// the line is not executed
+            PushError(SCPI_INPUT_BUFFER_OVERRUN);
+            overrun = true;
+        }
+    }
+    return true;
+}
+
+/************************************************************************************************************************************************/
+/* Public - parameters
+/************************************************************************************************************************************************/
+/** Next parameter as decimal number (e.g. 1.5, -2, 1E-3)
+ *
+ *  @param float * value -
+ *	@return int16_t - SCPI_NO_ERROR, SCPI_MISSING_PARAMETER, SCPI_DATA_TYPE_ERROR
+ */
+int16_t RL021_Scpi::GetNumber(float * value)
+{
+    while(*parameter == ' ' || *parameter == '\t')
+    {
+        parameter++;
+    }
+    if(*parameter == '\0')
+    {
+        return SCPI_MISSING_PARAMETER;
+    }
+
+    char * end;
+    *value = strtod(parameter, &end);
+    if(end == parameter)
+    {
+        return SCPI_DATA_TYPE_ERROR;
+    }
+    parameter = end;
+
+    while(*parameter == ' ' || *parameter == '\t')
+    {
+        parameter++;
+    }
+    if(*parameter == ',')
+    {
+        parameter++;
+    }
+    else if(*parameter != '\0')
+    {
+        /// e.g. unit suffix
+        return SCPI_DATA_TYPE_ERROR;
+    }
+    return SCPI_NO_ERROR;
+}
+
+/// Next parameter as integer, decimal places are not allowed
+int16_t RL021_Scpi::GetInteger(int32_t * value)
+{
+    float number;
+    int16_t error = GetNumber(&number);
+
+    if(error == SCPI_NO_ERROR)
+    {
+        if(number != floor(number))
+        {
+            return SCPI_DATA_TYPE_ERROR;
+        }
+        if(number < -2147483648.0f || number >= 2147483648.0f)
+        {
+            return SCPI_DATA_OUT_OF_RANGE;
+        }
+        *value = (int32_t)number;
+    }
+    return error;
+}
+
+/// Next parameter as ON / OFF or number (0: false)
+int16_t RL021_Scpi::GetBoolean(bool * value)
+{
+    while(*parameter == ' ' || *parameter == '\t')
+    {
+        parameter++;
+    }
+
+    uint8_t length = 0;
+    if(strncasecmp(parameter, "ON", 2) == 0)
+    {
+        length = 2;
+    }
+    else if(strncasecmp(parameter, "OFF", 3) == 0)
+    {
+        length = 3;
+    }
+
+    if(length > 0 && (parameter[length] == '\0' || parameter[length] == ',' || parameter[length] == ' ' || parameter[length] == '\t'))
+    {
+        *value = (length == 2);
+        parameter += length;
+        while(*parameter == ' ' || *parameter == '\t')
+        {
+            parameter++;
+        }
+        if(*parameter == ',')
+        {
+            parameter++;
+        }
+        return SCPI_NO_ERROR;
+    }
+
+    int32_t number;
+    int16_t error = GetInteger(&number);
+    if(error == SCPI_NO_ERROR)
+    {
+        *value = (number != 0);
+    }
+    return error;
+}
+
+/************************************************************************************************************************************************/
+/* Public - response
+/************************************************************************************************************************************************/
+void RL021_Scpi::ResultNumber(float value, uint8_t decimals)
+{
+    BeginResult();
+    port->print(value, decimals);
+}
+
+void RL021_Scpi::ResultInteger(int32_t value)
+{
+    BeginResult();
+    port->print((long)value);
+}
+
+void RL021_Scpi::ResultText(const char * text)
+{
+    BeginResult();
+    port->print(text);
+}
+
+void RL021_Scpi::ResultText(const __FlashStringHelper * text)
+{
+    BeginResult();
+    port->print(text);
+}
+
+void RL021_Scpi::ResultString(const __FlashStringHelper * text)
+{
+    BeginResult();
+    port->print('"');
+    port->print(text);
+    port->print('"');
+}
+
+/************************************************************************************************************************************************/
+/* Public - error queue
+/************************************************************************************************************************************************/
+/// Store error, a full queue replaces its last error by SCPI_QUEUE_OVERFLOW
+void RL021_Scpi::PushError(int16_t error)
+{
+    if(errorCount < RL021_SCPI_ERROR_QUEUE)
+    {
+        errors[errorCount++] = error;
+    }
+    else
+    {
+        errors[RL021_SCPI_ERROR_QUEUE - 1] = SCPI_QUEUE_OVERFLOW;
+    }
+}
+
+/// Oldest error, SCPI_NO_ERROR if the queue is empty
+int16_t RL021_Scpi::PopError()
+{
+    if(errorCount == 0)
+    {
+        return SCPI_NO_ERROR;
+    }
+
+    int16_t error = errors[0];
+    errorCount--;
+    for(uint8_t i=0;i<errorCount;i++)
+    {
+        errors[i] = errors[i+1];
+    }
+    return error;
+}
+
+uint8_t RL021_Scpi::GetErrorCount()
+{
+    return errorCount;
+}
+
+void RL021_Scpi::ClearErrors()
+{
+    errorCount = 0;
+}
+
+const __FlashStringHelper * RL021_Scpi::GetErrorText(int16_t error)
+{
+    switch(error)
+    {
+        case SCPI_NO_ERROR:                 return F("No error");
+        case SCPI_COMMAND_ERROR:            return F("Command error");
+        case SCPI_SYNTAX_ERROR:             return F("Syntax error");
+        case SCPI_DATA_TYPE_ERROR:          return F("Data type error");
+        case SCPI_PARAMETER_NOT_ALLOWED:    return F("Parameter not allowed");
+        case SCPI_MISSING_PARAMETER:        return F("Missing parameter");
+        case SCPI_UNDEFINED_HEADER:         return F("Undefined header");
+        case SCPI_EXECUTION_ERROR:          return F("Execution error");
+        case SCPI_SETTINGS_CONFLICT:        return F("Settings conflict");
+        case SCPI_DATA_OUT_OF_RANGE:        return F("Data out of range");
+        case SCPI_QUEUE_OVERFLOW:           return F("Queue overflow");
+        case SCPI_INPUT_BUFFER_OVERRUN:     return F("Input buffer overrun");
+        default:                            return F("Unknown error");
+    }
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+/** Execute the commands of the line in order, the responses of all queries are sent as one line
+ *
+ *  @param /
+ *	@return /
+ */
+void RL021_Scpi::ExecuteLine()
+{
+    char * command = line;
+    lineResult = false;
+
+    while(command != NULL)
+    {
+        char * separator = strchr(command, ';');
+        if(separator != NULL)
+        {
+            *separator = '\0';
+        }
+
+        int16_t error = ExecuteCommand(command);
+        if(error != SCPI_NO_ERROR)
+        {
+            /// following commands of the line are not executed
+            PushError(error);
+            break;
+        }
+        command = (separator != NULL) ? separator + 1 : NULL;
+    }
+
+    if(lineResult)
+    {
+        port->println();
+    }
+}
+
+/** Find the header in the command table and call its handler
+ *
+ *  @param char * command - header [parameters]
+ *	@return int16_t - SCPI error number
+ */
+int16_t RL021_Scpi::ExecuteCommand(char * command)
+{
+    while(*command == ' ' || *command == '\t')
+    {
+        command++;
+    }
+    /// empty command, e.g. after the last ';'
+    if(*command == '\0')
+    {
+        return SCPI_NO_ERROR;
+    }
+    if(*command == ':')
+    {
+        command++;
+    }
+
+    /// Header ends at the first white space, parameters follow
+    char * header = command;
+    while(*command != '\0' && *command != ' ' && *command != '\t')
+    {
+        command++;
+    }
+    if(*command != '\0')
+    {
+        *command++ = '\0';
+    }
+    parameter = command;
+
+    S_RL021_ScpiCommand entry;
+    for(uint8_t i=0;i<commandCount;i++)
+    {
+        memcpy_P(&entry, &commands[i], sizeof(S_RL021_ScpiCommand));
+        if(!MatchHeader(entry.pattern, header))
+        {
+            continue;
+        }
+
+        commandResult = false;
+        int16_t error = entry.handler(this);
+        if(error != SCPI_NO_ERROR)
+        {
+            return error;
+        }
+
+        while(*parameter == ' ' || *parameter == '\t')
+        {
+            parameter++;
+        }
+        return (*parameter == '\0') ? SCPI_NO_ERROR : SCPI_PARAMETER_NOT_ALLOWED;
+    }
+    return SCPI_UNDEFINED_HEADER;
+}
+
+/** Compare header with pattern, mnemonics in short or long form, not case sensitive
+ *
+ *  @param const char * pattern - e.g. "[SOURce:]CURRent[:LEVel]?"
+ *  @param const char * header - e.g. "curr?", "SOUR:CURRENT:LEV?"
+ *	@return bool -
+ */
+bool RL021_Scpi::MatchHeader(const char * pattern, const char * header)
+{
+    if(*pattern == '\0')
+    {
+        return (*header == '\0');
+    }
+
+    if(*pattern == '[')
+    {
+        /// optional node: header without the node, else with the node (']' is skipped)
+        const char * end = strchr(pattern, ']');
+        if(end != NULL && MatchHeader(end + 1, header))
+        {
+            return true;
+        }
+        return MatchHeader(pattern + 1, header);
+    }
+    if(*pattern == ']')
+    {
+        return MatchHeader(pattern + 1, header);
+    }
+    if(!isalnum(*pattern))
+    {
+        /// ':', '?', '*'
+        return (*pattern == *header) && MatchHeader(pattern + 1, header + 1);
+    }
+
+    /// Mnemonic: long form, short form are the leading upper case letters / digits
+    uint8_t longLength = 0;
+    uint8_t shortLength = 0;
+    while(isalnum(pattern[longLength]))
+    {
+        if(shortLength == longLength && !islower(pattern[longLength]))
+        {
+            shortLength++;
+        }
+        longLength++;
+    }
+
+    uint8_t length = 0;
+    while(isalnum(header[length]))
+    {
+        length++;
+    }
+    if(length != shortLength && length != longLength)
+    {
+        return false;
+    }
+
+    for(uint8_t i=0;i<length;i++)
+    {
+        if(tolower(header[i]) != tolower(pattern[i]))
+        {
+            return false;
+        }
+    }
+    return MatchHeader(pattern + longLength, header + length);
+}
+
+/// Separator: ',' between values of a query, ';' between queries
+void RL021_Scpi::BeginResult()
+{
+    if(commandResult)
+    {
+        port->print(',');
+    }
+    else if(lineResult)
+    {
+        port->print(';');
+    }
+    lineResult = true;
+    commandResult = true;
+}
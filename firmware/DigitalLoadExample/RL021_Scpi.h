@@ -0,0 +1,135 @@
+/**
+* \file    RL021_Scpi.h
+* \brief    Table-driven SCPI-style command interpreter (line buffered, compound commands, error queue)
+* \brief    Required drivers: /
+*
+* \brief    basic functions:
+*               command table in PROGMEM: header pattern + handler, e.g. {"[SOURce:]CURRent[:LEVel]", scpiCurrent}
+*               pattern: mnemonics in long form, the upper case letters are the short form ("CURRent": CURR, CURRENT),
+*                        [...] optional node, '?' query, '*' common command (*IDN?), headers are not case sensitive
+*               Feed() collects one line (terminated by '\n', '\r' is ignored), the line is executed at once:
+*                        commands separated by ';' ("CURR 1.5;MEAS:ALL?;SYST:ERR?"), each header starts at the root
+*                        parameters separated by ',' after the header, read by the handler (GetNumber(), GetBoolean())
+*               responses of all queries of a line are sent in one line: values of a query separated by ',',
+*                        queries separated by ';' (SCPI response message)
+*               errors (SCPI numbers, e.g. -113 undefined header) are stored in a queue of RL021_SCPI_ERROR_QUEUE,
+*                        read with SYSTem:ERRor? (e.g. handler scpiError() of the sketch), a command with an error ends the line
+*
+* \brief    coexistence with single character commands: a line starts with an upper case letter, '*' or ':',
+*           other characters are not taken (Feed() returns false) and are passed to the legacy command handler
+*
+* \par     Editor
+*           17.10.2026 first implementation: SCPI-style command lines with compound queries
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_Scpi_H_
+#define _RL021_Scpi_H_
+
+#include <Arduino.h>
+
+/// max. length of a line (commands, parameters, without '\n')
+#ifndef RL021_SCPI_LINE_LENGTH
+#define RL021_SCPI_LINE_LENGTH      64
+#endif
+/// max. length of a header pattern incl. '\0'
+#define RL021_SCPI_PATTERN_LENGTH   32
+/// errors stored until read (last entry: -350 queue overflow)
+#define RL021_SCPI_ERROR_QUEUE      4
+
+/// SCPI error numbers
+#define SCPI_NO_ERROR               0
+#define SCPI_COMMAND_ERROR          -100
+#define SCPI_SYNTAX_ERROR           -102
+#define SCPI_DATA_TYPE_ERROR        -104
+#define SCPI_PARAMETER_NOT_ALLOWED  -108
+#define SCPI_MISSING_PARAMETER      -109
+#define SCPI_UNDEFINED_HEADER       -113
+#define SCPI_EXECUTION_ERROR        -200
+#define SCPI_SETTINGS_CONFLICT      -221
+#define SCPI_DATA_OUT_OF_RANGE      -222
+#define SCPI_QUEUE_OVERFLOW         -350
+#define SCPI_INPUT_BUFFER_OVERRUN   -363
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+class RL021_Scpi;
+
+/// Command handler - returns SCPI_NO_ERROR or an error number
+typedef int16_t (*RL021_ScpiHandler)(RL021_Scpi * scpi);
+
+/// Entry of the command table (PROGMEM)
+typedef struct
+{
+    char pattern[RL021_SCPI_PATTERN_LENGTH];
+    RL021_ScpiHandler handler;
+
+} S_RL021_ScpiCommand;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_Scpi {
+
+ public:
+    RL021_Scpi(Print * newPort, const S_RL021_ScpiCommand * newCommands, uint8_t newCommandCount);
+
+    /// Next received character - returns false if the character is not part of a SCPI line
+    bool Feed(char c);
+
+    /// Parameters of the actual command - return SCPI_NO_ERROR or an error number
+    int16_t GetNumber(float * value);
+    int16_t GetInteger(int32_t * value);
+    /// ON / OFF / number (0: false)
+    int16_t GetBoolean(bool * value);
+
+    /// Response values of the actual query
+    void ResultNumber(float value, uint8_t decimals);
+    void ResultInteger(int32_t value);
+    void ResultText(const char * text);
+    void ResultText(const __FlashStringHelper * text);
+    /// Text in double quotes (SCPI string response, e.g. error description)
+    void ResultString(const __FlashStringHelper * text);
+
+    /// Error queue (SYSTem:ERRor?, *CLS)
+    void PushError(int16_t error);
+    int16_t PopError();
+    uint8_t GetErrorCount();
+    void ClearErrors();
+    /// Description of an error number (text in flash)
+    static const __FlashStringHelper * GetErrorText(int16_t error);
+
+ private:
+    /// Execute all commands of the line
+    void ExecuteLine();
+    int16_t ExecuteCommand(char * command);
+    /// Header matches pattern (recursive for optional nodes)
+    static bool MatchHeader(const char * pattern, const char * header);
+    /// Separator before the next response value
+    void BeginResult();
+
+    Print * port;
+    const S_RL021_ScpiCommand * commands;
+    uint8_t commandCount;
+
+    char line[RL021_SCPI_LINE_LENGTH + 1];
+    uint8_t lineLength;
+    /// (true): line too long, characters are dropped until '\n'
+    bool overrun;
+
+    /// parameters of the actual command
+    char * parameter;
+    /// response: values of the line / of the actual command
+    bool lineResult;
+    bool commandResult;
+
+    int16_t errors[RL021_SCPI_ERROR_QUEUE];
+    uint8_t errorCount;
+};
+
+#endif /* _RL021_Scpi_H_ */
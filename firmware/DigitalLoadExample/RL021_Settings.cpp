@@ -0,0 +1,157 @@
+#include "RL021_Settings.h"
+#include "RL021_Protocol.h"
+
+#include <stddef.h>
+#include <EEPROM.h>
+
+static_assert(sizeof(S_RL021_Settings) <= RL021_SETTINGS_SLOT_SIZE, "settings blob exceeds EEPROM slot");
+
+
+/************************************************************************************************************************************************/
+/* Public - EEPROM
+/************************************************************************************************************************************************/
+/** Read slot of the load (one block read) and apply it if it is valid
+ *
+ *  @param RL021_DigitalLoad * load -
+ *	@return E_RL021_SETTINGS_STATUS - (SETTINGS_LOADED): settings applied, otherwise load is unchanged
+ */
+E_RL021_SETTINGS_STATUS RL021_Settings::Load(RL021_DigitalLoad * load)
+{
+    S_RL021_Settings settings;
+    EEPROM.get(SlotAddress(load), settings);
+
+    E_RL021_SETTINGS_STATUS status = Check(&settings, load->deviceADC->GetAddress());
+    if(status == SETTINGS_LOADED)
+    {
+        Apply(load, &settings);
+    }
+    return status;
+}
+
+/** Write actual settings to the slot of the load
+ *  EEPROM.put() updates only changed bytes (3.3ms per byte, 100000 cycles per cell)
+ *
+ *  @param RL021_DigitalLoad * load -
+ *	@return /
+ */
+void RL021_Settings::Save(RL021_DigitalLoad * load)
+{
+    S_RL021_Settings settings;
+    Collect(load, &settings);
+    EEPROM.put(SlotAddress(load), settings);
+}
+
+void RL021_Settings::Erase(RL021_DigitalLoad * load)
+{
+    /// magic only, the rest of the slot is not written
+    EEPROM.update(SlotAddress(load), 0xFF);
+    EEPROM.update(SlotAddress(load) + 1, 0xFF);
+}
+
+/************************************************************************************************************************************************/
+/* Public - blob
+/************************************************************************************************************************************************/
+/** Blob of the actual settings of the load
+ *  Padding bytes are zeroed, the CRC only depends on the settings.
+ *
+ *  @param RL021_DigitalLoad * load -
+ *  @param S_RL021_Settings * settings - output
+ *	@return /
+ */
+void RL021_Settings::Collect(RL021_DigitalLoad * load, S_RL021_Settings * settings)
+{
+    memset(settings, 0, sizeof(S_RL021_Settings));
+
+    settings->magic = RL021_SETTINGS_MAGIC;
+    settings->version = RL021_SETTINGS_VERSION;
+    settings->adcAddress = load->deviceADC->GetAddress();
+
+    settings->calibration = load->calibrationData;
+    settings->regulation = load->regulation;
+    settings->cvGain = load->cvGain;
+    settings->modeCurrentLimit_mA = load->modeCurrentLimit_mA;
+
+    settings->flags = (load->highRangeSelected_current ? RL021_SETTINGS_JP2 : 0) |
+                      (load->lowRangeSelected_Vload ? RL021_SETTINGS_JP3 : 0) |
+                      (load->lowRangeSelected_Vext ? RL021_SETTINGS_JP4 : 0) |
+                      (load->regulationEnabled ? RL021_SETTINGS_REGULATION : 0);
+    settings->adcResolution = load->GetAdcResolution();
+
+    for(uint8_t i=0;i<ADC_CH_LAST;i++)
+    {
+        settings->filter[i] = (load->GetFilterType((E_ADC_CHANNEL)i) << 4) | load->GetFilterShift((E_ADC_CHANNEL)i);
+    }
+    settings->autoGain = load->GetAutoGain();
+
+    settings->crc = CRC(settings);
+}
+
+/** Apply a checked blob: calibration, jumpers (transfer functions), acquisition and regulation settings
+ *
+ *  @param RL021_DigitalLoad * load -
+ *  @param const S_RL021_Settings * settings - see Check()
+ *	@return /
+ */
+void RL021_Settings::Apply(RL021_DigitalLoad * load, const S_RL021_Settings * settings)
+{
+    load->SetCalibrationData(settings->calibration);
+    load->SetJumperSetting(JP2_CURRENT, settings->flags & RL021_SETTINGS_JP2);
+    load->SetJumperSetting(JP3_VLOAD, settings->flags & RL021_SETTINGS_JP3);
+    load->SetJumperSetting(JP4_VEXT, settings->flags & RL021_SETTINGS_JP4);
+
+    load->SetAdcResolution(settings->adcResolution);
+    for(uint8_t i=0;i<ADC_CH_LAST;i++)
+    {
+        uint8_t type = settings->filter[i] >> 4;
+        if(type > FILTER_DECIMATE || !load->SetFilter((E_ADC_CHANNEL)i, (E_RL021_FILTER)type, settings->filter[i] & 0x0F))
+        {
+            load->SetFilter((E_ADC_CHANNEL)i, FILTER_NONE, 0);
+        }
+    }
+    load->SetAutoGain(settings->autoGain);
+
+    load->SetRegulationParameters(settings->regulation);
+    load->EnableRegulation(settings->flags & RL021_SETTINGS_REGULATION);
+    load->SetModeCurrentLimit_mA(settings->modeCurrentLimit_mA);
+    load->SetCvGain(settings->cvGain);
+}
+
+/** Check blob read from the slot of a board
+ *
+ *  @param const S_RL021_Settings * settings -
+ *  @param uint8_t adcAddress - 7-bit ADC address of the board
+ *	@return E_RL021_SETTINGS_STATUS - SETTINGS_LOADED: valid
+ */
+E_RL021_SETTINGS_STATUS RL021_Settings::Check(const S_RL021_Settings * settings, uint8_t adcAddress)
+{
+    if(settings->magic != RL021_SETTINGS_MAGIC)
+    {
+        return SETTINGS_EMPTY;
+    }
+    if(settings->version != RL021_SETTINGS_VERSION)
+    {
+        return SETTINGS_VERSION;
+    }
+    if(settings->adcAddress != adcAddress)
+    {
+        return SETTINGS_ADDRESS;
+    }
+    if(settings->crc != CRC(settings))
+    {
+        return SETTINGS_CRC;
+    }
+    return SETTINGS_LOADED;
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+uint16_t RL021_Settings::SlotAddress(RL021_DigitalLoad * load)
+{
+    return RL021_SETTINGS_BASE + (load->deviceADC->GetAddress() % RL021_SETTINGS_SLOTS) * RL021_SETTINGS_SLOT_SIZE;
+}
+
+uint16_t RL021_Settings::CRC(const S_RL021_Settings * settings)
+{
+    return RL021_Protocol::CRC16((const uint8_t *)settings, offsetof(S_RL021_Settings, crc));
+}
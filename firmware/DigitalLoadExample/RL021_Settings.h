@@ -0,0 +1,115 @@
+/**
+* \file    RL021_Settings.h
+* \brief    Calibration and settings of a board in the EEPROM of the MCU (versioned blob with CRC)
+* \brief    Required drivers: RL021_DigitalLoad.h, RL021_Protocol.h (CRC16), EEPROM.h (Arduino)
+*
+* \brief    basic functions:
+*               one slot of RL021_SETTINGS_SLOT_SIZE bytes per board, slot = A2, A1, A0 of the ADC address
+*               (ADC 0x68 + n: slot n, RL021_SETTINGS_SLOTS x RL021_SETTINGS_SLOT_SIZE = 1024 bytes EEPROM)
+*               Load(): one block read of the slot at boot, the blob is applied only if magic, version, ADC address
+*                       and CRC match - otherwise the load keeps its defaults (SetDefaultCalibration(), setup())
+*               Save(): actual settings of the load, only changed bytes are written (EEPROM.put(), update)
+*
+* \brief    content (S_RL021_Settings): calibration data, jumper settings, ADC resolution, filters, regulation
+*               parameters and enable, current limit and gain of the load modes, PGA auto-gain channels
+*               not stored: setpoint and load mode (the load always starts with 0mA, CC), correction tables
+*               (RAM of the sketch, see RL021_Calibration)
+*               a new layout gets a new RL021_SETTINGS_VERSION, blobs of other versions are not loaded
+*               (version 2: PGA calibration, auto-gain)
+*
+* \par     Editor
+*           17.10.2026 first implementation: calibration and settings per board in EEPROM
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_Settings_H_
+#define _RL021_Settings_H_
+
+#include "RL021_DigitalLoad.h"
+
+/// Magic and layout version of the blob
+#define RL021_SETTINGS_MAGIC        0x5221
+#define RL021_SETTINGS_VERSION      2
+/// EEPROM address of slot 0, bytes per slot, slots (ADC address 0x68 ... 0x6F)
+#define RL021_SETTINGS_BASE         0
+#define RL021_SETTINGS_SLOT_SIZE    128
+#define RL021_SETTINGS_SLOTS        8
+
+/// Bits of S_RL021_Settings::flags
+#define RL021_SETTINGS_JP2          (1<<0)
+#define RL021_SETTINGS_JP3          (1<<1)
+#define RL021_SETTINGS_JP4          (1<<2)
+#define RL021_SETTINGS_REGULATION   (1<<3)
+
+
+/************************************************************************/
+/* Enums                                                                */
+/************************************************************************/
+typedef enum
+{
+    SETTINGS_LOADED,
+    SETTINGS_EMPTY,         /// no blob in the slot (erased EEPROM / magic)
+    SETTINGS_VERSION,       /// blob of another layout version
+    SETTINGS_ADDRESS,       /// blob of another ADC address
+    SETTINGS_CRC            /// CRC mismatch (write interrupted, EEPROM worn out)
+
+} E_RL021_SETTINGS_STATUS;
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+typedef struct
+{
+    uint16_t magic;
+    uint8_t version;
+    /// 7-bit ADC address of the board (key of the slot)
+    uint8_t adcAddress;
+
+    S_RL021_Calibration calibration;
+    S_RL021_Regulation regulation;
+    float cvGain;
+    uint16_t modeCurrentLimit_mA;
+    /// RL021_SETTINGS_JP2 ... RL021_SETTINGS_REGULATION
+    uint8_t flags;
+    uint8_t adcResolution;
+    /// filter of each channel: type << 4 | shift
+    uint8_t filter[ADC_CH_LAST];
+    /// PGA auto-gain channels (1<<E_ADC_CHANNEL)
+    uint8_t autoGain;
+
+    /// CRC-16/CCITT of all bytes before
+    uint16_t crc;
+
+} S_RL021_Settings;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_Settings {
+
+ public:
+    /// Apply the blob of the load's slot - the load is unchanged if the blob is not valid
+    static E_RL021_SETTINGS_STATUS Load(RL021_DigitalLoad * load);
+    /// Store actual settings of the load in its slot
+    static void Save(RL021_DigitalLoad * load);
+    /// Invalidate slot of the load (defaults at next boot)
+    static void Erase(RL021_DigitalLoad * load);
+
+    /// Blob of the actual settings / apply blob to the load
+    static void Collect(RL021_DigitalLoad * load, S_RL021_Settings * settings);
+    static void Apply(RL021_DigitalLoad * load, const S_RL021_Settings * settings);
+
+    /// Check magic, version, address and CRC of a blob read from the slot
+    static E_RL021_SETTINGS_STATUS Check(const S_RL021_Settings * settings, uint8_t adcAddress);
+
+ private:
+    /// EEPROM address of the slot of the load
+    static uint16_t SlotAddress(RL021_DigitalLoad * load);
+    static uint16_t CRC(const S_RL021_Settings * settings);
+};
+
+#endif /* _RL021_Settings_H_ */
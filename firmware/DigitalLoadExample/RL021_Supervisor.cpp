@@ -0,0 +1,304 @@
+#include "RL021_Supervisor.h"
+
+/// Default SOA curve: power limit up to 10V, second breakdown derating of the linear NFET above
+static const S_RL021_SoaPoint SOA_DEFAULT[] = {
+    {    0, 10000},
+    { 3000, 10000},
+    {10000,  3000},
+    {20000,  1200},
+    {30000,   500},
+};
+
+/// Checked channels, index of S_RL021_SupervisorStatus::checked_us
+static const E_ADC_CHANNEL SUPERVISED_CHANNELS[3] = {ADC_CH_CURRENT, ADC_CH_VLOAD, ADC_CH_NTC};
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_Supervisor::RL021_Supervisor()
+{
+    boardCount = 0;
+
+    limits.maxTemperature = RL021_SUPERVISOR_MAX_TEMPERATURE;
+    limits.deratingStart = RL021_SUPERVISOR_DERATING_START;
+    limits.maxPower_mW = RL021_SUPERVISOR_MAX_POWER_MW;
+    limits.maxCurrent_mA = RL021_SUPERVISOR_MAX_CURRENT_MA;
+    limits.maxAge_ms = RL021_SUPERVISOR_MAX_AGE_MS;
+    limits.soaPoints = sizeof(SOA_DEFAULT) / sizeof(SOA_DEFAULT[0]);
+    memcpy(limits.soa, SOA_DEFAULT, sizeof(SOA_DEFAULT));
+}
+
+/************************************************************************************************************************************************/
+/* Public - boards / limits
+/************************************************************************************************************************************************/
+/** Add supervised board (background acquisition of current, load voltage and NTC)
+ *
+ *  @param RL021_DigitalLoad * load -
+ *	@return int8_t - board number, -1: full
+ */
+int8_t RL021_Supervisor::AddBoard(RL021_DigitalLoad * load)
+{
+    if(boardCount >= LOAD_BOARDS || load == NULL)
+    {
+        return -1;
+    }
+
+    boards[boardCount] = load;
+    memset(&status[boardCount], 0, sizeof(S_RL021_SupervisorStatus));
+    status[boardCount].derating = 256;
+    return boardCount++;
+}
+
+uint8_t RL021_Supervisor::GetBoardCount()
+{
+    return boardCount;
+}
+
+/** Limits of all boards, the derating is recalculated with the next temperature
+ *
+ *  @param const S_RL021_SupervisorLimits * newLimits - SOA points with ascending voltage
+ *	@return /
+ */
+void RL021_Supervisor::SetLimits(const S_RL021_SupervisorLimits * newLimits)
+{
+    limits = *newLimits;
+    limits.soaPoints = min(limits.soaPoints, (uint8_t)RL021_SOA_POINTS);
+
+    for(uint8_t i=0;i<boardCount;i++)
+    {
+        status[i].checked_us[2] = 0;
+    }
+}
+
+const S_RL021_SupervisorLimits * RL021_Supervisor::GetLimits()
+{
+    return &limits;
+}
+
+/************************************************************************************************************************************************/
+/* Public - supervision
+/************************************************************************************************************************************************/
+/** Check the latest measurements of all boards, shutdown of a board on a limit violation
+ *  Only cached values are used (no bus access except the DAC write of a trip).
+ *
+ *  @param /
+ *	@return bool - (true): at least one board tripped with this call
+ */
+bool RL021_Supervisor::Service()
+{
+    bool tripped = false;
+
+    for(uint8_t i=0;i<boardCount;i++)
+    {
+        if(status[i].faults == 0 && Check(i) != 0)
+        {
+            tripped = true;
+        }
+    }
+    return tripped;
+}
+
+uint8_t RL021_Supervisor::GetFaults(uint8_t board)
+{
+    return (board < boardCount) ? status[board].faults : 0;
+}
+
+const S_RL021_SupervisorStatus * RL021_Supervisor::GetStatus(uint8_t board)
+{
+    return (board < boardCount) ? &status[board] : NULL;
+}
+
+/** Clear latched faults, the load restarts with 0mA
+ *  A violation which is still present trips again with the next conversion (e.g. over-temperature).
+ *
+ *  @param uint8_t board -
+ *	@return /
+ */
+void RL021_Supervisor::ClearFaults(uint8_t board)
+{
+    if(board >= boardCount)
+    {
+        return;
+    }
+
+    /// conversions before the release are not checked again (values of the trip)
+    for(uint8_t i=0;i<3;i++)
+    {
+        status[board].checked_us[i] = boards[board]->measurement[SUPERVISED_CHANNELS[i]].timestamp_us;
+    }
+    status[board].faults = 0;
+    boards[board]->ReleaseShutdown();
+}
+
+/** Max. current of the SOA curve at a load voltage (linear interpolation between the points)
+ *
+ *  @param uint16_t voltage_mV -
+ *	@return uint16_t - [mA], 0xFFFF: no SOA curve
+ */
+uint16_t RL021_Supervisor::SoaCurrent_mA(uint16_t voltage_mV)
+{
+    if(limits.soaPoints == 0)
+    {
+        return 0xFFFF;
+    }
+    if(voltage_mV <= limits.soa[0].voltage_mV)
+    {
+        return limits.soa[0].current_mA;
+    }
+
+    for(uint8_t i=1;i<limits.soaPoints;i++)
+    {
+        const S_RL021_SoaPoint * high = &limits.soa[i];
+        if(voltage_mV < high->voltage_mV)
+        {
+            const S_RL021_SoaPoint * low = &limits.soa[i-1];
+            int32_t delta = (int32_t)high->current_mA - low->current_mA;
+            return low->current_mA + delta * (voltage_mV - low->voltage_mV) / (high->voltage_mV - low->voltage_mV);
+        }
+    }
+    return limits.soa[limits.soaPoints-1].current_mA;
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+/** Check a board if one of its acquired channels has a new conversion (stale check on every call)
+ *  Current and voltage are calculated from the latest raw conversion (without the delay of the channel filter).
+ *  Load on (DAC above the value of 0mA) without acquisition of all supervised channels trips at once (limits not checkable).
+ *
+ *  @param uint8_t board -
+ *	@return uint8_t - new faults (board tripped)
+ */
+uint8_t RL021_Supervisor::Check(uint8_t board)
+{
+    RL021_DigitalLoad * load = boards[board];
+    S_RL021_SupervisorStatus * state = &status[board];
+    uint8_t mask = load->acquisitionActive ? load->GetAcquisitionMask() : 0;
+    uint8_t faults = 0;
+    uint8_t fresh = 0;
+    uint32_t newest_us = 0;
+    uint32_t now_us = micros();
+    bool loadOn = load->dacOutput > load->CalculateDAC(0);
+
+    for(uint8_t i=0;i<3;i++)
+    {
+        if(loadOn && !(mask & (1<<SUPERVISED_CHANNELS[i])))
+        {
+            faults |= RL021_FAULT_UNSUPERVISED;
+        }
+    }
+
+    for(uint8_t i=0;i<3;i++)
+    {
+        const S_RL021_Measurement * measurement = &load->measurement[SUPERVISED_CHANNELS[i]];
+        if(!(mask & (1<<SUPERVISED_CHANNELS[i])) || !measurement->valid)
+        {
+            continue;
+        }
+
+        if(measurement->timestamp_us != state->checked_us[i])
+        {
+            state->checked_us[i] = measurement->timestamp_us;
+            if(!fresh || (int32_t)(measurement->timestamp_us - newest_us) > 0)
+            {
+                newest_us = measurement->timestamp_us;
+            }
+            fresh |= (1<<i);
+        }
+        else if(limits.maxAge_ms && (now_us - measurement->timestamp_us) > (uint32_t)limits.maxAge_ms * 1000)
+        {
+            faults |= RL021_FAULT_STALE;
+        }
+    }
+
+    if(!fresh)
+    {
+        if(!faults)
+        {
+            return 0;
+        }
+        /// stale / unsupervised only: latency of the shutdown itself
+        newest_us = now_us;
+    }
+
+    /// temperature: derating per new value
+    if(fresh & (1<<2))
+    {
+        int16_t temperature = load->measurement[ADC_CH_NTC].value;
+        state->derating = Derating(temperature);
+        if(temperature >= limits.maxTemperature)
+        {
+            faults |= RL021_FAULT_OT;
+        }
+    }
+
+    bool currentValid = (mask & (1<<ADC_CH_CURRENT)) && load->measurement[ADC_CH_CURRENT].valid;
+    bool voltageValid = (mask & (1<<ADC_CH_VLOAD)) && load->measurement[ADC_CH_VLOAD].valid;
+    int32_t current_mA = 0;
+    int32_t voltage_mV = 0;
+
+    if(currentValid)
+    {
+        const S_RL021_Measurement * current = &load->measurement[ADC_CH_CURRENT];
+        current_mA = max(load->CalculateValue(current->raw, ADC_CH_CURRENT, current->gain), (int32_t)0);
+        if(current_mA > limits.maxCurrent_mA)
+        {
+            faults |= RL021_FAULT_OC;
+        }
+    }
+
+    if(currentValid && voltageValid)
+    {
+        const S_RL021_Measurement * voltage = &load->measurement[ADC_CH_VLOAD];
+        voltage_mV = max(load->CalculateValue(voltage->raw, ADC_CH_VLOAD, voltage->gain), (int32_t)0);
+
+        /// mV * mA / 1000 = mW, limits in Q8 (derating)
+        uint32_t power_mW = (uint32_t)voltage_mV * current_mA / 1000;
+        if(power_mW * 256 > limits.maxPower_mW * state->derating)
+        {
+            faults |= RL021_FAULT_OP;
+        }
+        if((uint32_t)current_mA * 256 > (uint32_t)SoaCurrent_mA(min(voltage_mV, (int32_t)UINT16_MAX)) * state->derating)
+        {
+            faults |= RL021_FAULT_SOA;
+        }
+    }
+
+    if(faults)
+    {
+        Trip(board, faults, current_mA, voltage_mV, newest_us);
+    }
+    return faults;
+}
+
+/** Derating of power and SOA current: 1 up to deratingStart, linear to 0 at maxTemperature
+ *
+ *  @param int16_t temperature - [°C x10]
+ *	@return uint16_t - Q8 (256: no derating)
+ */
+uint16_t RL021_Supervisor::Derating(int16_t temperature)
+{
+    if(temperature <= limits.deratingStart)
+    {
+        return 256;
+    }
+    if(temperature >= limits.maxTemperature)
+    {
+        return 0;
+    }
+    return ((int32_t)(limits.maxTemperature - temperature) << 8) / (limits.maxTemperature - limits.deratingStart);
+}
+
+void RL021_Supervisor::Trip(uint8_t board, uint8_t faults, int32_t current_mA, int32_t voltage_mV, uint32_t timestamp_us)
+{
+    boards[board]->Shutdown();
+
+    S_RL021_SupervisorStatus * state = &status[board];
+    state->tripLatency_us = micros() - timestamp_us;
+    state->faults = faults;
+    state->tripCurrent_mA = current_mA;
+    state->tripVoltage_mV = voltage_mV;
+    state->tripTemperature = boards[board]->measurement[ADC_CH_NTC].valid ? boards[board]->measurement[ADC_CH_NTC].value : 0;
+    state->trips++;
+}
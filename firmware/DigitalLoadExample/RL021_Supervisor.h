@@ -0,0 +1,168 @@
+/**
+* \file    RL021_Supervisor.h
+* \brief    Safety supervisor of the NFET: over-temperature, over-power, over-current and SOA limits with
+*           temperature derating, shutdown with latched fault codes
+* \brief    Required drivers: RL021_DigitalLoad.h (background acquisition, Shutdown())
+*
+* \brief    basic functions:
+*               up to LOAD_BOARDS boards (see RL021_LoadGroup.h), one set of limits for all boards (S_RL021_SupervisorLimits)
+*               Service() checks the cached measurements of every board, it never starts a conversion or waits
+*               for the bus - run it as the task with the highest priority
+*               current and load voltage: latest raw conversion (not the channel filter output, no filter delay),
+*               temperature: filtered measurement (heatsink, slow)
+*               a board is only checked if one of its measurements is new (timestamp), limits of channels which
+*               are not acquired are not checked (OP / SOA need ADC_CH_CURRENT and ADC_CH_VLOAD) - while the load
+*               is on (DAC above the value of 0mA) all three channels have to be acquired, else the board trips (UNSUPERVISED,
+*               e.g. stream or synchronized capture of the current only)
+*
+* \brief    limits (P = V_load * I):
+*               OT:    T >= maxTemperature
+*               OC:    I > maxCurrent_mA
+*               OP:    P > maxPower_mW * derating
+*               SOA:   I > I_soa(V_load) * derating, I_soa: piecewise linear over the SOA points (DC SOA of the NFET)
+*               STALE: acquired channel without new conversion for maxAge_ms (acquisition stalled, ADC not responding)
+*               UNSUPERVISED: load on, current, load voltage or NTC not acquired (limits could not be checked)
+*               derating = 1 up to deratingStart, linear to 0 at maxTemperature (Q8, calculated per new temperature)
+*
+* \brief    trip: RL021_DigitalLoad::Shutdown() (DAC 0 written directly, queued DAC writes dropped, DAC writes blocked),
+*               fault bits are latched until ClearFaults(), values of the trip are kept (S_RL021_SupervisorStatus)
+*
+* \brief    worst-case latency limit violation -> DAC 0 written:
+*               T_ch:  time per conversion of the acquisition (see RL021_DigitalLoad.h), N acquired channels
+*               T_sup: period of the Service() task + max. duration of the other tasks (cooperative scheduler)
+*               T_dac: direct DAC write (~0.3ms @100kHz, one queued transaction may be on the bus)
+*               latency = (N+1)*T_ch + T_sup + T_dac   (violation just after the start of the channel's conversion)
+*               the latency conversion end -> DAC written is measured for every trip (tripLatency_us)
+*               e.g. 4 channels, T_io=1ms, T_sup=0.5ms: 12-bit: 33ms, 16-bit: 366ms
+*               host benchmark (acquisition task 1ms, supervisor task 0.5ms, 4 channels, over-power step at random phase):
+*               12-bit: mean 6.8ms, max. 25.4ms, 16-bit: mean 68ms, max. 238ms (conversion -> DAC: max. 0.8ms)
+*               check of one board with a new conversion: ~1900 AVR cycles (119us), without: ~16us
+*
+* \par     Editor
+*           17.10.2026 first implementation: safety supervisor with latched faults
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_Supervisor_H_
+#define _RL021_Supervisor_H_
+
+#include "RL021_DigitalLoad.h"
+#include "RL021_LoadGroup.h"
+
+/// Points of the SOA curve
+#define RL021_SOA_POINTS            6
+
+/// Default limits (heatsink NTC, TSM70N600 on the heatsink of the RL-021)
+#define RL021_SUPERVISOR_MAX_TEMPERATURE    900     /// [°C x10]
+#define RL021_SUPERVISOR_DERATING_START     600     /// [°C x10]
+#define RL021_SUPERVISOR_MAX_POWER_MW       30000
+#define RL021_SUPERVISOR_MAX_CURRENT_MA     10500
+#define RL021_SUPERVISOR_MAX_AGE_MS         1000
+
+/// Latched fault bits
+#define RL021_FAULT_OT              (1<<0)      /// over-temperature
+#define RL021_FAULT_OP              (1<<1)      /// over-power (derated)
+#define RL021_FAULT_OC              (1<<2)      /// over-current
+#define RL021_FAULT_SOA             (1<<3)      /// safe operating area (derated)
+#define RL021_FAULT_STALE           (1<<4)      /// no new conversion of an acquired channel
+#define RL021_FAULT_UNSUPERVISED    (1<<5)      /// load on without acquisition of a supervised channel
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+/// Point of the SOA curve: max. current at load voltage
+typedef struct
+{
+    uint16_t voltage_mV;
+    uint16_t current_mA;
+
+} S_RL021_SoaPoint;
+
+typedef struct
+{
+    /// over-temperature trip, start of the derating [°C x10]
+    int16_t maxTemperature;
+    int16_t deratingStart;
+    /// over-power trip below deratingStart [mW]
+    uint32_t maxPower_mW;
+    /// over-current trip [mA]
+    uint16_t maxCurrent_mA;
+    /// max. age of the latest conversion of an acquired channel [ms] (0: no check)
+    uint16_t maxAge_ms;
+    /// SOA curve below deratingStart, voltage ascending (0 points: no SOA check)
+    /// above the last point the current of the last point is used
+    uint8_t soaPoints;
+    S_RL021_SoaPoint soa[RL021_SOA_POINTS];
+
+} S_RL021_SupervisorLimits;
+
+/// State of one board
+typedef struct
+{
+    /// latched RL021_FAULT_xxx
+    uint8_t faults;
+    /// actual derating (Q8, 256: no derating)
+    uint16_t derating;
+    /// timestamps of the checked conversions: current, load voltage, NTC
+    uint32_t checked_us[3];
+
+    /// values of the last trip [mA], [mV], [°C x10]
+    int32_t tripCurrent_mA;
+    int32_t tripVoltage_mV;
+    int16_t tripTemperature;
+    /// end of the conversion of the trip -> DAC 0 written [us]
+    uint32_t tripLatency_us;
+    /// trips since start (cleared faults included)
+    uint16_t trips;
+
+} S_RL021_SupervisorStatus;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_Supervisor {
+
+ public:
+    /// Default limits (RL021_SUPERVISOR_xxx and default SOA curve)
+    RL021_Supervisor();
+
+    /// Add supervised board - returns board number, -1 if full
+    int8_t AddBoard(RL021_DigitalLoad * load);
+    uint8_t GetBoardCount();
+
+    /// Limits of all boards
+    void SetLimits(const S_RL021_SupervisorLimits * newLimits);
+    const S_RL021_SupervisorLimits * GetLimits();
+
+    /// Check all boards - returns true if a board tripped with this call
+    bool Service();
+
+    /// Latched faults of a board (0: none)
+    uint8_t GetFaults(uint8_t board);
+    const S_RL021_SupervisorStatus * GetStatus(uint8_t board);
+    /// Clear latched faults, release the shutdown of the board (load restarts with 0mA)
+    void ClearFaults(uint8_t board);
+
+    /// Max. current at load voltage below deratingStart [mA] (SOA curve)
+    uint16_t SoaCurrent_mA(uint16_t voltage_mV);
+
+ private:
+    /// Check new measurements of a board - returns new fault bits
+    uint8_t Check(uint8_t board);
+    /// Derating of a temperature (Q8)
+    uint16_t Derating(int16_t temperature);
+    /// Shutdown of the board, latch faults and values of the trip
+    void Trip(uint8_t board, uint8_t faults, int32_t current_mA, int32_t voltage_mV, uint32_t timestamp_us);
+
+    S_RL021_SupervisorLimits limits;
+
+    RL021_DigitalLoad * boards[LOAD_BOARDS];
+    S_RL021_SupervisorStatus status[LOAD_BOARDS];
+    uint8_t boardCount;
+};
+
+#endif /* _RL021_Supervisor_H_ */
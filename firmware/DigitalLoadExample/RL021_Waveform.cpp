@@ -0,0 +1,262 @@
+#include "RL021_Waveform.h"
+
+/// Waveform of the sample clock interrupt
+static RL021_Waveform * activeWaveform = NULL;
+
+#ifdef __AVR__
+ISR(TIMER1_COMPA_vect)
+{
+    if(activeWaveform)
+    {
+        activeWaveform->TimerTick();
+    }
+}
+#endif
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_Waveform::RL021_Waveform(RL021_DigitalLoad * newLoad):load(newLoad)
+{
+    tableLength = 0;
+    offset_mA = 0;
+    amplitude_mA = 0;
+    period_us = 1000;
+    repeats = 1;
+    running = false;
+    ticks = 0;
+    sampleIndex = 0;
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+/************************************************************************************************************************************************/
+/* Public - table and settings
+/************************************************************************************************************************************************/
+void RL021_Waveform::ClearTable()
+{
+    if(!running)
+    {
+        tableLength = 0;
+    }
+}
+
+/** Append sample to table
+ *
+ *  @param uint16_t sample - 0 ... RL021_WAVE_FULLSCALE (limited)
+ *	@return bool - (false): table full or player running
+ */
+bool RL021_Waveform::AddSample(uint16_t sample)
+{
+    if(running || tableLength >= RL021_WAVE_TABLE_SIZE)
+    {
+        return false;
+    }
+
+    table[tableLength++] = min(sample, (uint16_t)RL021_WAVE_FULLSCALE);
+    return true;
+}
+
+uint8_t RL021_Waveform::GetTableLength()
+{
+    return tableLength;
+}
+
+/// current = offset_mA + sample * amplitude_mA / RL021_WAVE_FULLSCALE (used by next Start())
+void RL021_Waveform::SetScaling(uint16_t newOffset_mA, uint16_t newAmplitude_mA)
+{
+    offset_mA = newOffset_mA;
+    amplitude_mA = newAmplitude_mA;
+}
+
+/** Sample rate of next Start()
+ *
+ *  @param uint16_t rate_Hz - RL021_WAVE_MIN_RATE_HZ ... RL021_WAVE_MAX_RATE_HZ
+ *	@return bool - (false): out of range, not changed
+ */
+bool RL021_Waveform::SetSampleRate(uint16_t rate_Hz)
+{
+    if(rate_Hz < RL021_WAVE_MIN_RATE_HZ || rate_Hz > RL021_WAVE_MAX_RATE_HZ)
+    {
+        return false;
+    }
+
+    period_us = (1000000UL + rate_Hz/2) / rate_Hz;
+    return true;
+}
+
+/// Number of table repetitions of next Start() (0: endless)
+void RL021_Waveform::SetRepeatCount(uint16_t newRepeats)
+{
+    repeats = newRepeats;
+}
+
+/************************************************************************************************************************************************/
+/* Public - player
+/************************************************************************************************************************************************/
+/** Precalculate the DAC codes of all samples, write first sample and start sample clock
+ *  The DAC is owned by the player until the end of the run (no regulation, CC mode only)
+ *
+ *  @param /
+ *	@return bool - (false): empty table, regulation or CV/CP/CR mode active
+ */
+bool RL021_Waveform::Start()
+{
+    if(tableLength == 0 || load->regulationEnabled || load->GetLoadMode() != LOAD_MODE_CC)
+    {
+        return false;
+    }
+
+    Stop();
+
+    for(uint8_t i=0;i<tableLength;i++)
+    {
+        uint32_t current_mA = offset_mA + ((uint32_t)table[i] * amplitude_mA + RL021_WAVE_FULLSCALE/2) / RL021_WAVE_FULLSCALE;
+        dacCodes[i] = load->CalculateDAC(min(current_mA, (uint32_t)UINT16_MAX));
+    }
+
+    sampleCount = (uint32_t)repeats * tableLength;
+    sampleIndex = 0;
+    ticks = 0;
+    memset(&statistics, 0, sizeof(statistics));
+    statistics.latencyMin_us = UINT16_MAX;
+
+    /// sample 0: written before the sample clock starts
+    lastCode = dacCodes[0];
+    load->SetRawDacImmediate(lastCode);
+    statistics.samples = 1;
+
+    running = true;
+    activeWaveform = this;
+    StartTimer();
+    return true;
+}
+
+/// Stop sample clock, load returns to its current setpoint
+void RL021_Waveform::Stop()
+{
+    if(!running)
+    {
+        return;
+    }
+
+    StopTimer();
+    running = false;
+    activeWaveform = NULL;
+
+    load->WriteCurrentSetpoint(load->setpoint_mA);
+}
+
+bool RL021_Waveform::IsRunning()
+{
+    return running;
+}
+
+/** Write DAC code of the latest sample clock tick (older ticks without DAC write are counted as missed)
+ *  The DAC is written on return, queued I2C transactions of other devices stay queued.
+ *
+ *  @param /
+ *	@return bool - (true): DAC written
+ */
+bool RL021_Waveform::Service()
+{
+    if(!running)
+    {
+        return false;
+    }
+
+#ifndef __AVR__
+    /// sample clock from micros()
+    while((int32_t)(micros() - nextTick_us) >= 0)
+    {
+        TimerTick();
+        tickTimestamp_us = nextTick_us;
+        nextTick_us += period_us;
+    }
+#endif
+
+    noInterrupts();
+    uint32_t actualTicks = ticks;
+    uint32_t actualTimestamp_us = tickTimestamp_us;
+    interrupts();
+
+    if(actualTicks == sampleIndex)
+    {
+        return false;
+    }
+
+    statistics.missed += actualTicks - sampleIndex - 1;
+    sampleIndex = actualTicks;
+
+    /// end of the last sample period
+    if(sampleCount && sampleIndex >= sampleCount)
+    {
+        Stop();
+        return true;
+    }
+
+    uint16_t code = dacCodes[sampleIndex % tableLength];
+    if(code != lastCode)
+    {
+        lastCode = code;
+        load->SetRawDacImmediate(lastCode);
+    }
+
+    uint32_t latency_us = micros() - actualTimestamp_us;
+    latency_us = min(latency_us, (uint32_t)UINT16_MAX);
+    statistics.latencyMin_us = min(statistics.latencyMin_us, (uint16_t)latency_us);
+    statistics.latencyMax_us = max(statistics.latencyMax_us, (uint16_t)latency_us);
+    statistics.samples++;
+    return true;
+}
+
+const S_RL021_WaveStatistics * RL021_Waveform::GetStatistics()
+{
+    return &statistics;
+}
+
+/// Sample clock tick (interrupt context)
+void RL021_Waveform::TimerTick()
+{
+    ticks++;
+    tickTimestamp_us = micros();
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+/** Timer1 CTC mode, compare match A interrupt with sample period
+ *  prescaler 8 (0.5us, max. 32.7ms) or 64 (4us, max. 262ms)
+ */
+void RL021_Waveform::StartTimer()
+{
+#ifdef __AVR__
+    noInterrupts();
+    TCCR1A = 0;
+    TCCR1B = 0;
+    TCNT1 = 0;
+    if(period_us * 2 <= 65536UL)
+    {
+        OCR1A = period_us * 2 - 1;
+        TCCR1B = (1<<WGM12) | (1<<CS11);
+    }
+    else
+    {
+        OCR1A = period_us / 4 - 1;
+        TCCR1B = (1<<WGM12) | (1<<CS11) | (1<<CS10);
+    }
+    TIFR1 = (1<<OCF1A);
+    TIMSK1 |= (1<<OCIE1A);
+    interrupts();
+#else
+    nextTick_us = micros() + period_us;
+#endif
+}
+
+void RL021_Waveform::StopTimer()
+{
+#ifdef __AVR__
+    TIMSK1 &= ~(1<<OCIE1A);
+    TCCR1B = 0;
+#endif
+}
@@ -0,0 +1,135 @@
+/**
+* \file    RL021_Waveform.h
+* \brief    Arbitrary waveform player for the load current, sample clock from hardware timer (Timer1)
+* \brief    Required drivers: RL021_DigitalLoad.h
+*
+* \brief    basic functions:
+*               table of up to RL021_WAVE_TABLE_SIZE samples (0 ... RL021_WAVE_FULLSCALE), uploaded e.g. via serial port
+*               current of a sample:  offset [mA] + sample * amplitude [mA] / RL021_WAVE_FULLSCALE
+*               DAC codes of all samples are precalculated by Start() (calibration of the load)
+*               sample rate RL021_WAVE_MIN_RATE_HZ ... RL021_WAVE_MAX_RATE_HZ, table is repeated N times (0: endless)
+*               after the last sample the load returns to the current setpoint of SetCurrent_mA()
+*
+* \brief    timing:
+*               Timer1 compare interrupt (CTC, 0.5us resolution) only latches the sample clock and its micros() timestamp.
+*               The DAC is written by Service() (I2C must not be used in interrupt context) directly on the bus
+*               (RL021_DigitalLoad::SetRawDacImmediate()), the I2C_Engine queue of the other devices is not executed first.
+*               Latency tick -> DAC written and missed samples are measured.
+*               Jitter is the longest code between two Service() calls: the sketch calls Service() in loop() between
+*               the tasks, i.e. the duration of the longest task (e.g. one acquisition transaction, telemetry output).
+*               Measured in the host simulation (2kHz, 4000 samples, 100kHz bus, sketch tasks, acquisition of all boards):
+*               latency 310 ... 556us with 1 board, 310 ... 580us with 4 boards (DAC write ~0.3ms of it)
+*               Native build (no __AVR__): sample clock from micros() in Service().
+*
+* \par     Editor
+*           17.10.2026 first implementation: timer driven arbitrary waveform player
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_Waveform_H_
+#define _RL021_Waveform_H_
+
+#include "RL021_DigitalLoad.h"
+
+/// Samples of the waveform table (2 x 2 bytes RAM per sample: sample, DAC code)
+#ifndef RL021_WAVE_TABLE_SIZE
+#define RL021_WAVE_TABLE_SIZE       32
+#endif
+/// Sample value of 100% amplitude
+#define RL021_WAVE_FULLSCALE        1000
+/// One DAC write per sample (~0.3ms @100kHz), background acquisition shares the bus
+#define RL021_WAVE_MAX_RATE_HZ      2000
+/// Timer1 16-bit @ 2MHz (prescaler 8) / 250kHz (prescaler 64)
+#define RL021_WAVE_MIN_RATE_HZ      4
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+typedef struct
+{
+    /// samples written to the DAC
+    uint32_t samples;
+    /// sample clock ticks without DAC write (Service() called too late)
+    uint32_t missed;
+    /// time from sample clock tick to DAC written [us]
+    uint16_t latencyMin_us;
+    uint16_t latencyMax_us;
+
+} S_RL021_WaveStatistics;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_Waveform {
+
+ public:
+    RL021_Waveform(RL021_DigitalLoad * newLoad);
+
+    ///////////////////////////////////////////////////////////////
+    /// Table upload: ClearTable(), AddSample() for each sample (not possible while running)
+    void ClearTable();
+    bool AddSample(uint16_t sample);
+    uint8_t GetTableLength();
+
+    /// current = offset_mA + sample * amplitude_mA / RL021_WAVE_FULLSCALE
+    void SetScaling(uint16_t offset_mA, uint16_t amplitude_mA);
+
+    /// Sample rate [Hz] - returns false if out of range
+    bool SetSampleRate(uint16_t rate_Hz);
+
+    /// Number of table repetitions (0: endless)
+    void SetRepeatCount(uint16_t repeats);
+
+    ///////////////////////////////////////////////////////////////
+    /// Precalculate DAC codes and start sample clock - returns false without table or if regulation / CV/CP/CR mode is active
+    bool Start();
+    /// Stop sample clock, load returns to its current setpoint
+    void Stop();
+    bool IsRunning();
+
+    /// Write DAC for the latest sample clock tick - call as often as possible (e.g. every loop()), returns true if DAC was written
+    bool Service();
+
+    /// Timing of the actual / last run (reset by Start())
+    const S_RL021_WaveStatistics * GetStatistics();
+
+    /// Sample clock (Timer1 compare interrupt)
+    void TimerTick();
+
+ private:
+    /// Timer1 CTC with sample period, enable interrupt
+    void StartTimer();
+    void StopTimer();
+
+    RL021_DigitalLoad * load;
+
+    uint16_t table[RL021_WAVE_TABLE_SIZE];
+    uint16_t dacCodes[RL021_WAVE_TABLE_SIZE];
+    uint8_t tableLength;
+
+    uint16_t offset_mA;
+    uint16_t amplitude_mA;
+    uint32_t period_us;
+    uint16_t repeats;
+
+    bool running;
+    /// total samples of the run (0: endless)
+    uint32_t sampleCount;
+    /// sample clock tick of the last DAC write (sample index since Start())
+    uint32_t sampleIndex;
+    uint16_t lastCode;
+
+    /// Sample clock: ticks since Start() and micros() of the last tick (written by interrupt)
+    volatile uint32_t ticks;
+    volatile uint32_t tickTimestamp_us;
+    /// native build: micros() of next sample clock tick
+    uint32_t nextTick_us;
+
+    S_RL021_WaveStatistics statistics;
+};
+
+#endif /* _RL021_Waveform_H_ */
@@ -0,0 +1,294 @@
+#include "Arduino.h"
+
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+
+HardwareSerial Serial;
+
+static uint64_t hostTime_us = 0;
+static bool hostRealtime = false;
+static uint64_t hostWallStart_us = 0;
+
+
+/************************************************************************************************************************************************/
+/* Time
+/************************************************************************************************************************************************/
+static uint64_t WallTime_us()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+uint64_t HostTime_us()
+{
+    return hostTime_us;
+}
+
+/** Advance simulated time
+ *  Realtime: sleep as soon as the simulation is more than 1ms ahead of wall clock time
+ *
+ *  @param uint64_t us -
+ *	@return /
+ */
+void HostAdvance_us(uint64_t us)
+{
+    hostTime_us += us;
+
+    if(hostRealtime)
+    {
+        uint64_t wall_us = WallTime_us() - hostWallStart_us;
+        if(hostTime_us > wall_us + 1000)
+        {
+            usleep(hostTime_us - wall_us);
+        }
+    }
+}
+
+void HostSetRealtime(bool realtime)
+{
+    hostRealtime = realtime;
+    hostWallStart_us = WallTime_us() - hostTime_us;
+}
+
+unsigned long micros()
+{
+    HostAdvance_us(HOST_MICROS_TICK);
+    return (unsigned long)(uint32_t)hostTime_us;
+}
+
+unsigned long millis()
+{
+    HostAdvance_us(HOST_MICROS_TICK);
+    return (unsigned long)(uint32_t)(hostTime_us / 1000);
+}
+
+void delay(unsigned long ms)
+{
+    HostAdvance_us((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    HostAdvance_us(us);
+}
+
+
+/************************************************************************************************************************************************/
+/* Print
+/************************************************************************************************************************************************/
+size_t Print::write(const uint8_t * buffer, size_t size)
+{
+    size_t n = 0;
+    while(size--)
+    {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::write(const char * text)
+{
+    return write((const uint8_t *)text, strlen(text));
+}
+
+size_t Print::print(const char * text)
+{
+    return write(text);
+}
+
+size_t Print::print(const __FlashStringHelper * text)
+{
+    return write(reinterpret_cast<const char *>(text));
+}
+
+size_t Print::print(char value)
+{
+    return write((uint8_t)value);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+    return PrintNumber(value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return PrintNumber(value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+    if(value < 0 && base == DEC)
+    {
+        return write('-') + PrintNumber(-(unsigned long)value, DEC);
+    }
+    return PrintNumber((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    return PrintNumber(value, base);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char text[48];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+size_t Print::PrintNumber(unsigned long value, int base)
+{
+    char text[8 * sizeof(long) + 1];
+    char * digit = &text[sizeof(text) - 1];
+    *digit = '\0';
+
+    if(base < 2)
+    {
+        base = 10;
+    }
+
+    do
+    {
+        char c = value % base;
+        value /= base;
+        *--digit = (c < 10) ? c + '0' : c + 'A' - 10;
+    } while(value);
+
+    return write(digit);
+}
+
+
+/************************************************************************************************************************************************/
+/* Serial
+/************************************************************************************************************************************************/
+void HardwareSerial::begin(unsigned long baud)
+{
+    /// start bit, 8 data bits, stop bit
+    byteTime_us = 10000000UL / baud;
+}
+
+int HardwareSerial::available()
+{
+    Receive();
+    return rxCount;
+}
+
+int HardwareSerial::read()
+{
+    Receive();
+    if(rxCount == 0)
+    {
+        return -1;
+    }
+
+    uint8_t value = rxBuffer[rxHead];
+    rxHead = (rxHead + 1) % HOST_SERIAL_RX_BUFFER;
+    rxCount--;
+    return value;
+}
+
+int HardwareSerial::peek()
+{
+    Receive();
+    return (rxCount == 0) ? -1 : rxBuffer[rxHead];
+}
+
+/** Write byte to stdout
+ *  Transmission time is simulated like the interrupt driven TX buffer of the AVR core:
+ *  write() blocks (simulated time advances) while the buffer is full
+ *
+ *  @param uint8_t value -
+ *	@return size_t - 1
+ */
+size_t HardwareSerial::write(uint8_t value)
+{
+    if(byteTime_us > 0)
+    {
+        uint64_t bufferTime_us = (uint64_t)HOST_SERIAL_TX_BUFFER * byteTime_us;
+        if(txBusyUntil_us > hostTime_us + bufferTime_us)
+        {
+            HostAdvance_us(txBusyUntil_us - bufferTime_us - hostTime_us);
+        }
+        txBusyUntil_us = ((txBusyUntil_us > hostTime_us) ? txBusyUntil_us : hostTime_us) + byteTime_us;
+    }
+
+    fputc(value, stdout);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t * buffer, size_t size)
+{
+    for(size_t i=0;i<size;i++)
+    {
+        write(buffer[i]);
+    }
+    return size;
+}
+
+int HardwareSerial::availableForWrite()
+{
+    if(byteTime_us == 0 || txBusyUntil_us <= hostTime_us)
+    {
+        return HOST_SERIAL_TX_BUFFER;
+    }
+
+    uint64_t queued = (txBusyUntil_us - hostTime_us + byteTime_us - 1) / byteTime_us;
+    return (queued >= HOST_SERIAL_TX_BUFFER) ? 0 : HOST_SERIAL_TX_BUFFER - queued;
+}
+
+void HardwareSerial::flush()
+{
+    if(txBusyUntil_us > hostTime_us)
+    {
+        HostAdvance_us(txBusyUntil_us - hostTime_us);
+    }
+    fflush(stdout);
+}
+
+void HardwareSerial::HostInject(const char * text)
+{
+    while(*text && rxCount < HOST_SERIAL_RX_BUFFER)
+    {
+        rxBuffer[(rxHead + rxCount) % HOST_SERIAL_RX_BUFFER] = *text++;
+        rxCount++;
+    }
+}
+
+/// Read available bytes from stdin (non-blocking)
+void HardwareSerial::Receive()
+{
+    fflush(stdout);
+
+    while(!inputClosed && rxCount < HOST_SERIAL_RX_BUFFER)
+    {
+        struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+        if(poll(&input, 1, 0) <= 0 || !(input.revents & (POLLIN | POLLHUP)))
+        {
+            return;
+        }
+
+        uint8_t value;
+        if(::read(STDIN_FILENO, &value, 1) != 1)
+        {
+            /// EOF: keep running without input
+            inputClosed = true;
+            return;
+        }
+
+        rxBuffer[(rxHead + rxCount) % HOST_SERIAL_RX_BUFFER] = value;
+        rxCount++;
+    }
+}
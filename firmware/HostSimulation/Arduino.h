@@ -0,0 +1,163 @@
+/**
+* \file    Arduino.h
+* \brief    Minimal Arduino core for the native Linux build of DigitalLoadExample (see readme.md)
+* \brief    Required drivers: /
+*
+* \brief    basic functions:
+*               types (byte, boolean), constrain(), min(), max(), PROGMEM access, (no) interrupts
+*               simulated time base: millis(), micros(), delay(), delayMicroseconds()
+*               Serial (stdin / stdout), Print
+*
+*               Time is simulated (HostTime_us()), it only advances by delay(), by micros()/millis() calls
+*               (HOST_MICROS_TICK per call, like the 4us resolution of the AVR), by I2C transfers (Wire.h)
+*               and by blocked serial output. Optionally it is synchronized to wall clock time.
+*
+* \par     Editor
+*           17.10.2026 first implementation: host simulation: minimal Arduino core
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _HOST_Arduino_H_
+#define _HOST_Arduino_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/// Time advance of each micros() / millis() call [us]
+#define HOST_MICROS_TICK        4
+
+/// Serial TX buffer of HardwareSerial (output blocks when full)
+#define HOST_SERIAL_TX_BUFFER   64
+/// Serial RX buffer (input from stdin and injected commands)
+#define HOST_SERIAL_RX_BUFFER   256
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define pgm_read_byte(address)  (*(const uint8_t *)(address))
+#define pgm_read_word(address)  (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+#define memcpy_P(destination, source, size)    memcpy(destination, source, size)
+/// Text in flash (AVR), native build: the text itself, printed by Print::print(const __FlashStringHelper *)
+class __FlashStringHelper;
+#define F(string)               (reinterpret_cast<const __FlashStringHelper *>(string))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+template<class T, class L, class H> T constrain(T value, L low, H high)
+{
+    return (value < low) ? low : ((value > high) ? high : value);
+}
+template<class T, class U> T min(T a, U b)
+{
+    return (a < b) ? a : b;
+}
+template<class T, class U> T max(T a, U b)
+{
+    return (a > b) ? a : b;
+}
+
+/// No interrupts in the native build (timer interrupts are emulated by polling micros())
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+/************************************************************************/
+/* Time                                                                 */
+/************************************************************************/
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+/// Simulated time since start [us] (not wrapped, no tick)
+uint64_t HostTime_us();
+/// Advance simulated time (e.g. by I2C transfers)
+void HostAdvance_us(uint64_t us);
+/// (true): simulated time does not run ahead of wall clock time (interactive use, serial pty)
+void HostSetRealtime(bool realtime);
+
+/************************************************************************/
+/* Print                                                                */
+/************************************************************************/
+class Print {
+
+ public:
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t * buffer, size_t size);
+    size_t write(const char * text);
+
+    size_t print(const char * text);
+    size_t print(const __FlashStringHelper * text);
+    size_t print(char value);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println();
+    template<class T> size_t println(T value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+    template<class T> size_t println(T value, int format)
+    {
+        size_t n = print(value, format);
+        return n + println();
+    }
+
+ private:
+    size_t PrintNumber(unsigned long value, int base);
+};
+
+/************************************************************************/
+/* Serial                                                               */
+/************************************************************************/
+class HardwareSerial : public Print {
+
+ public:
+    void begin(unsigned long baud);
+    operator bool() { return true; }
+
+    /// Input from stdin (non-blocking) and HostInject()
+    int available();
+    int read();
+    int peek();
+
+    /// Output to stdout, each byte takes 10 bit times of the baud rate
+    virtual size_t write(uint8_t value);
+    virtual size_t write(const uint8_t * buffer, size_t size);
+    using Print::write;
+    int availableForWrite();
+    void flush();
+
+    /// Append text to the receive buffer (scripted commands)
+    void HostInject(const char * text);
+
+ private:
+    void Receive();
+
+    unsigned long byteTime_us;
+    uint64_t txBusyUntil_us;
+    bool inputClosed;
+
+    uint8_t rxBuffer[HOST_SERIAL_RX_BUFFER];
+    uint16_t rxHead;
+    uint16_t rxCount;
+};
+
+extern HardwareSerial Serial;
+
+#endif /* _HOST_Arduino_H_ */
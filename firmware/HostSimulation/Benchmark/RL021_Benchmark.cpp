@@ -0,0 +1,637 @@
+/**
+* \file    RL021_Benchmark.cpp
+* \brief    Microbenchmarks of the RL021_DigitalLoad hot paths (native Linux build against the simulated board)
+* \brief    Required drivers: Arduino.h, Wire.h, RL021_SimPlant.h (host), RL021_DigitalLoad.h
+*
+* \brief    report per benchmark:
+*               ns/call         host CPU time per call
+*               I2C trans/bytes transactions and data bytes per call (simulated bus)
+*               bus us          bus time per call (100kHz)
+*               sim us          simulated time per call (incl. ADC conversion time, bus time)
+*               AVR cycles/us   (option -a) estimate for ATmega328 @16MHz: operation counts of the benchmarked
+*                               function x cycles of the avr-gcc runtime routines (AVR_CYCLES_xxx), see S_BENCH_AvrOps.
+*                               Operation counts are maintained by hand, update them when the function changes.
+*
+* \brief    supervisor trip latency (RL021_Supervisor): over-power step of the simulated plant (source voltage
+*               12V -> 24V at 1.5A) at a random phase of the acquisition, tasks like DigitalLoadExample (supervisor
+*               0.5ms priority 0, acquisition 1ms priority 1), all 4 channels acquired
+*               event -> DAC:       step -> DAC 0 received by the simulated DAC (mean / max)
+*               conversion -> DAC:  end of the violating conversion -> DAC 0 (tripLatency_us, max)
+*
+* \brief    LoadGroup rows up to LOAD_BOARDS boards (build with -DLOAD_BOARDS=8 for all rows)
+*
+* \brief    float reference rows are the float implementations replaced by the fixed-point / table versions
+*
+* \par     Editor
+*           17.10.2026 first implementation: microbenchmarks of the RL021_DigitalLoad hot paths
+*
+* \todo
+* \version V0.1
+*/
+
+#include <time.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "RL021_SimPlant.h"
+#include "RL021_DigitalLoad.h"
+#include "RL021_LoadGroup.h"
+#include "RL021_Scheduler.h"
+#include "RL021_Supervisor.h"
+
+/// AVR cycles of avr-gcc runtime routines (ATmega328, hardware multiplier)
+#define AVR_CYCLES_MUL16        10      /// 16x16->32 bit (__umulhisi3)
+#define AVR_CYCLES_MUL32        40      /// 32x32 bit (__mulsi3)
+#define AVR_CYCLES_DIV32        580     /// 32/32 bit (__udivmodsi4)
+#define AVR_CYCLES_FADD         110     /// float add/sub/compare (__addsf3, __cmpsf2)
+#define AVR_CYCLES_FMUL         150     /// float multiply (__mulsf3)
+#define AVR_CYCLES_FDIV         490     /// float divide (__divsf3)
+#define AVR_CYCLES_FCONV        70      /// int <-> float (__floatunsisf, __fixsfsi)
+#define AVR_CYCLES_PGM          5       /// pgm_read_word()
+#define AVR_CLOCK_MHZ           16
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+/// Operations per call of a benchmarked function (AVR estimate)
+typedef struct
+{
+    uint8_t mul16;
+    uint8_t mul32;
+    uint8_t div32;
+    uint8_t fadd;
+    uint8_t fmul;
+    uint8_t fdiv;
+    uint8_t fconv;
+    uint8_t pgm;
+    /// remaining instructions (call, loads, compares, branches)
+    uint16_t base;
+
+} S_BENCH_AvrOps;
+
+typedef struct
+{
+    const char * name;
+    double ns;
+    double transactions;
+    double bytes;
+    double bus_us;
+    double sim_us;
+    /// NULL: no estimate (bus bound, see sim us)
+    const S_BENCH_AvrOps * avr;
+
+} S_BENCH_Result;
+
+
+/// Operation counts (see RL021_DigitalLoad::ApplyFixedPoint(), CalculateTemperature())
+static const S_BENCH_AvrOps AVR_OPS_FIXEDPOINT  = { 1, 1, 0, 0, 0, 0, 0, 0, 40 };
+static const S_BENCH_AvrOps AVR_OPS_TEMPERATURE = { 0, 1, 1, 0, 0, 0, 0, 8, 100 };
+static const S_BENCH_AvrOps AVR_OPS_FLOAT_LINEAR = { 0, 0, 0, 1, 1, 0, 2, 0, 30 };
+static const S_BENCH_AvrOps AVR_OPS_FLOAT_NTC   = { 0, 0, 0, 86, 1, 3, 3, 0, 400 };
+/// Operation counts (see RL021_DigitalLoad::ApplyFilter(), shift 3: 32 bit shifts in base)
+static const S_BENCH_AvrOps AVR_OPS_FILTER_BOXCAR   = { 0, 0, 0, 0, 0, 0, 0, 0, 90 };
+static const S_BENCH_AvrOps AVR_OPS_FILTER_EMA      = { 0, 0, 0, 0, 0, 0, 0, 0, 110 };
+static const S_BENCH_AvrOps AVR_OPS_FILTER_DECIMATE = { 0, 0, 0, 0, 0, 0, 0, 0, 50 };
+/// Operation counts (see RL021_Supervisor::Check(), new conversion: 2 x CalculateValue(), power, SOA, derating,
+/// every call: CalculateDAC(0) of the load-on check)
+static const S_BENCH_AvrOps AVR_OPS_SUPERVISOR_CHECK = { 3, 8, 2, 0, 0, 0, 0, 0, 390 };
+static const S_BENCH_AvrOps AVR_OPS_SUPERVISOR_IDLE  = { 1, 1, 0, 0, 0, 0, 0, 0, 200 };
+
+static bool avrEstimate = false;
+static uint32_t iterationScale = 1;
+
+static RL021_SimPlant plant;
+static SIM_MCP4726 simDAC(0x60, &plant);
+static SIM_MCP3428 simADC(0x68, &plant);
+
+static volatile int32_t sink;
+
+
+/************************************************************************************************************************************************/
+/* Float references
+/************************************************************************************************************************************************/
+/// previous CalculateCurrent() / CalculateVoltage(): slope * adcValue - offset
+static uint16_t FloatLinear(float slope, float offset, uint16_t adcValue)
+{
+    float value = slope * adcValue - offset;
+    return (value < 0) ? 0 : (uint16_t)value;
+}
+
+/// previous CalculateTemperature(): R_T/R_25 and linear scan of the float R/T table
+static int16_t FloatTemperature(uint16_t adcValue)
+{
+    static const float table[42] = {96.158, 66.892, 47.127, 33.606, 24.243, 17.681, 13.032, 9.702, 7.2923, 5.5314,
+                                    4.2325, 3.2657, 2.54, 1.9907, 1.5716, 1.2494, 1.0000, 0.80552, 0.65288, 0.53229,
+                                    0.43645, 0.35981, 0.29819, 0.24837, 0.20787, 0.17479, 0.14763, 0.12523, 0.10667, 0.091227,
+                                    0.078319, 0.067488, 0.058363, 0.050647, 0.044098, 0.03852, 0.033752, 0.029663, 0.026146, 0.023111,
+                                    0.020484, 0.018203};
+
+    float RT_R25 = (adcValue / (32767.0 - adcValue)) * 10000.0 / 10000.0;
+
+    uint8_t entry = 0;
+    for(uint8_t i=0;i<41;i++)
+    {
+        if(RT_R25 < table[i] && RT_R25 > table[i+1])
+        {
+            entry = i;
+        }
+    }
+
+    float faktor = (table[entry] - RT_R25) / (table[entry] - table[entry+1]);
+    float temperature = constrain(-55 + (entry*5) + faktor*5, -55.0f, 150.0f);
+
+    return (int16_t)(temperature * 10);
+}
+
+
+/************************************************************************************************************************************************/
+/* Measurement
+/************************************************************************************************************************************************/
+static uint64_t HostNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/// Start of a benchmark: reset bus statistics, remember times
+static uint64_t startNs;
+static uint64_t startSim_us;
+
+static void Begin()
+{
+    Wire.HostResetStatistics();
+    startSim_us = HostTime_us();
+    startNs = HostNs();
+}
+
+static S_BENCH_Result End(const char * name, uint32_t calls, const S_BENCH_AvrOps * avr)
+{
+    S_BENCH_Result result;
+    const S_WIRE_Statistics * statistics = Wire.HostStatistics();
+
+    result.ns = (double)(HostNs() - startNs) / calls;
+    result.name = name;
+    result.transactions = (double)statistics->transactions / calls;
+    result.bytes = (double)(statistics->bytesWritten + statistics->bytesRead) / calls;
+    result.bus_us = (double)statistics->busTime_us / calls;
+    result.sim_us = (double)(HostTime_us() - startSim_us) / calls;
+    result.avr = avr;
+
+    return result;
+}
+
+static uint32_t AvrCycles(const S_BENCH_AvrOps * ops)
+{
+    return ops->mul16 * AVR_CYCLES_MUL16 + ops->mul32 * AVR_CYCLES_MUL32 + ops->div32 * AVR_CYCLES_DIV32 +
+           ops->fadd * AVR_CYCLES_FADD + ops->fmul * AVR_CYCLES_FMUL + ops->fdiv * AVR_CYCLES_FDIV +
+           ops->fconv * AVR_CYCLES_FCONV + ops->pgm * AVR_CYCLES_PGM + ops->base;
+}
+
+static void Print(const S_BENCH_Result * result)
+{
+    printf("%-34s %10.1f %8.2f %8.2f %10.1f %10.1f", result->name, result->ns, result->transactions,
+           result->bytes, result->bus_us, result->sim_us);
+
+    if(avrEstimate && result->avr != NULL)
+    {
+        uint32_t cycles = AvrCycles(result->avr);
+        printf(" %10u %8.1f", cycles, (double)cycles / AVR_CLOCK_MHZ);
+    }
+    printf("\n");
+}
+
+
+/************************************************************************************************************************************************/
+/* Benchmarks
+/************************************************************************************************************************************************/
+static void BenchmarkTransferFunctions(RL021_DigitalLoad * load)
+{
+    uint32_t calls = 1000000 * iterationScale;
+    S_BENCH_Result result;
+
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        sink = load->CalculateDAC(i & 0x1FFF);
+    }
+    result = End("CalculateDAC", calls, &AVR_OPS_FIXEDPOINT);
+    Print(&result);
+
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        sink = load->CalculateCurrent(i & 0x7FFF);
+    }
+    result = End("CalculateCurrent", calls, &AVR_OPS_FIXEDPOINT);
+    Print(&result);
+
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        sink = load->CalculateVoltage(i & 0x7FFF, ADC_CH_VLOAD);
+    }
+    result = End("CalculateVoltage", calls, &AVR_OPS_FIXEDPOINT);
+    Print(&result);
+
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        sink = load->CalculateTemperature(i & 0x7FFF);
+    }
+    result = End("CalculateTemperature", calls, &AVR_OPS_TEMPERATURE);
+    Print(&result);
+
+    /// Channel filters (length 8), one call per conversion
+    static const E_RL021_FILTER filters[3] = {FILTER_BOXCAR, FILTER_EMA, FILTER_DECIMATE};
+    static const char * filterNames[3] = {"ApplyFilter (boxcar 8)", "ApplyFilter (EMA 1/8)", "ApplyFilter (decimate 8)"};
+    static const S_BENCH_AvrOps * filterOps[3] = {&AVR_OPS_FILTER_BOXCAR, &AVR_OPS_FILTER_EMA, &AVR_OPS_FILTER_DECIMATE};
+    for(uint8_t f=0;f<3;f++)
+    {
+        S_RL021_Filter filter;
+        memset(&filter, 0, sizeof(filter));
+        filter.type = filters[f];
+        filter.shift = 3;
+
+        Begin();
+        for(uint32_t i=0;i<calls;i++)
+        {
+            RL021_DigitalLoad::ApplyFilter(&filter, i & 0x7FFF);
+            sink = filter.output;
+        }
+        result = End(filterNames[f], calls, filterOps[f]);
+        Print(&result);
+    }
+
+    float slope = load->calibrationData.slope_adc[RANGE_DAC_HIGH][ADC_CH_CURRENT];
+    float offset = load->calibrationData.offset_adc[RANGE_DAC_HIGH][ADC_CH_CURRENT];
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        sink = FloatLinear(slope, offset, i & 0x7FFF);
+    }
+    result = End("float reference: CalculateCurrent", calls, &AVR_OPS_FLOAT_LINEAR);
+    Print(&result);
+
+    Begin();
+    for(uint32_t i=0;i<calls / 10;i++)
+    {
+        sink = FloatTemperature(i & 0x7FFF);
+    }
+    result = End("float reference: Temperature", calls / 10, &AVR_OPS_FLOAT_NTC);
+    Print(&result);
+}
+
+static void BenchmarkBus(RL021_DigitalLoad * load, MCP47x6base * dac, MCP3428 * adc, I2C_Engine * engine)
+{
+    uint32_t calls = 200 * iterationScale;
+    S_BENCH_Result result;
+
+    /// Blocking conversions (no engine)
+    static const uint8_t resolutions[3] = {16, 14, 12};
+    static const char * names[3] = {"GetRawAdc (16-bit)", "GetRawAdc (14-bit)", "GetRawAdc (12-bit)"};
+    for(uint8_t r=0;r<3;r++)
+    {
+        load->SetAdcResolution(resolutions[r]);
+        Begin();
+        for(uint32_t i=0;i<calls;i++)
+        {
+            sink = load->GetRawAdc((E_ADC_CHANNEL)(i % ADC_CH_LAST));
+        }
+        result = End(names[r], calls, NULL);
+        Print(&result);
+    }
+
+    /// DAC write, first write includes the command byte
+    calls = 10000 * iterationScale;
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        load->SetCurrent_mA(i % 5000);
+    }
+    result = End("SetCurrent_mA", calls, NULL);
+    Print(&result);
+
+    /// Unchanged setpoint: write is skipped by the driver
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        load->SetCurrent_mA(1000);
+    }
+    result = End("SetCurrent_mA (unchanged)", calls, NULL);
+    Print(&result);
+
+    /// Burst of fast writes, result per DAC value
+    uint16_t ramp[64];
+    for(uint8_t i=0;i<64;i++)
+    {
+        ramp[i] = i * 64;
+    }
+    static const uint32_t clocks[2] = {100000, 400000};
+    static const char * burstNames[2] = {"SetRawDacBurst (per value)", "SetRawDacBurst 400kHz"};
+    for(uint8_t c=0;c<2;c++)
+    {
+        Wire.setClock(clocks[c]);
+        Begin();
+        for(uint32_t i=0;i<calls / 64;i++)
+        {
+            load->SetRawDacBurst(ramp, 64);
+        }
+        result = End(burstNames[c], (calls / 64) * 64, NULL);
+        Print(&result);
+    }
+    Wire.setClock(100000);
+
+    /// Queued via I2C_Engine
+    dac->attachEngine(engine);
+    adc->AttachEngine(engine);
+
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        load->SetCurrent_mA(i % 5000);
+        engine->Flush();
+    }
+    result = End("SetCurrent_mA (I2C_Engine)", calls, NULL);
+    Print(&result);
+
+    /// Background acquisition of all channels (12-bit): bus use per conversion
+    calls = 1000 * iterationScale;
+    load->SetAdcResolution(12);
+    load->StartAcquisition();
+    uint32_t conversions = simADC.conversions;
+    Begin();
+    while(simADC.conversions - conversions < calls)
+    {
+        load->Service();
+        engine->Service();
+        delayMicroseconds(100);
+    }
+    result = End("Service (per conversion)", calls, NULL);
+    Print(&result);
+
+    Begin();
+    for(uint32_t i=0;i<calls * 100;i++)
+    {
+        sink = load->GetMeasurement((E_ADC_CHANNEL)(i % ADC_CH_LAST))->value;
+    }
+    result = End("GetMeasurement (cached)", calls * 100, NULL);
+    Print(&result);
+
+    load->StopAcquisition();
+    engine->Flush();
+
+    dac->attachEngine(NULL);
+    adc->AttachEngine(NULL);
+}
+
+
+/// Several boards on one bus (12-bit): per measurement, sim us = 1/throughput of the group (1 ... LOAD_BOARDS boards)
+static void BenchmarkGroup(RL021_DigitalLoad * load)
+{
+    static RL021_SimPlant groupPlants[RL021_GROUP_MAX_BOARDS - 1];
+    static const char * names[4] = {"LoadGroup 1 board (per meas.)", "LoadGroup 2 boards (per meas.)",
+                                    "LoadGroup 4 boards (per meas.)", "LoadGroup 8 boards (per meas.)"};
+    RL021_DigitalLoad * loads[RL021_GROUP_MAX_BOARDS];
+    uint32_t calls = 1000 * iterationScale;
+    S_BENCH_Result result;
+
+    loads[0] = load;
+    for(uint8_t n=1;n<LOAD_BOARDS;n++)
+    {
+        Wire.HostAttach(new SIM_MCP4726(0x60 + n, &groupPlants[n-1]));
+        Wire.HostAttach(new SIM_MCP3428(0x68 + n, &groupPlants[n-1]));
+        loads[n] = new RL021_DigitalLoad(new MCP4726(0x60 + n), new MCP3428(n));
+        loads[n]->SetJumperSetting(JP2_CURRENT, Jumper_Closed);
+    }
+
+    for(uint8_t b=0;b<4 && (1<<b)<=LOAD_BOARDS;b++)
+    {
+        I2C_Engine engine;
+        RL021_LoadGroup group(&engine);
+
+        for(uint8_t n=0;n<(1<<b);n++)
+        {
+            loads[n]->SetAdcResolution(12);
+            group.AddBoard(loads[n]);
+        }
+        group.StartAcquisition();
+
+        /// settle: all boards started
+        uint32_t start_us = micros();
+        while(micros() - start_us < 10000)
+        {
+            group.Service();
+        }
+
+        group.ResetMeasurementCount();
+        Begin();
+        while(group.GetMeasurementCount() < calls)
+        {
+            group.Service();
+        }
+        result = End(names[b], group.GetMeasurementCount(), NULL);
+        Print(&result);
+
+        /// 4 boards: synchronized capture of the current (general call), per snapshot
+        if(b == 2)
+        {
+            static const uint32_t clocks[2] = {100000, 400000};
+            static const char * syncNames[2] = {"LoadGroup 4 boards sync (per snap.)", "LoadGroup 4 boards sync 400kHz"};
+            for(uint8_t c=0;c<2;c++)
+            {
+                Wire.setClock(clocks[c]);
+                group.StartSyncCapture(1<<ADC_CH_CURRENT);
+                while(group.GetSnapshotCount() < 2)
+                {
+                    group.Service();
+                }
+
+                uint32_t snapshots = group.GetSnapshotCount();
+                Begin();
+                while(group.GetSnapshotCount() - snapshots < calls / 4)
+                {
+                    group.Service();
+                }
+                result = End(syncNames[c], group.GetSnapshotCount() - snapshots, NULL);
+                Print(&result);
+            }
+            Wire.setClock(100000);
+        }
+
+        group.StopAcquisition();
+        engine.Flush();
+        for(uint8_t n=0;n<(1<<b);n++)
+        {
+            loads[n]->deviceDAC->attachEngine(NULL);
+            loads[n]->deviceADC->AttachEngine(NULL);
+        }
+    }
+}
+
+
+/// Tasks of the supervisor latency benchmark
+static RL021_LoadGroup * supervisedGroup;
+static RL021_Supervisor * benchSupervisor;
+
+static void BenchTaskSupervisor()
+{
+    benchSupervisor->Service();
+}
+
+static void BenchTaskAcquisition()
+{
+    supervisedGroup->Service();
+}
+
+/// Check of cached measurements (per board) and trip latency under the simulated plant
+static void BenchmarkSupervisor(RL021_DigitalLoad * load)
+{
+    uint32_t calls = 1000000 * iterationScale;
+    S_BENCH_Result result;
+    I2C_Engine engine;
+    RL021_LoadGroup group(&engine);
+    RL021_Supervisor supervisor;
+
+    group.AddBoard(load);
+    supervisor.AddBoard(load);
+    supervisedGroup = &group;
+    benchSupervisor = &supervisor;
+
+    /// Check with a new conversion on every call (timestamp changed, no trip)
+    load->SetAdcResolution(12);
+    load->SetCurrent_mA(1000);
+    group.StartAcquisition();
+    while(!load->measurement[ADC_CH_NTC].valid)
+    {
+        group.Service();
+    }
+
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        load->measurement[ADC_CH_CURRENT].timestamp_us++;
+        sink = supervisor.Service();
+    }
+    result = End("Supervisor Service (new conv.)", calls, &AVR_OPS_SUPERVISOR_CHECK);
+    Print(&result);
+
+    Begin();
+    for(uint32_t i=0;i<calls;i++)
+    {
+        sink = supervisor.Service();
+    }
+    result = End("Supervisor Service (no new conv.)", calls, &AVR_OPS_SUPERVISOR_IDLE);
+    Print(&result);
+
+    /// Trip latency: tasks like the sketch
+    RL021_Scheduler scheduler;
+    scheduler.AddTask("supervisor", BenchTaskSupervisor, 500, 0);
+    scheduler.AddTask("acquisition", BenchTaskAcquisition, 1000, 1);
+    scheduler.Start();
+
+    static const uint8_t resolutions[2] = {12, 16};
+    uint32_t random = 12345;
+
+    printf("\n%-34s %8s %10s %10s %12s\n", "supervisor trip (over-power step)", "trips", "event avg", "event max", "conv. max");
+    for(uint8_t r=0;r<2;r++)
+    {
+        uint32_t trips = ((resolutions[r] == 12) ? 50 : 10) * iterationScale;
+        uint64_t sum_us = 0;
+        uint64_t max_us = 0;
+        uint32_t conversionMax_us = 0;
+
+        load->SetAdcResolution(resolutions[r]);
+        group.StartAcquisition();
+
+        for(uint32_t t=0;t<trips;t++)
+        {
+            /// Normal operation, event at a random phase of the acquisition (min. 2 channel rounds settled)
+            plant.parameters.sourceVoltage_V = 12.0;
+            supervisor.ClearFaults(0);
+            load->SetCurrent_mA(1500);
+            random = random * 1103515245 + 12345;
+            uint64_t event_us = HostTime_us() + (resolutions[r] == 12 ? 40000 : 600000) + (random >> 8) % 100000;
+            while(HostTime_us() < event_us)
+            {
+                scheduler.Run();
+            }
+
+            plant.parameters.sourceVoltage_V = 24.0;
+            event_us = HostTime_us();
+            while(plant.GetDacCode() != 0 && HostTime_us() - event_us < 2000000)
+            {
+                scheduler.Run();
+            }
+
+            uint64_t latency_us = HostTime_us() - event_us;
+            sum_us += latency_us;
+            max_us = max(max_us, latency_us);
+            conversionMax_us = max(conversionMax_us, supervisor.GetStatus(0)->tripLatency_us);
+        }
+
+        char name[40];
+        snprintf(name, sizeof(name), "%u-bit, 4 channels [us]", resolutions[r]);
+        printf("%-34s %8u %10.0f %10.0f %12u\n", name, trips, (double)sum_us / trips, (double)max_us, conversionMax_us);
+    }
+
+    plant.parameters.sourceVoltage_V = 12.0;
+    supervisor.ClearFaults(0);
+    group.StopAcquisition();
+    engine.Flush();
+    load->deviceDAC->attachEngine(NULL);
+    load->deviceADC->AttachEngine(NULL);
+}
+
+
+static void PrintUsage(const char * name)
+{
+    fprintf(stderr, "usage: %s [-a] [-n <scale>]\n"
+                    "  -a          AVR cycle estimate (ATmega328 @16MHz)\n"
+                    "  -n <scale>  multiply iterations\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    int option;
+
+    while((option = getopt(argc, argv, "an:h")) != -1)
+    {
+        switch(option)
+        {
+            case 'a':
+                avrEstimate = true;
+                break;
+            case 'n':
+                iterationScale = atoi(optarg) > 0 ? atoi(optarg) : 1;
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    Wire.HostAttach(&simDAC);
+    Wire.HostAttach(&simADC);
+
+    MCP4726 dac;
+    MCP3428 adc(0);
+    I2C_Engine engine;
+    RL021_DigitalLoad load(&dac, &adc);
+    load.SetJumperSetting(JP2_CURRENT, Jumper_Closed);
+
+    printf("%-34s %10s %8s %8s %10s %10s", "benchmark", "ns/call", "I2C tr", "I2C B", "bus us", "sim us");
+    if(avrEstimate)
+    {
+        printf(" %10s %8s", "AVR cyc", "AVR us");
+    }
+    printf("\n");
+
+    BenchmarkTransferFunctions(&load);
+    BenchmarkBus(&load, &dac, &adc, &engine);
+    BenchmarkGroup(&load);
+    BenchmarkSupervisor(&load);
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+EEPROMClass::EEPROMClass()
+{
+    memset(memory, 0xFF, sizeof(memory));
+    file = NULL;
+    writes = 0;
+}
+
+/************************************************************************************************************************************************/
+/* Public - EEPROM interface
+/************************************************************************************************************************************************/
+uint8_t EEPROMClass::read(int address)
+{
+    return (address >= 0 && address < HOST_EEPROM_SIZE) ? memory[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    if(address < 0 || address >= HOST_EEPROM_SIZE)
+    {
+        return;
+    }
+
+    memory[address] = value;
+    writes++;
+
+    if(file != NULL)
+    {
+        fseek(file, address, SEEK_SET);
+        fputc(value, file);
+        fflush(file);
+    }
+}
+
+void EEPROMClass::update(int address, uint8_t value)
+{
+    if(read(address) != value)
+    {
+        write(address, value);
+    }
+}
+
+uint16_t EEPROMClass::length()
+{
+    return HOST_EEPROM_SIZE;
+}
+
+/************************************************************************************************************************************************/
+/* Public - host
+/************************************************************************************************************************************************/
+/** Use image file as EEPROM content: a short or missing file is filled up with erased bytes
+ *
+ *  @param const char * path -
+ *	@return bool - (false): file cannot be opened / created
+ */
+bool EEPROMClass::HostAttachFile(const char * path)
+{
+    file = fopen(path, "r+b");
+    if(file == NULL)
+    {
+        file = fopen(path, "w+b");
+        if(file == NULL)
+        {
+            return false;
+        }
+    }
+
+    memset(memory, 0xFF, sizeof(memory));
+    size_t bytes = fread(memory, 1, sizeof(memory), file);
+
+    if(bytes < sizeof(memory))
+    {
+        fseek(file, bytes, SEEK_SET);
+        fwrite(&memory[bytes], 1, sizeof(memory) - bytes, file);
+        fflush(file);
+    }
+    return true;
+}
+
+uint32_t EEPROMClass::HostGetWrites()
+{
+    return writes;
+}
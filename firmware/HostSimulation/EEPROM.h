@@ -0,0 +1,79 @@
+/**
+* \file    EEPROM.h
+* \brief    Simulated EEPROM of the ATmega328 for the native Linux build (same interface as the Arduino EEPROM library)
+* \brief    Required drivers: Arduino.h (host)
+*
+* \brief    basic functions:
+*               HOST_EEPROM_SIZE bytes, erased state 0xFF
+*               read(), write(), update() (write only if changed), get() / put() of a whole object
+*               optional image file (HostAttachFile()): loaded once, every changed byte is written through,
+*               the content survives a restart of the simulation like the EEPROM survives a reset
+*               write statistics (changed bytes) for wear estimation
+*
+* \par     Editor
+*           17.10.2026 first implementation: host simulation: EEPROM
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _HOST_EEPROM_H_
+#define _HOST_EEPROM_H_
+
+#include "Arduino.h"
+
+/// EEPROM of the ATmega328 [bytes]
+#define HOST_EEPROM_SIZE        1024
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class EEPROMClass {
+
+ public:
+    EEPROMClass();
+
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    /// Write only if the value differs (no erase/write cycle for unchanged bytes)
+    void update(int address, uint8_t value);
+    uint16_t length();
+
+    template<class T> T & get(int address, T & object)
+    {
+        uint8_t * data = (uint8_t *)&object;
+        for(uint16_t i=0;i<sizeof(T);i++)
+        {
+            data[i] = read(address + i);
+        }
+        return object;
+    }
+
+    /// Like the Arduino library: update() of every byte
+    template<class T> const T & put(int address, const T & object)
+    {
+        const uint8_t * data = (const uint8_t *)&object;
+        for(uint16_t i=0;i<sizeof(T);i++)
+        {
+            update(address + i, data[i]);
+        }
+        return object;
+    }
+
+    ///////////////////////////////////////////////////////////////
+    /// Host only
+    /// Image file: content is loaded (missing file: erased EEPROM), writes are passed through - returns false on error
+    bool HostAttachFile(const char * path);
+    /// Bytes written since start (update() without change is not counted)
+    uint32_t HostGetWrites();
+
+ private:
+    uint8_t memory[HOST_EEPROM_SIZE];
+    FILE * file;
+    uint32_t writes;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif /* _HOST_EEPROM_H_ */
@@ -0,0 +1,194 @@
+/**
+* \file    HostMain.cpp
+* \brief    Native Linux build of DigitalLoadExample: sketch setup()/loop() against the simulated board (RL021_SimPlant)
+* \brief    Required drivers: Arduino.h, Wire.h, EEPROM.h (host), RL021_SimPlant.h, DigitalLoadExample.ino
+*
+* \brief    usage: see readme.md
+*
+* \par     Editor
+*           17.10.2026 first implementation: host simulation: main(), scripted serial commands, plant log
+*
+* \todo
+* \version V0.1
+*/
+
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "EEPROM.h"
+#include "RL021_SimPlant.h"
+
+/// Sketch (setup(), loop() and its global objects)
+#include "../DigitalLoadExample/DigitalLoadExample.ino"
+
+/// max. number of scripted commands (-c)
+#define HOST_MAX_COMMANDS   32
+
+typedef struct
+{
+    uint64_t time_us;
+    const char * text;
+
+} S_HOST_Command;
+
+
+RL021_SimPlant simPlant;
+SIM_MCP4726 simDAC(0x60, &simPlant);
+SIM_MCP3428 simADC(0x68, &simPlant);
+
+/// Boards 1 ... LOAD_BOARDS-1 of the sketch (build with -DLOAD_BOARDS=n), same parameters as board 0
+RL021_SimPlant * boardPlants[LOAD_BOARDS];
+
+
+static void PrintUsage(const char * name)
+{
+    fprintf(stderr, "usage: %s [options]\n"
+                    "  -t <s>          run time (simulated seconds, default: endless)\n"
+                    "  -x              realtime (simulated time follows wall clock)\n"
+                    "  -c <ms>:<text>  send <text> to Serial at <ms> (repeatable)\n"
+                    "  -l <ms>         log plant state to stderr every <ms> (CSV)\n"
+                    "  -P <file>       EEPROM image (loaded at start, written through, default: erased EEPROM)\n"
+                    "  -V <V>          source voltage (default 12)\n"
+                    "  -R <Ohm>        source internal resistance (default 0.1)\n"
+                    "  -B <mAh>        source is a battery with this capacity (default 0: ideal source)\n"
+                    "  -U <V>          battery voltage at full discharge (default 9)\n"
+                    "  -E <V>          external voltage input (default 5)\n"
+                    "  -A <C>          ambient temperature (default 25)\n"
+                    "  -H <K/W>        heatsink thermal resistance (default 1.5)\n"
+                    "  -T <s>          heatsink thermal time constant (default 60)\n"
+                    "  -S <factor>     ADC conversion time factor (default 1.0)\n"
+                    "  -N <uV>         ADC input noise, peak (default 0)\n"
+                    "  -G <ppm>        ADC gain error of PGA x2 / x4 / x8 relative to x1 (default 0)\n", name);
+}
+
+int main(int argc, char ** argv)
+{
+    S_HOST_Command commands[HOST_MAX_COMMANDS];
+    uint8_t commandCount = 0;
+    uint64_t runTime_us = 0;
+    uint64_t logPeriod_us = 0;
+    bool realtime = false;
+    int option;
+
+    while((option = getopt(argc, argv, "t:xc:l:P:V:R:B:U:E:A:H:T:S:N:G:h")) != -1)
+    {
+        switch(option)
+        {
+            case 't':
+                runTime_us = (uint64_t)(atof(optarg) * 1e6);
+                break;
+            case 'x':
+                realtime = true;
+                break;
+            case 'c':
+            {
+                const char * separator = strchr(optarg, ':');
+                if(separator == NULL || commandCount >= HOST_MAX_COMMANDS)
+                {
+                    PrintUsage(argv[0]);
+                    return 1;
+                }
+                commands[commandCount].time_us = (uint64_t)(atof(optarg) * 1000);
+                commands[commandCount].text = separator + 1;
+                commandCount++;
+                break;
+            }
+            case 'l':
+                logPeriod_us = (uint64_t)(atof(optarg) * 1000);
+                break;
+            case 'P':
+                if(!EEPROM.HostAttachFile(optarg))
+                {
+                    fprintf(stderr, "cannot open EEPROM image %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'V':
+                simPlant.parameters.sourceVoltage_V = atof(optarg);
+                break;
+            case 'R':
+                simPlant.parameters.sourceResistance_Ohm = atof(optarg);
+                break;
+            case 'B':
+                simPlant.parameters.batteryCapacity_mAh = atof(optarg);
+                break;
+            case 'U':
+                simPlant.parameters.batteryEmptyVoltage_V = atof(optarg);
+                break;
+            case 'E':
+                simPlant.parameters.externalVoltage_V = atof(optarg);
+                break;
+            case 'A':
+                simPlant.parameters.ambient_C = atof(optarg);
+                break;
+            case 'H':
+                simPlant.parameters.thermalResistance_KW = atof(optarg);
+                break;
+            case 'T':
+                simPlant.parameters.thermalTimeConstant_s = atof(optarg);
+                break;
+            case 'S':
+                simPlant.parameters.adcClockScale = atof(optarg);
+                break;
+            case 'N':
+                simPlant.parameters.adcNoise_uV = atof(optarg);
+                break;
+            case 'G':
+                simPlant.parameters.adcPgaGainError_ppm = atof(optarg);
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    /// heatsink starts at ambient temperature
+    simPlant.Reset();
+
+    Wire.HostAttach(&simDAC);
+    Wire.HostAttach(&simADC);
+
+    for(uint8_t n=1;n<LOAD_BOARDS;n++)
+    {
+        boardPlants[n] = new RL021_SimPlant();
+        boardPlants[n]->parameters = simPlant.parameters;
+        boardPlants[n]->Reset();
+        Wire.HostAttach(new SIM_MCP4726(0x60 + n, boardPlants[n]));
+        Wire.HostAttach(new SIM_MCP3428(0x68 + n, boardPlants[n]));
+    }
+    HostSetRealtime(realtime);
+
+    if(logPeriod_us > 0)
+    {
+        fprintf(stderr, "time_ms,dac,current_mA,vload_mV,temperature_C\n");
+    }
+
+    setup();
+    uint64_t nextLog_us = HostTime_us();
+
+    while(runTime_us == 0 || HostTime_us() < runTime_us)
+    {
+        for(uint8_t i=0;i<commandCount;i++)
+        {
+            if(commands[i].text != NULL && HostTime_us() >= commands[i].time_us)
+            {
+                Serial.HostInject(commands[i].text);
+                commands[i].text = NULL;
+            }
+        }
+
+        loop();
+
+        if(logPeriod_us > 0 && HostTime_us() >= nextLog_us)
+        {
+            simPlant.Update();
+            fprintf(stderr, "%.3f,%u,%.1f,%.1f,%.2f\n", HostTime_us() / 1000.0, simPlant.GetDacCode(),
+                    simPlant.GetCurrent_mA(), simPlant.GetLoadVoltage_mV(), simPlant.GetTemperature_C());
+            nextLog_us += logPeriod_us;
+        }
+    }
+
+    Serial.flush();
+    return 0;
+}
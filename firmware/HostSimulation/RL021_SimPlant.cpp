@@ -0,0 +1,454 @@
+#include "RL021_SimPlant.h"
+
+/// 16-bit ADC: 2.048V / 32768
+#define SIM_ADC_LSB16_V     (2.048 / 32768.0)
+
+/// NTC B57421V2103 and pull-up
+#define SIM_NTC_R25         10000.0
+#define SIM_NTC_B           4000.0
+#define SIM_NTC_PULLUP      10000.0
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_SimPlant::RL021_SimPlant()
+{
+    parameters.sourceVoltage_V = 12.0;
+    parameters.sourceResistance_Ohm = 0.1;
+    parameters.minResistance_Ohm = 0.15;
+    parameters.externalVoltage_V = 5.0;
+    parameters.currentTimeConstant_us = 50.0;
+
+    parameters.batteryCapacity_mAh = 0;
+    parameters.batteryEmptyVoltage_V = 9.0;
+
+    parameters.ambient_C = 25.0;
+    parameters.thermalResistance_KW = 1.5;
+    parameters.thermalTimeConstant_s = 60.0;
+
+    parameters.adcClockScale = 1.0;
+    parameters.adcNoise_uV = 0.0;
+    parameters.adcPgaGainError_ppm = 0.0;
+
+    /// theoretical board values (like RL021_DigitalLoad::SetDefaultCalibration())
+    parameters.board.slope_dac[RANGE_DAC_LOW] = 1000.0/4095;
+    parameters.board.offset_dac[RANGE_DAC_LOW] = 2;
+    parameters.board.slope_dac[RANGE_DAC_HIGH] = 400.0/165;
+    parameters.board.offset_dac[RANGE_DAC_HIGH] = -11;
+
+    parameters.board.slope_adc[RANGE_DAC_HIGH][ADC_CH_CURRENT] = 400.0/1318;
+    parameters.board.offset_adc[RANGE_DAC_HIGH][ADC_CH_CURRENT] = 0;
+    parameters.board.slope_adc[RANGE_DAC_LOW][ADC_CH_CURRENT] = 1000.0/32767;
+    parameters.board.offset_adc[RANGE_DAC_LOW][ADC_CH_CURRENT] = 0;
+
+    parameters.board.slope_adc[RANGE_ADC_HIGH][ADC_CH_VLOAD] = 10000.0/13262;
+    parameters.board.offset_adc[RANGE_ADC_HIGH][ADC_CH_VLOAD] = 4;
+    parameters.board.slope_adc[RANGE_ADC_LOW][ADC_CH_VLOAD] = 4000.0/32767;
+    parameters.board.offset_adc[RANGE_ADC_LOW][ADC_CH_VLOAD] = 5;
+
+    parameters.board.slope_adc[RANGE_ADC_HIGH][ADC_CH_VEXT] = 24000.0/32767;
+    parameters.board.offset_adc[RANGE_ADC_HIGH][ADC_CH_VEXT] = 2;
+    parameters.board.slope_adc[RANGE_ADC_LOW][ADC_CH_VEXT] = 4000.0/32767;
+    parameters.board.offset_adc[RANGE_ADC_LOW][ADC_CH_VEXT] = 2;
+
+    /// jumpers like in DigitalLoadExample setup()
+    parameters.highRangeSelected_current = true;
+    parameters.lowRangeSelected_Vload = false;
+    parameters.lowRangeSelected_Vext = false;
+
+    noiseState = 1;
+    Reset();
+}
+
+/************************************************************************************************************************************************/
+/* Public - model
+/************************************************************************************************************************************************/
+void RL021_SimPlant::Reset()
+{
+    dacCode = 0;
+    current_mA = 0;
+    temperature_C = parameters.ambient_C;
+    discharged_mAh = 0;
+    lastUpdate_us = HostTime_us();
+}
+
+/** Integrate current loop and thermal model from last update to actual simulated time
+ *  (input constant during the step: exact solution of the first order systems)
+ *
+ *  @param /
+ *	@return /
+ */
+void RL021_SimPlant::Update()
+{
+    uint64_t now_us = HostTime_us();
+    float dt_us = (float)(now_us - lastUpdate_us);
+    lastUpdate_us = now_us;
+
+    if(dt_us <= 0)
+    {
+        return;
+    }
+
+    /// Current loop
+    uint8_t range = parameters.highRangeSelected_current;
+    float setpoint_mA = dacCode * parameters.board.slope_dac[range] + parameters.board.offset_dac[range];
+    float limit_mA = 1000.0 * GetSourceVoltage_V() / (parameters.sourceResistance_Ohm + parameters.minResistance_Ohm);
+    setpoint_mA = constrain(setpoint_mA, 0.0f, limit_mA);
+
+    current_mA += (setpoint_mA - current_mA) * (1.0 - exp(-dt_us / parameters.currentTimeConstant_us));
+    discharged_mAh += current_mA * dt_us / 3.6e9;
+
+    /// Heatsink
+    float power_W = GetLoadVoltage_mV() * current_mA / 1e6;
+    float target_C = parameters.ambient_C + power_W * parameters.thermalResistance_KW;
+
+    temperature_C += (target_C - temperature_C) * (1.0 - exp(-dt_us / (parameters.thermalTimeConstant_s * 1e6)));
+}
+
+void RL021_SimPlant::SetDacCode(uint16_t code)
+{
+    /// state up to now with previous output
+    Update();
+    dacCode = code & 0x0FFF;
+}
+
+uint16_t RL021_SimPlant::GetDacCode()
+{
+    return dacCode;
+}
+
+float RL021_SimPlant::GetCurrent_mA()
+{
+    return current_mA;
+}
+
+float RL021_SimPlant::GetLoadVoltage_mV()
+{
+    return 1000.0 * GetSourceVoltage_V() - current_mA * parameters.sourceResistance_Ohm;
+}
+
+float RL021_SimPlant::GetSourceVoltage_V()
+{
+    if(parameters.batteryCapacity_mAh <= 0)
+    {
+        return parameters.sourceVoltage_V;
+    }
+
+    float discharged = discharged_mAh / parameters.batteryCapacity_mAh;
+    if(discharged <= 1.0)
+    {
+        return parameters.sourceVoltage_V - (parameters.sourceVoltage_V - parameters.batteryEmptyVoltage_V) * discharged;
+    }
+    return max(0.0f, parameters.batteryEmptyVoltage_V * (1.0f - 10.0f * (discharged - 1.0f)));
+}
+
+float RL021_SimPlant::GetDischarged_mAh()
+{
+    return discharged_mAh;
+}
+
+float RL021_SimPlant::GetTemperature_C()
+{
+    return temperature_C;
+}
+
+/** Voltage at the ADC input: inverse of the board's ADC transfer function (value = slope * code16 - offset)
+ *
+ *  @param E_ADC_CHANNEL channel -
+ *	@return float - [V]
+ */
+float RL021_SimPlant::GetAdcInput_V(E_ADC_CHANNEL channel)
+{
+    float code16 = 0;
+
+    Update();
+
+    switch(channel)
+    {
+        case ADC_CH_CURRENT:
+        {
+            uint8_t range = parameters.highRangeSelected_current;
+            code16 = (current_mA + parameters.board.offset_adc[range][ADC_CH_CURRENT]) / parameters.board.slope_adc[range][ADC_CH_CURRENT];
+            break;
+        }
+        case ADC_CH_VLOAD:
+        {
+            uint8_t range = parameters.lowRangeSelected_Vload;
+            code16 = (GetLoadVoltage_mV() + parameters.board.offset_adc[range][ADC_CH_VLOAD]) / parameters.board.slope_adc[range][ADC_CH_VLOAD];
+            break;
+        }
+        case ADC_CH_VEXT:
+        {
+            uint8_t range = parameters.lowRangeSelected_Vext;
+            code16 = (1000.0 * parameters.externalVoltage_V + parameters.board.offset_adc[range][ADC_CH_VEXT]) / parameters.board.slope_adc[range][ADC_CH_VEXT];
+            break;
+        }
+        case ADC_CH_NTC:
+        {
+            float resistance = SIM_NTC_R25 * exp(SIM_NTC_B * (1.0 / (temperature_C + 273.15) - 1.0 / 298.15));
+            code16 = 32767.0 * resistance / (resistance + SIM_NTC_PULLUP);
+            break;
+        }
+        default:
+            break;
+    }
+
+    return code16 * SIM_ADC_LSB16_V + NoiseSample_V();
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+/// Triangular distributed noise (sum of two uniform values), reproducible sequence
+float RL021_SimPlant::NoiseSample_V()
+{
+    if(parameters.adcNoise_uV <= 0)
+    {
+        return 0;
+    }
+
+    float sum = 0;
+    for(uint8_t i=0;i<2;i++)
+    {
+        /// xorshift32
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >> 17;
+        noiseState ^= noiseState << 5;
+        sum += (float)noiseState / 4294967296.0 - 0.5;
+    }
+
+    return sum * parameters.adcNoise_uV * 1e-6;
+}
+
+
+/************************************************************************************************************************************************/
+/*  SIM_MCP4726
+/************************************************************************************************************************************************/
+SIM_MCP4726::SIM_MCP4726(uint8_t newAddress, RL021_SimPlant * newPlant):plant(newPlant)
+{
+    address = newAddress;
+    configuration = 0;
+    writes = 0;
+}
+
+/** Decode write commands (datasheet figure 6-1, 6-2)
+ *  fast write:             0 0 PD1 PD0 D11..D8, D7..D0 (repeated pairs: burst, the last code remains)
+ *  volatile / all memory:  0 1 x VREF1 VREF0 PD1 PD0 G, D11..D4, D3..D0 x x x x
+ *
+ *  @param const uint8_t * data -
+ *  @param uint8_t length -
+ *	@return bool - (false): unknown command, not acknowledged
+ */
+bool SIM_MCP4726::I2C_Write(const uint8_t * data, uint8_t length)
+{
+    if(length >= 2 && (length & 1) == 0 && (data[0] & 0xC0) == 0x00)
+    {
+        /// transfer time is simulated for the whole transaction, intermediate codes are not seen by the plant
+        for(uint8_t i=0;i<length;i+=2)
+        {
+            if((data[i] & 0xC0) != 0x00)
+            {
+                return false;
+            }
+            plant->SetDacCode(((uint16_t)(data[i] & 0x0F) << 8) | data[i + 1]);
+        }
+    }
+    else if(length == 3 && (data[0] & 0xC0) == 0x40)
+    {
+        configuration = data[0] & 0x1F;
+        plant->SetDacCode(((uint16_t)data[1] << 4) | (data[2] >> 4));
+    }
+    else
+    {
+        return false;
+    }
+
+    writes++;
+    return true;
+}
+
+/// Status byte, DAC register (2), EEPROM (3): only the volatile part is simulated
+uint8_t SIM_MCP4726::I2C_Read(uint8_t * data, uint8_t length)
+{
+    uint16_t code = plant->GetDacCode();
+    uint8_t memory[6] = { (uint8_t)(0x80 | configuration), (uint8_t)(code >> 4), (uint8_t)(code << 4),
+                          (uint8_t)configuration, (uint8_t)(code >> 4), (uint8_t)(code << 4) };
+
+    for(uint8_t i=0;i<length;i++)
+    {
+        data[i] = memory[i % 6];
+    }
+    return length;
+}
+
+
+/************************************************************************************************************************************************/
+/*  SIM_MCP3428
+/************************************************************************************************************************************************/
+SIM_MCP3428::SIM_MCP3428(uint8_t newAddress, RL021_SimPlant * newPlant):plant(newPlant)
+{
+    address = newAddress;
+    /// power on default: channel 1, continuous, 12-bit, PGA 1
+    configuration = 0x10;
+    converting = false;
+    newResult = false;
+    conversionStart_us = 0;
+    conversionIndex = 0;
+    result = 0;
+    conversions = 0;
+}
+
+/** Configuration write
+ *  RDY bit 1 starts a conversion (one-shot), continuous mode restarts with the new configuration
+ *
+ *  @param const uint8_t * data -
+ *  @param uint8_t length -
+ *	@return bool -
+ */
+bool SIM_MCP3428::I2C_Write(const uint8_t * data, uint8_t length)
+{
+    if(length != 1)
+    {
+        return false;
+    }
+
+    configuration = data[0] & 0x7F;
+    bool continuous = configuration & 0x10;
+
+    if(continuous || (data[0] & 0x80))
+    {
+        converting = true;
+        conversionStart_us = HostTime_us();
+        conversionIndex = 0;
+    }
+
+    return true;
+}
+
+/** General call: conversion (all devices start at the same time) or reset
+ *
+ *  @param const uint8_t * data -
+ *  @param uint8_t length -
+ *	@return bool -
+ */
+bool SIM_MCP3428::I2C_GeneralCall(const uint8_t * data, uint8_t length)
+{
+    if(length != 1)
+    {
+        return false;
+    }
+
+    switch(data[0])
+    {
+        case 0x08:
+            converting = true;
+            conversionStart_us = HostTime_us();
+            conversionIndex = 0;
+            return true;
+        case 0x06:
+            configuration = 0x10;
+            converting = false;
+            newResult = false;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/** Read output register: upper data byte, lower data byte, configuration (RDY = 0: new result)
+ *
+ *  @param uint8_t * data -
+ *  @param uint8_t length -
+ *	@return uint8_t -
+ */
+uint8_t SIM_MCP3428::I2C_Read(uint8_t * data, uint8_t length)
+{
+    Update();
+
+    uint8_t output[3] = { (uint8_t)((uint16_t)result >> 8), (uint8_t)(result & 0xFF), (uint8_t)((newResult ? 0 : 0x80) | configuration) };
+
+    for(uint8_t i=0;i<length;i++)
+    {
+        /// configuration byte is repeated
+        data[i] = output[(i < 3) ? i : 2];
+    }
+
+    if(length >= 3)
+    {
+        newResult = false;
+    }
+    return length;
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+uint32_t SIM_MCP3428::ConversionTime_us()
+{
+    uint32_t time_us;
+
+    switch((configuration >> 2) & 0x03)
+    {
+        case 0:
+            time_us = 4167;
+            break;
+        case 1:
+            time_us = 16667;
+            break;
+        default:
+            time_us = 66667;
+            break;
+    }
+
+    return (uint32_t)(time_us * plant->parameters.adcClockScale);
+}
+
+/// Latch the result of the latest completed conversion (sampled at read time)
+void SIM_MCP3428::Update()
+{
+    if(!converting)
+    {
+        return;
+    }
+
+    uint32_t completed = (HostTime_us() - conversionStart_us) / ConversionTime_us();
+    if(completed <= conversionIndex)
+    {
+        return;
+    }
+
+    conversionIndex = completed;
+    result = Convert();
+    newResult = true;
+    conversions++;
+
+    /// one-shot: device goes to standby
+    if(!(configuration & 0x10))
+    {
+        converting = false;
+    }
+}
+
+/// Input voltage * PGA to output code of the configured resolution (saturated)
+int16_t SIM_MCP3428::Convert()
+{
+    uint8_t resolution = 12 + 2 * ((configuration >> 2) & 0x03);
+    if(resolution > 16)
+    {
+        resolution = 16;
+    }
+    float gain = 1 << (configuration & 0x03);
+    if(gain > 1)
+    {
+        gain /= 1.0 + plant->parameters.adcPgaGainError_ppm * 1e-6;
+    }
+
+    E_ADC_CHANNEL channel = (E_ADC_CHANNEL)((configuration >> 5) & 0x03);
+    float code = floor(plant->GetAdcInput_V(channel) * gain / 2.048 * (1L << (resolution - 1)));
+
+    float maximum = (1L << (resolution - 1)) - 1;
+    float minimum = -(1L << (resolution - 1));
+
+    return (int16_t)constrain(code, minimum, maximum);
+}
@@ -0,0 +1,166 @@
+/**
+* \file    RL021_SimPlant.h
+* \brief    Simulated RL-021 board (replaces MOCK-DAC-ADC.h): load physics, DAC and ADC as I2C devices on the simulated bus
+* \brief    Required drivers: Wire.h (host), RL021_DigitalLoad.h (calibration struct)
+*
+* \brief    plant model:
+*               DAC code -> current setpoint via the board's transfer function (S_RL021_Calibration: slope_dac * code + offset_dac)
+*               source with voltage V_src and internal resistance R_int:
+*                   current is limited to V_src / (R_int + R_min), V_load = V_src - I * R_int
+*               current follows the setpoint with a first order lag (current loop of the OPAMP / NFET stage)
+*               heatsink: first order thermal model T' = (T_amb + P * R_th - T) / tau_th, P = V_load * I
+*               NTC (B57421V2103, B=4000K) with 10 kOhm pull-up to the ADC reference
+*
+* \brief    simulated devices:
+*               SIM_MCP4726: fast write and volatile / all memory command writes (12-bit)
+*               SIM_MCP3428: one-shot and continuous mode, 12/14/16-bit conversion time (240/60/15 SPS, scaled by
+*                            adcClockScale), PGA, data ready flag (result only updated after a complete conversion)
+*
+* \brief    ADC input voltage of a channel is calculated with the inverse ADC calibration (value = slope * code16 - offset)
+*           and 62.5uV per 16-bit LSB (2.048V full scale)
+*
+* \par     Editor
+*           17.10.2026 first implementation: host simulation: load physics, simulated MCP4726 / MCP3428
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_SimPlant_H_
+#define _RL021_SimPlant_H_
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "RL021_DigitalLoad.h"
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+typedef struct
+{
+    /// Source
+    float sourceVoltage_V;
+    float sourceResistance_Ohm;
+    /// min. resistance of the load (NFET fully on + shunt)
+    float minResistance_Ohm;
+    /// voltage at the external voltage input
+    float externalVoltage_V;
+    /// time constant of the analog current loop
+    float currentTimeConstant_us;
+
+    /// Battery: capacity (0: ideal source), open circuit voltage falls linearly from sourceVoltage_V
+    /// to batteryEmptyVoltage_V at full discharge, then steeply (10% of capacity to 0V)
+    float batteryCapacity_mAh;
+    float batteryEmptyVoltage_V;
+
+    /// Thermal model
+    float ambient_C;
+    float thermalResistance_KW;
+    float thermalTimeConstant_s;
+
+    /// ADC: conversion time factor (1.0: typical 240/60/15 SPS), peak noise at the ADC input
+    float adcClockScale;
+    float adcNoise_uV;
+    /// ADC: gain error of PGA x2, x4, x8 relative to x1 [ppm] (code = x1 code * PGA / (1 + error))
+    float adcPgaGainError_ppm;
+
+    /// Board transfer functions and jumper settings (JP2 closed: high current range, JP3/JP4 closed: low voltage range)
+    S_RL021_Calibration board;
+    bool highRangeSelected_current;
+    bool lowRangeSelected_Vload;
+    bool lowRangeSelected_Vext;
+
+} S_SIM_Parameters;
+
+/************************************************************************/
+/* Plant                                                                */
+/************************************************************************/
+class RL021_SimPlant {
+
+ public:
+    /// Default parameters: theoretical values of RL021_DigitalLoad::SetDefaultCalibration(), 12V source
+    RL021_SimPlant();
+
+    S_SIM_Parameters parameters;
+
+    /// Power-on state (DAC 0, heatsink at ambient temperature) - call after changing parameters
+    void Reset();
+
+    /// Integrate the model up to the actual simulated time
+    void Update();
+
+    /// DAC output (12-bit)
+    void SetDacCode(uint16_t code);
+    uint16_t GetDacCode();
+
+    /// State
+    float GetCurrent_mA();
+    float GetLoadVoltage_mV();
+    /// Open circuit voltage of the source (battery: depends on discharged capacity)
+    float GetSourceVoltage_V();
+    float GetDischarged_mAh();
+    float GetTemperature_C();
+
+    /// Voltage at the ADC input of a channel [V] (incl. noise)
+    float GetAdcInput_V(E_ADC_CHANNEL channel);
+
+ private:
+    float NoiseSample_V();
+
+    uint16_t dacCode;
+    float current_mA;
+    float temperature_C;
+    float discharged_mAh;
+    uint64_t lastUpdate_us;
+    uint32_t noiseState;
+};
+
+/************************************************************************/
+/* Simulated devices                                                    */
+/************************************************************************/
+class SIM_MCP4726 : public I2C_SimDevice {
+
+ public:
+    SIM_MCP4726(uint8_t newAddress, RL021_SimPlant * newPlant);
+
+    virtual bool I2C_Write(const uint8_t * data, uint8_t length);
+    virtual uint8_t I2C_Read(uint8_t * data, uint8_t length);
+
+    /// Number of received DAC writes
+    uint32_t writes;
+
+ private:
+    RL021_SimPlant * plant;
+    uint8_t configuration;
+};
+
+class SIM_MCP3428 : public I2C_SimDevice {
+
+ public:
+    SIM_MCP3428(uint8_t newAddress, RL021_SimPlant * newPlant);
+
+    virtual bool I2C_Write(const uint8_t * data, uint8_t length);
+    virtual uint8_t I2C_Read(uint8_t * data, uint8_t length);
+    /// 0x08: conversion with actual configuration, 0x06: reset to power on default
+    virtual bool I2C_GeneralCall(const uint8_t * data, uint8_t length);
+
+    /// Number of completed conversions
+    uint32_t conversions;
+
+ private:
+    /// Conversion time of actual configuration [us]
+    uint32_t ConversionTime_us();
+    /// Latch result of completed conversion
+    void Update();
+    int16_t Convert();
+
+    RL021_SimPlant * plant;
+    uint8_t configuration;
+    bool converting;
+    bool newResult;
+    uint64_t conversionStart_us;
+    uint32_t conversionIndex;
+    int16_t result;
+};
+
+#endif /* _RL021_SimPlant_H_ */
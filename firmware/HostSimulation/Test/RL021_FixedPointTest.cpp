@@ -0,0 +1,248 @@
+/**
+* \file    RL021_FixedPointTest.cpp
+* \brief    Host test of the Q16.16 transfer functions of RL021_DigitalLoad (CalculateFixedPoint(), ApplyFixedPoint())
+* \brief    Required drivers: Arduino.h, Wire.h (host), RL021_DigitalLoad.h
+*
+* \brief    every input of CalculateDAC() (setpoint 0-65535 mA), CalculateCurrent() and CalculateVoltage()
+*               (ADC code 0-65535, all PGA gains) is compared with the float calculation replaced by the
+*               fixed-point version, both jumper settings of JP2 / JP3 / JP4
+*           calibrations: default calibration and pseudo-random calibrations (option -n, fixed seed)
+*           pass: |fixed-point - float| <= 1 LSB for every input, exit code 0 (1: failed)
+*
+* \par     Editor
+*           17.10.2026 first implementation: host test of the fixed-point transfer functions
+*
+* \todo
+* \version V0.1
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "RL021_DigitalLoad.h"
+
+/// max. deviation from the float calculation [LSB]
+#define TEST_MAX_DEVIATION      1
+/// pseudo-random calibrations in addition to the default calibration
+#define TEST_CALIBRATIONS       16
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+/// Worst case of one transfer function over all calibrations
+typedef struct
+{
+    const char * name;
+    int32_t deviation;
+    /// input / results of the worst case
+    uint16_t input;
+    int32_t fixedPoint;
+    int32_t reference;
+    uint16_t calibration;
+
+} S_TEST_Result;
+
+
+/************************************************************************************************************************************************/
+/* Float references
+/************************************************************************************************************************************************/
+/// previous CalculateDAC(): (current_mA - offset) / slope, limited to 12 bit
+static int32_t FloatDac(const S_RL021_Calibration * calibration, uint8_t range, uint16_t current_mA)
+{
+    float offset = calibration->offset_dac[range];
+    float current = (current_mA < offset) ? offset : current_mA;
+    float dacValue = (current - offset) / calibration->slope_dac[range];
+
+    return (dacValue > 4095) ? 4095 : (int32_t)dacValue;
+}
+
+/// previous CalculateCurrent() / CalculateVoltage(): slope * raw(x1) - offset,
+/// raw(x1) = (raw - offset_pga) * (1 + gainError_pga / 10^6) / PGA
+static int32_t FloatAdc(const S_RL021_Calibration * calibration, uint8_t range, uint8_t channel, uint8_t gain, uint16_t adcValue)
+{
+    float raw = adcValue;
+    if(gain > 0)
+    {
+        raw = (raw - calibration->offset_pga[gain-1]) * (1.0f + calibration->gainError_pga[gain-1] * 1e-6f) / (1<<gain);
+    }
+    float value = calibration->slope_adc[range][channel] * raw - calibration->offset_adc[range][channel];
+
+    if(value < 0)
+    {
+        return 0;
+    }
+    return (value > 65535) ? 65535 : (int32_t)value;
+}
+
+
+/************************************************************************************************************************************************/
+/* Helper
+/************************************************************************************************************************************************/
+/// Pseudo-random value in [center - span, center + span]
+static float RandomAround(float center, float span)
+{
+    return center + span * (2.0f * rand() / RAND_MAX - 1.0f);
+}
+
+/// Default calibration with random deviations (slopes +-10%, offsets, PGA gain error / offset)
+static S_RL021_Calibration RandomCalibration(const S_RL021_Calibration * defaultCalibration)
+{
+    S_RL021_Calibration calibration = *defaultCalibration;
+
+    for(uint8_t range=0;range<2;range++)
+    {
+        calibration.slope_dac[range] = RandomAround(defaultCalibration->slope_dac[range], defaultCalibration->slope_dac[range] * 0.1f);
+        calibration.offset_dac[range] = RandomAround(0, 50);
+        for(uint8_t ch=0;ch<ADC_CH_NTC;ch++)
+        {
+            calibration.slope_adc[range][ch] = RandomAround(defaultCalibration->slope_adc[range][ch], defaultCalibration->slope_adc[range][ch] * 0.1f);
+            calibration.offset_adc[range][ch] = RandomAround(0, 50);
+        }
+    }
+    for(uint8_t i=0;i<RL021_PGA_GAINS-1;i++)
+    {
+        calibration.gainError_pga[i] = (int16_t)RandomAround(0, 5000);
+        calibration.offset_pga[i] = (int16_t)RandomAround(0, 100);
+    }
+    return calibration;
+}
+
+static void Record(S_TEST_Result * result, uint16_t input, int32_t fixedPoint, int32_t reference, uint16_t calibration)
+{
+    int32_t deviation = abs(fixedPoint - reference);
+    if(deviation > result->deviation)
+    {
+        result->deviation = deviation;
+        result->input = input;
+        result->fixedPoint = fixedPoint;
+        result->reference = reference;
+        result->calibration = calibration;
+    }
+}
+
+
+/************************************************************************************************************************************************/
+/* Tests
+/************************************************************************************************************************************************/
+/// All setpoints of the DAC transfer function of the actual JP2 setting
+static void TestDac(RL021_DigitalLoad * load, uint8_t range, uint16_t calibration, S_TEST_Result * result)
+{
+    for(uint32_t current_mA=0;current_mA<=65535;current_mA++)
+    {
+        Record(result, current_mA, load->CalculateDAC(current_mA), FloatDac(&load->calibrationData, range, current_mA), calibration);
+    }
+}
+
+/// All ADC codes of a channel and PGA gain of the actual jumper setting
+static void TestAdc(RL021_DigitalLoad * load, uint8_t range, E_ADC_CHANNEL channel, uint8_t gain, uint16_t calibration, S_TEST_Result * result)
+{
+    for(uint32_t adcValue=0;adcValue<=65535;adcValue++)
+    {
+        int32_t fixedPoint;
+        if(channel == ADC_CH_CURRENT)
+        {
+            fixedPoint = load->CalculateCurrent(adcValue, gain);
+        }
+        else
+        {
+            fixedPoint = load->CalculateVoltage(adcValue, channel, gain);
+        }
+        Record(result, adcValue, fixedPoint, FloatAdc(&load->calibrationData, range, channel, gain, adcValue), calibration);
+    }
+}
+
+
+/************************************************************************************************************************************************/
+/* Main
+/************************************************************************************************************************************************/
+static void PrintUsage(const char * name)
+{
+    printf("usage: %s [-n calibrations]\n", name);
+    printf("  -n  pseudo-random calibrations in addition to the default calibration (default %d)\n", TEST_CALIBRATIONS);
+}
+
+int main(int argc, char ** argv)
+{
+    int option;
+    int calibrations = TEST_CALIBRATIONS;
+
+    while((option = getopt(argc, argv, "n:h")) != -1)
+    {
+        switch(option)
+        {
+            case 'n':
+                calibrations = atoi(optarg) >= 0 ? atoi(optarg) : 0;
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    static const char * channelNames[ADC_CH_NTC] = {"current", "Vload", "Vext"};
+    static const char * jumperNames[ADC_CH_NTC] = {"JP2", "JP3", "JP4"};
+
+    /// [closed][DAC, ADC channel x gain]
+    S_TEST_Result results[2][1 + ADC_CH_NTC * RL021_PGA_GAINS];
+    char names[2][1 + ADC_CH_NTC * RL021_PGA_GAINS][32];
+    memset(results, 0, sizeof(results));
+
+    MCP4726 dac;
+    MCP3428 adc(0);
+    RL021_DigitalLoad load(&dac, &adc);
+    const S_RL021_Calibration defaultCalibration = load.calibrationData;
+
+    srand(1);
+    for(int calibration=0;calibration<=calibrations;calibration++)
+    {
+        load.SetCalibrationData(calibration == 0 ? defaultCalibration : RandomCalibration(&defaultCalibration));
+
+        for(uint8_t closed=0;closed<2;closed++)
+        {
+            load.SetJumperSetting(JP2_CURRENT, closed);
+            load.SetJumperSetting(JP3_VLOAD, closed);
+            load.SetJumperSetting(JP4_VEXT, closed);
+
+            /// jumper -> range index: JP2 closed = RANGE_DAC_HIGH, JP3 / JP4 closed = RANGE_ADC_LOW
+            uint8_t range[ADC_CH_NTC] = {closed ? (uint8_t)RANGE_DAC_HIGH : (uint8_t)RANGE_DAC_LOW,
+                                         closed ? (uint8_t)RANGE_ADC_LOW : (uint8_t)RANGE_ADC_HIGH,
+                                         closed ? (uint8_t)RANGE_ADC_LOW : (uint8_t)RANGE_ADC_HIGH};
+
+            S_TEST_Result * result = results[closed];
+            snprintf(names[closed][0], 32, "DAC %s %s", jumperNames[ADC_CH_CURRENT], closed ? "closed" : "open");
+            result[0].name = names[closed][0];
+            TestDac(&load, range[ADC_CH_CURRENT], calibration, &result[0]);
+
+            for(uint8_t ch=0;ch<ADC_CH_NTC;ch++)
+            {
+                for(uint8_t gain=0;gain<RL021_PGA_GAINS;gain++)
+                {
+                    uint8_t index = 1 + ch * RL021_PGA_GAINS + gain;
+                    snprintf(names[closed][index], 32, "%s %s %s x%d", channelNames[ch], jumperNames[ch], closed ? "closed" : "open", 1<<gain);
+                    result[index].name = names[closed][index];
+                    TestAdc(&load, range[ch], (E_ADC_CHANNEL)ch, gain, calibration, &result[index]);
+                }
+            }
+        }
+    }
+
+    bool passed = true;
+    printf("%-26s %6s %8s %10s %10s %6s\n", "transfer function", "|diff|", "input", "fixed", "float", "cal");
+    for(uint8_t closed=0;closed<2;closed++)
+    {
+        for(uint8_t i=0;i<1 + ADC_CH_NTC * RL021_PGA_GAINS;i++)
+        {
+            const S_TEST_Result * result = &results[closed][i];
+            bool ok = (result->deviation <= TEST_MAX_DEVIATION);
+            printf("%-26s %6d %8u %10d %10d %6u %s\n", result->name, (int)result->deviation, result->input,
+                   (int)result->fixedPoint, (int)result->reference, result->calibration, ok ? "ok" : "FAILED");
+            passed &= ok;
+        }
+    }
+    printf("%d calibrations, max. deviation %d LSB: %s\n", calibrations + 1, TEST_MAX_DEVIATION, passed ? "passed" : "FAILED");
+
+    return passed ? 0 : 1;
+}
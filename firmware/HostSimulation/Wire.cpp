@@ -0,0 +1,180 @@
+#include "Wire.h"
+
+/// Zero initialized (no constructor): drivers call Wire.begin() from their global constructors
+TwoWire Wire;
+
+
+/************************************************************************************************************************************************/
+/* Public - Wire interface
+/************************************************************************************************************************************************/
+void TwoWire::begin()
+{
+    if(clock == 0)
+    {
+        clock = 100000;
+    }
+}
+
+void TwoWire::setClock(uint32_t newClock)
+{
+    clock = newClock;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    txAddress = address;
+    txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    if(txLength >= WIRE_BUFFER_SIZE)
+    {
+        return 0;
+    }
+    txBuffer[txLength++] = value;
+    return 1;
+}
+
+/** Pass buffered write transaction to the addressed device
+ *
+ *  @param bool sendStop - ignored, every transaction is passed as a whole
+ *	@return uint8_t - 0: success, 2: address not acknowledged, 3: data not acknowledged (like AVR Wire)
+ */
+uint8_t TwoWire::endTransmission(bool /*sendStop*/)
+{
+    if(txAddress == 0x00)
+    {
+        Transfer(txLength);
+        statistics.bytesWritten += txLength;
+
+        if(!GeneralCall())
+        {
+            statistics.nacks++;
+            return 3;
+        }
+        return 0;
+    }
+
+    I2C_SimDevice * device = FindDevice(txAddress);
+
+    if(device == NULL)
+    {
+        Transfer(0);
+        statistics.nacks++;
+        return 2;
+    }
+
+    Transfer(txLength);
+    statistics.bytesWritten += txLength;
+
+    if(!device->I2C_Write(txBuffer, txLength))
+    {
+        statistics.nacks++;
+        return 3;
+    }
+    return 0;
+}
+
+/** Read transaction
+ *
+ *  @param uint8_t address -
+ *  @param uint8_t quantity -
+ *	@return uint8_t - number of received bytes (0: address not acknowledged)
+ */
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+    I2C_SimDevice * device = FindDevice(address);
+
+    rxIndex = 0;
+    rxLength = 0;
+
+    if(quantity > WIRE_BUFFER_SIZE)
+    {
+        quantity = WIRE_BUFFER_SIZE;
+    }
+
+    if(device == NULL)
+    {
+        Transfer(0);
+        statistics.nacks++;
+        return 0;
+    }
+
+    rxLength = device->I2C_Read(rxBuffer, quantity);
+    Transfer(rxLength);
+    statistics.bytesRead += rxLength;
+    return rxLength;
+}
+
+int TwoWire::available()
+{
+    return rxLength - rxIndex;
+}
+
+int TwoWire::read()
+{
+    return (rxIndex < rxLength) ? rxBuffer[rxIndex++] : -1;
+}
+
+bool TwoWire::HostAttach(I2C_SimDevice * device)
+{
+    if(deviceCount >= WIRE_MAX_DEVICES)
+    {
+        return false;
+    }
+    devices[deviceCount++] = device;
+    return true;
+}
+
+const S_WIRE_Statistics * TwoWire::HostStatistics()
+{
+    return &statistics;
+}
+
+void TwoWire::HostResetStatistics()
+{
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+/************************************************************************************************************************************************/
+/* Private
+/************************************************************************************************************************************************/
+I2C_SimDevice * TwoWire::FindDevice(uint8_t address)
+{
+    for(uint8_t i=0;i<deviceCount;i++)
+    {
+        if(devices[i]->address == address)
+        {
+            return devices[i];
+        }
+    }
+    return NULL;
+}
+
+bool TwoWire::GeneralCall()
+{
+    bool acknowledged = false;
+
+    for(uint8_t i=0;i<deviceCount;i++)
+    {
+        if(devices[i]->I2C_GeneralCall(txBuffer, txLength))
+        {
+            acknowledged = true;
+        }
+    }
+    return acknowledged;
+}
+
+/// start + address byte + data bytes (9 clocks each: 8 bit + ACK) + stop
+void TwoWire::Transfer(uint8_t bytes)
+{
+    uint32_t clocks = 1 + 9 * (1 + (uint32_t)bytes) + 1;
+
+    begin();
+    uint32_t time_us = (clocks * 1000000UL + clock - 1) / clock;
+    HostAdvance_us(time_us);
+
+    statistics.transactions++;
+    statistics.busTime_us += time_us;
+}
@@ -0,0 +1,112 @@
+/**
+* \file    Wire.h
+* \brief    Simulated I2C bus for the native Linux build (same interface as the Arduino Wire library)
+* \brief    Required drivers: Arduino.h (host)
+*
+* \brief    basic functions:
+*               devices (I2C_SimDevice) are attached to the bus with their 7-bit address
+*               transactions of the drivers are passed to the addressed device, unknown addresses are not acknowledged
+*               general call (address 0x00): write is passed to every device, acknowledged if one device accepts it
+*               each transfer advances the simulated time (9 clocks per byte incl. address, start/stop)
+*               bus statistics (transactions, bytes, NACKs, bus time) for benchmarks
+*
+* \par     Editor
+*           17.10.2026 first implementation: host simulation: I2C bus
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _HOST_Wire_H_
+#define _HOST_Wire_H_
+
+#include "Arduino.h"
+
+/// Buffer size of the AVR Wire library
+#define WIRE_BUFFER_SIZE        32
+/// max. number of attached devices (8 boards with DAC and ADC)
+#define WIRE_MAX_DEVICES        16
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+typedef struct
+{
+    uint32_t transactions;
+    /// data bytes (without address byte)
+    uint32_t bytesWritten;
+    uint32_t bytesRead;
+    /// transactions not acknowledged (address or data)
+    uint32_t nacks;
+    uint64_t busTime_us;
+
+} S_WIRE_Statistics;
+
+
+/************************************************************************/
+/* Simulated device                                                     */
+/************************************************************************/
+class I2C_SimDevice {
+
+ public:
+    /// Write transaction addressed to the device - return (false): data not acknowledged
+    virtual bool I2C_Write(const uint8_t * data, uint8_t length) = 0;
+    /// Read transaction - fill data, return number of bytes sent
+    virtual uint8_t I2C_Read(uint8_t * data, uint8_t length) = 0;
+    /// General call write - return (false): command not supported (not acknowledged by this device)
+    virtual bool I2C_GeneralCall(const uint8_t * /*data*/, uint8_t /*length*/) { return false; }
+
+    uint8_t address;
+};
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class TwoWire {
+
+ public:
+    void begin();
+    void setClock(uint32_t clock);
+
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t value);
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    int available();
+    int read();
+
+    /// Connect simulated device (address set in the device)
+    bool HostAttach(I2C_SimDevice * device);
+
+    /// Bus statistics since start / last reset
+    const S_WIRE_Statistics * HostStatistics();
+    void HostResetStatistics();
+
+ private:
+    I2C_SimDevice * FindDevice(uint8_t address);
+    /// General call to all devices - returns (true) if acknowledged
+    bool GeneralCall();
+    /// Simulated transfer time of address + bytes
+    void Transfer(uint8_t bytes);
+
+    uint32_t clock;
+    S_WIRE_Statistics statistics;
+
+    I2C_SimDevice * devices[WIRE_MAX_DEVICES];
+    uint8_t deviceCount;
+
+    uint8_t txAddress;
+    uint8_t txBuffer[WIRE_BUFFER_SIZE];
+    uint8_t txLength;
+
+    uint8_t rxBuffer[WIRE_BUFFER_SIZE];
+    uint8_t rxIndex;
+    uint8_t rxLength;
+};
+
+extern TwoWire Wire;
+
+#endif /* _HOST_Wire_H_ */
@@ -0,0 +1,13 @@
+/**
+* \file    printf.h
+* \brief    Host replacement of the printf to Serial redirection (printf writes to stdout already)
+*/
+
+#ifndef _HOST_printf_H_
+#define _HOST_printf_H_
+
+inline void printf_begin()
+{
+}
+
+#endif /* _HOST_printf_H_ */
@@ -0,0 +1,538 @@
+/**
+* \file    CaptureMain.cpp
+* \brief    rl021_capture: command line capture of the DigitalLoadExample telemetry to a log file (RL021_LogFile.h),
+*           CSV export and check of a log
+* \brief    Required drivers: RL021_FrameDecoder.h, RL021_LogFile.h, Linux (termios, pty)
+*
+* \brief    usage: see readme.md
+*               serial port: the Arduino resets when the port is opened, the commands (binary protocol, raw values,
+*               stream) are sent after RL021_CAPTURE_RESET_MS
+*               stand-in (-s): the command runs on a pty (stdin / stdout, raw mode) instead of a serial port, e.g. the
+*               host simulation (firmware/HostSimulation) - the capture ends when the command exits
+*
+* \par     Editor
+*           17.10.2026 first implementation: capture tool for long-duration tests
+*
+* \todo
+* \version V0.1
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "RL021_FrameDecoder.h"
+#include "RL021_LogFile.h"
+
+/// bootloader of the Arduino after the port is opened (DTR reset) [ms]
+#define RL021_CAPTURE_RESET_MS      2000
+/// status output (-v) [us]
+#define RL021_CAPTURE_STATUS_US     (10ULL * 1000000)
+
+typedef struct
+{
+    const char * device;
+    int baud;
+    const char * standIn;
+    const char * log;
+    bool raw;
+    const char * commands;
+    int streamMask;
+    double chunkSpan_s;
+    double duration_s;
+    bool verbose;
+
+    /// export
+    double from_s;
+    double to_s;
+    int board;
+    bool absolute;
+
+} S_CAPTURE_Options;
+
+typedef struct
+{
+    RL021_LogWriter * writer;
+    bool writeError;
+
+} S_CAPTURE_Context;
+
+static volatile sig_atomic_t stopRequested = 0;
+
+
+static void PrintUsage(const char * name)
+{
+    fprintf(stderr, "usage: %s -o <log> (-p <device> | -s <command>) [options]   capture\n"
+                    "       %s -e <log> [-f <s>] [-u <s>] [-n <board>] [-a]      export CSV to stdout\n"
+                    "       %s -i <log>                                          summary, check all chunks\n"
+                    "  -p <device>     serial port of the Arduino (e.g. /dev/ttyUSB0)\n"
+                    "  -b <baud>       baud rate (default 115200)\n"
+                    "  -s <command>    stand-in of the board on a pty, e.g. \"./rl021_sim -x\"\n"
+                    "  -r              raw ADC values (default: calibrated values)\n"
+                    "  -c <text>       commands sent at start, e.g. \"sq12e\" (12-bit conversions)\n"
+                    "  -m <mask>       stream channel mask (bit0: current ... bit3: NTC, default 0: snapshots 1/s)\n"
+                    "  -k <s>          max. time span of a chunk (default 60)\n"
+                    "  -t <s>          capture time (default: until SIGINT / SIGTERM / end of the stand-in)\n"
+                    "  -v              print text of the firmware and status to stderr\n"
+                    "  -f <s> / -u <s> export rows from / until time since capture start\n"
+                    "  -n <board>      export rows of one board\n"
+                    "  -a              export unix time instead of time since capture start\n", name, name, name);
+}
+
+static void OnSignal(int /*signal*/)
+{
+    stopRequested = 1;
+}
+
+static uint64_t Monotonic_us()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static uint64_t UnixTime_us()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void StoreRow(const S_RL021_LogRow * row, void * context)
+{
+    S_CAPTURE_Context * capture = (S_CAPTURE_Context *)context;
+    if(!capture->writer->Add(row))
+    {
+        capture->writeError = true;
+    }
+}
+
+/************************************************************************************************************************************************/
+/* Port
+/************************************************************************************************************************************************/
+static speed_t BaudRate(int baud)
+{
+    switch(baud)
+    {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 500000: return B500000;
+        case 1000000: return B1000000;
+        default:     return B115200;
+    }
+}
+
+/** Serial port, raw mode, 8N1
+ *
+ *  @param const char * device -
+ *  @param int baud -
+ *	@return int - file descriptor, -1: error
+ */
+static int OpenSerial(const char * device, int baud)
+{
+    int fd = open(device, O_RDWR | O_NOCTTY);
+    if(fd < 0)
+    {
+        return -1;
+    }
+
+    struct termios settings;
+    if(tcgetattr(fd, &settings) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&settings);
+    cfsetispeed(&settings, BaudRate(baud));
+    cfsetospeed(&settings, BaudRate(baud));
+    settings.c_cflag |= CLOCAL | CREAD;
+    settings.c_cc[VMIN] = 0;
+    settings.c_cc[VTIME] = 0;
+
+    if(tcsetattr(fd, TCSANOW, &settings) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+/** Stand-in of the board: command on a pty in raw mode (binary frames are not translated)
+ *
+ *  @param const char * command - run by /bin/sh, stdin / stdout: pty, stderr: stderr of the capture
+ *  @param pid_t * child - output
+ *	@return int - master side of the pty, -1: error
+ */
+static int OpenStandIn(const char * command, pid_t * child)
+{
+    int master;
+    int slave;
+    struct termios settings;
+    memset(&settings, 0, sizeof(settings));
+    cfmakeraw(&settings);
+
+    if(openpty(&master, &slave, NULL, &settings, NULL) != 0)
+    {
+        return -1;
+    }
+
+    *child = fork();
+    if(*child < 0)
+    {
+        close(master);
+        close(slave);
+        return -1;
+    }
+
+    if(*child == 0)
+    {
+        close(master);
+        setsid();
+        dup2(slave, STDIN_FILENO);
+        dup2(slave, STDOUT_FILENO);
+        if(slave > STDERR_FILENO)
+        {
+            close(slave);
+        }
+        execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+        _exit(127);
+    }
+
+    close(slave);
+    return master;
+}
+
+static void SendText(int fd, const char * text)
+{
+    size_t length = strlen(text);
+    if(write(fd, text, length) != (ssize_t)length)
+    {
+        fprintf(stderr, "write to port failed: %s\n", strerror(errno));
+    }
+}
+
+/************************************************************************************************************************************************/
+/* Capture
+/************************************************************************************************************************************************/
+/** Capture until stop (signal, -t, end of the stand-in / port closed)
+ *
+ *  @param const S_CAPTURE_Options * options -
+ *	@return int - exit code
+ */
+static int Capture(const S_CAPTURE_Options * options)
+{
+    pid_t child = -1;
+    int fd = (options->standIn != NULL) ? OpenStandIn(options->standIn, &child) : OpenSerial(options->device, options->baud);
+    if(fd < 0)
+    {
+        fprintf(stderr, "cannot open %s: %s\n", (options->standIn != NULL) ? "stand-in" : options->device, strerror(errno));
+        return 1;
+    }
+
+    RL021_LogWriter writer;
+    if(!writer.Open(options->log, UnixTime_us()))
+    {
+        fprintf(stderr, "cannot create %s: %s\n", options->log, strerror(errno));
+        close(fd);
+        return 1;
+    }
+    writer.SetChunkLimits((uint64_t)(options->chunkSpan_s * 1e6), RL021_LOG_CHUNK_ROWS);
+
+    S_CAPTURE_Context context = {&writer, false};
+    RL021_FrameDecoder decoder(StoreRow, &context);
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+
+    if(options->standIn == NULL)
+    {
+        usleep(RL021_CAPTURE_RESET_MS * 1000);
+    }
+    SendText(fd, options->raw ? "br" : "bt");
+    if(options->commands != NULL)
+    {
+        SendText(fd, options->commands);
+    }
+    if(options->streamMask > 0)
+    {
+        char command[16];
+        snprintf(command, sizeof(command), "sm%de", options->streamMask);
+        SendText(fd, command);
+    }
+
+    uint64_t start_us = Monotonic_us();
+    uint64_t nextStatus_us = RL021_CAPTURE_STATUS_US;
+    uint8_t buffer[4096];
+
+    while(!stopRequested && !context.writeError)
+    {
+        uint64_t now_us = Monotonic_us() - start_us;
+        if(options->duration_s > 0 && now_us >= options->duration_s * 1e6)
+        {
+            break;
+        }
+
+        struct pollfd input = { fd, POLLIN, 0 };
+        if(poll(&input, 1, 200) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if(count > 0)
+        {
+            /// whole buffer with one host time (ASCII rows, anchor of the device time)
+            decoder.Decode(buffer, count, Monotonic_us() - start_us);
+            std::string text = decoder.TakeText();
+            if(options->verbose && !text.empty())
+            {
+                fwrite(text.data(), 1, text.size(), stderr);
+            }
+        }
+        else if(count == 0 || (errno != EAGAIN && errno != EINTR))
+        {
+            /// port closed / stand-in exited (EIO)
+            break;
+        }
+
+        if(options->verbose && now_us >= nextStatus_us)
+        {
+            const S_RL021_DecoderStatistics * statistics = decoder.GetStatistics();
+            fprintf(stderr, "<capture %.0fs: %u rows, %u chunks, %" PRIu64 " bytes>\n", now_us / 1e6,
+                    statistics->rows, writer.GetChunks(), writer.GetBytes());
+            nextStatus_us += RL021_CAPTURE_STATUS_US;
+        }
+    }
+
+    if(options->streamMask > 0)
+    {
+        SendText(fd, "sm0e");
+    }
+    close(fd);
+    if(child > 0)
+    {
+        kill(child, SIGTERM);
+        waitpid(child, NULL, 0);
+    }
+
+    bool ok = writer.Close() && !context.writeError;
+    const S_RL021_DecoderStatistics * statistics = decoder.GetStatistics();
+    fprintf(stderr, "%u rows, %u chunks, %" PRIu64 " bytes (%.2f bytes per row), frames %u, CRC errors %u, lost frames %u%s\n",
+            statistics->rows, writer.GetChunks(), writer.GetBytes(),
+            statistics->rows ? (double)writer.GetBytes() / statistics->rows : 0.0,
+            statistics->frames, statistics->crcErrors, statistics->lostFrames, ok ? "" : ", WRITE ERROR");
+    return ok ? 0 : 1;
+}
+
+/************************************************************************************************************************************************/
+/* Export / info
+/************************************************************************************************************************************************/
+/** CSV of the rows in the time range, only chunks overlapping the range are read (time index)
+ *  Rows are in chunk order: sorted by time per stream (board, channels), streams are not merged.
+ *
+ *  @param const S_CAPTURE_Options * options -
+ *	@return int - exit code (1: log not readable, 2: rows of damaged chunks skipped)
+ */
+static int Export(const S_CAPTURE_Options * options)
+{
+    RL021_LogReader reader;
+    if(!reader.Open(options->log))
+    {
+        fprintf(stderr, "%s: no capture log\n", options->log);
+        return 1;
+    }
+
+    uint64_t from_us = (options->from_s > 0) ? (uint64_t)(options->from_s * 1e6) : 0;
+    uint64_t to_us = (options->to_s > 0) ? (uint64_t)(options->to_s * 1e6) : UINT64_MAX;
+    std::vector<S_RL021_LogRow> rows;
+    uint32_t damaged = 0;
+
+    printf("time_s,board,raw,current_mA,vload_mV,vext_mV,ntc_C10\n");
+
+    for(size_t i=0;i<reader.GetChunkCount();i++)
+    {
+        const S_RL021_LogIndexEntry * chunk = reader.GetChunk(i);
+        if(chunk->lastTime_us < from_us || chunk->firstTime_us > to_us || (options->board >= 0 && chunk->board != options->board))
+        {
+            continue;
+        }
+
+        rows.clear();
+        if(!reader.ReadChunk(i, &rows))
+        {
+            fprintf(stderr, "chunk at offset %" PRIu64 " damaged (CRC / truncated), %u rows skipped\n", chunk->offset, chunk->rows);
+            damaged++;
+            continue;
+        }
+
+        for(size_t n=0;n<rows.size();n++)
+        {
+            const S_RL021_LogRow * row = &rows[n];
+            if(row->time_us < from_us || row->time_us > to_us)
+            {
+                continue;
+            }
+
+            uint64_t time_us = options->absolute ? reader.GetStart() + row->time_us : row->time_us;
+            printf("%" PRIu64 ".%06u,%u,%u", time_us / 1000000, (unsigned)(time_us % 1000000), row->board, (row->mask & RL021_ROW_RAW) ? 1 : 0);
+            for(uint8_t ch=0;ch<RL021_ROW_CHANNELS;ch++)
+            {
+                if(row->mask & (1<<ch))
+                {
+                    printf(",%d", row->value[ch]);
+                }
+                else
+                {
+                    printf(",");
+                }
+            }
+            printf("\n");
+        }
+    }
+    return damaged ? 2 : 0;
+}
+
+static int Info(const S_CAPTURE_Options * options)
+{
+    RL021_LogReader reader;
+    if(!reader.Open(options->log))
+    {
+        fprintf(stderr, "%s: no capture log\n", options->log);
+        return 1;
+    }
+
+    std::vector<S_RL021_LogRow> rows;
+    uint64_t rowCount = 0;
+    uint64_t first_us = UINT64_MAX;
+    uint64_t last_us = 0;
+    uint32_t damaged = 0;
+
+    for(size_t i=0;i<reader.GetChunkCount();i++)
+    {
+        const S_RL021_LogIndexEntry * chunk = reader.GetChunk(i);
+        rows.clear();
+        if(!reader.ReadChunk(i, &rows))
+        {
+            damaged++;
+            continue;
+        }
+        rowCount += rows.size();
+        first_us = (chunk->firstTime_us < first_us) ? chunk->firstTime_us : first_us;
+        last_us = (chunk->lastTime_us > last_us) ? chunk->lastTime_us : last_us;
+    }
+
+    time_t start = reader.GetStart() / 1000000;
+    FILE * file = fopen(options->log, "rb");
+    fseeko(file, 0, SEEK_END);
+    uint64_t size = ftello(file);
+    fclose(file);
+
+    printf("start:      %s", ctime(&start));
+    printf("index:      %s\n", reader.HasTrailer() ? "trailer" : "chunk headers (capture not closed)");
+    printf("chunks:     %zu (%u damaged)\n", reader.GetChunkCount(), damaged);
+    printf("rows:       %" PRIu64 "\n", rowCount);
+    printf("time:       %.3fs ... %.3fs\n", rowCount ? first_us / 1e6 : 0.0, last_us / 1e6);
+    printf("size:       %" PRIu64 " bytes (%.2f bytes per row)\n", size, rowCount ? (double)size / rowCount : 0.0);
+    return damaged ? 2 : 0;
+}
+
+/************************************************************************************************************************************************/
+/* main
+/************************************************************************************************************************************************/
+int main(int argc, char ** argv)
+{
+    S_CAPTURE_Options options;
+    memset(&options, 0, sizeof(options));
+    options.baud = 115200;
+    options.chunkSpan_s = RL021_LOG_CHUNK_SPAN_US / 1e6;
+    options.board = -1;
+    int mode = 0;
+    int option;
+
+    while((option = getopt(argc, argv, "o:p:b:s:rc:m:k:t:ve:i:f:u:n:ah")) != -1)
+    {
+        switch(option)
+        {
+            case 'o':
+            case 'e':
+            case 'i':
+                mode = option;
+                options.log = optarg;
+                break;
+            case 'p':
+                options.device = optarg;
+                break;
+            case 'b':
+                options.baud = atoi(optarg);
+                break;
+            case 's':
+                options.standIn = optarg;
+                break;
+            case 'r':
+                options.raw = true;
+                break;
+            case 'c':
+                options.commands = optarg;
+                break;
+            case 'm':
+                options.streamMask = atoi(optarg);
+                break;
+            case 'k':
+                options.chunkSpan_s = atof(optarg);
+                break;
+            case 't':
+                options.duration_s = atof(optarg);
+                break;
+            case 'v':
+                options.verbose = true;
+                break;
+            case 'f':
+                options.from_s = atof(optarg);
+                break;
+            case 'u':
+                options.to_s = atof(optarg);
+                break;
+            case 'n':
+                options.board = atoi(optarg);
+                break;
+            case 'a':
+                options.absolute = true;
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    switch(mode)
+    {
+        case 'o':
+            if((options.device == NULL) == (options.standIn == NULL) || options.chunkSpan_s <= 0)
+            {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+            return Capture(&options);
+        case 'e':
+            return Export(&options);
+        case 'i':
+            return Info(&options);
+        default:
+            PrintUsage(argv[0]);
+            return 1;
+    }
+}
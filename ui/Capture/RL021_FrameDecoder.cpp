@@ -0,0 +1,361 @@
+#include "RL021_FrameDecoder.h"
+
+#include <string.h>
+
+
+/************************************************************************************************************************************************/
+/*  Constructor
+/************************************************************************************************************************************************/
+RL021_FrameDecoder::RL021_FrameDecoder(RL021_RowCallback newCallback, void * newContext):callback(newCallback), context(newContext)
+{
+    hostTime_us = 0;
+
+    frameIndex = 0;
+    frameSize = 0;
+    lastSequence = -1;
+
+    anchored = false;
+    lastTimestamp_us = 0;
+    deviceTime_us = 0;
+    lastFrameHost_us = 0;
+
+    asciiCommand = false;
+    asciiType = 0;
+    asciiNegative = false;
+    asciiNumber = -1;
+    asciiBoard = 0;
+    memset(&asciiRow, 0, sizeof(asciiRow));
+
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+/************************************************************************************************************************************************/
+/* Public
+/************************************************************************************************************************************************/
+/** Decode received bytes, rows are passed to the callback
+ *
+ *  @param const uint8_t * data -
+ *  @param size_t size -
+ *  @param uint64_t host_us - host time of the buffer [us since capture start] (time of ASCII rows, anchor of the device time)
+ *	@return /
+ */
+void RL021_FrameDecoder::Decode(const uint8_t * data, size_t size, uint64_t host_us)
+{
+    hostTime_us = host_us;
+
+    for(size_t i=0;i<size;i++)
+    {
+        /// binary frames are consumed by the frame parser, all other bytes are ASCII protocol
+        if(!FrameByte(data[i]))
+        {
+            text += (char)data[i];
+            AsciiByte((char)data[i]);
+        }
+    }
+}
+
+std::string RL021_FrameDecoder::TakeText()
+{
+    std::string result;
+    result.swap(text);
+    return result;
+}
+
+const S_RL021_DecoderStatistics * RL021_FrameDecoder::GetStatistics()
+{
+    return &statistics;
+}
+
+uint16_t RL021_FrameDecoder::CRC16(const uint8_t * data, size_t length, uint16_t crc)
+{
+    for(size_t i=0;i<length;i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for(uint8_t bit=0;bit<8;bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/************************************************************************************************************************************************/
+/* Private - frames
+/************************************************************************************************************************************************/
+bool RL021_FrameDecoder::FrameByte(uint8_t value)
+{
+    if(frameIndex == 0)
+    {
+        if(value != RL021_FRAME_SYNC1)
+        {
+            return false;
+        }
+    }
+    else if(frameIndex == 1 && value != RL021_FRAME_SYNC2)
+    {
+        /// no frame: sync byte is not an ASCII character, drop it
+        frameIndex = 0;
+        return (value == RL021_FRAME_SYNC1) ? FrameByte(value) : false;
+    }
+
+    frame[frameIndex++] = value;
+
+    if(frameIndex == 5)
+    {
+        frameSize = RL021_FRAME_HEADER_SIZE + value + RL021_FRAME_CRC_SIZE;
+    }
+
+    if(frameIndex > 5 && frameIndex == frameSize)
+    {
+        ProcessFrame();
+        frameIndex = 0;
+    }
+    return true;
+}
+
+void RL021_FrameDecoder::ProcessFrame()
+{
+    size_t end = RL021_FRAME_HEADER_SIZE + frame[4];
+
+    if(frame[2] != RL021_FRAME_VERSION || CRC16(&frame[2], end - 2) != Get16(end))
+    {
+        statistics.crcErrors++;
+        return;
+    }
+    statistics.frames++;
+
+    uint16_t sequence = Get16(5);
+    if(lastSequence >= 0 && sequence != ((lastSequence + 1) & 0xFFFF))
+    {
+        statistics.lostFrames += (uint16_t)(sequence - lastSequence - 1);
+    }
+    lastSequence = sequence;
+
+    uint32_t timestamp_us = Get16(7) | ((uint32_t)Get16(9) << 16);
+    uint8_t type = frame[3];
+    size_t p = RL021_FRAME_HEADER_SIZE;
+    S_RL021_LogRow row;
+    memset(&row, 0, sizeof(row));
+
+    if(type == RL021_FRAME_SNAPSHOT || type == RL021_FRAME_RAW_SNAPSHOT || type == RL021_FRAME_BOARD_SNAPSHOT)
+    {
+        bool raw = (type == RL021_FRAME_RAW_SNAPSHOT);
+        if(type == RL021_FRAME_BOARD_SNAPSHOT)
+        {
+            raw = frame[p] & RL021_FRAME_RAW;
+            row.board = frame[p++] & ~RL021_FRAME_RAW;
+        }
+        if(end - p < 2 * RL021_ROW_CHANNELS)
+        {
+            return;
+        }
+
+        row.time_us = DeviceTime(timestamp_us);
+        row.mask = (1 << RL021_ROW_CHANNELS) - 1;
+        for(uint8_t ch=0;ch<RL021_ROW_CHANNELS;ch++)
+        {
+            uint16_t value = Get16(p + 2*ch);
+            row.value[ch] = raw ? value : (int16_t)value;
+        }
+        if(raw)
+        {
+            row.mask |= RL021_ROW_RAW;
+        }
+        Emit(&row);
+    }
+    else if(type == RL021_FRAME_BLOCK && end - p >= 2)
+    {
+        uint8_t mask = frame[p++];
+        uint8_t count = frame[p++];
+        bool raw = mask & RL021_FRAME_RAW;
+        row.mask = mask & ((1 << RL021_ROW_CHANNELS) - 1);
+        if(raw)
+        {
+            row.mask |= RL021_ROW_RAW;
+        }
+
+        uint32_t sampleTime_us = timestamp_us;
+        for(uint8_t n=0;n<count;n++)
+        {
+            uint32_t dt;
+            if(!GetVarint(&p, end, &dt))
+            {
+                return;
+            }
+            /// 1st sample: since frame timestamp, next samples: since previous sample
+            sampleTime_us += dt;
+
+            for(uint8_t ch=0;ch<RL021_ROW_CHANNELS;ch++)
+            {
+                if(!(row.mask & (1<<ch)))
+                {
+                    continue;
+                }
+                if(n == 0)
+                {
+                    if(end - p < 2)
+                    {
+                        return;
+                    }
+                    row.value[ch] = raw ? Get16(p) : (int16_t)Get16(p);
+                    p += 2;
+                }
+                else
+                {
+                    uint32_t zigzag;
+                    if(!GetVarint(&p, end, &zigzag))
+                    {
+                        return;
+                    }
+                    row.value[ch] += (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+                }
+            }
+            row.time_us = DeviceTime(sampleTime_us);
+            Emit(&row);
+        }
+    }
+}
+
+/** Unwrapped device time, anchored to the host time at the first frame / after a reset or a pause
+ *
+ *  @param uint32_t timestamp_us - micros() of the device
+ *	@return uint64_t - [us since capture start]
+ */
+uint64_t RL021_FrameDecoder::DeviceTime(uint32_t timestamp_us)
+{
+    int32_t delta = (int32_t)(timestamp_us - lastTimestamp_us);
+
+    if(!anchored || delta < -RL021_DECODER_RESET_US || hostTime_us - lastFrameHost_us > RL021_DECODER_PAUSE_US)
+    {
+        deviceTime_us = hostTime_us;
+        anchored = true;
+        statistics.timeAnchors++;
+    }
+    else
+    {
+        /// small steps back: block sample after a later snapshot
+        deviceTime_us += delta;
+    }
+
+    lastTimestamp_us = timestamp_us;
+    lastFrameHost_us = hostTime_us;
+    return deviceTime_us;
+}
+
+void RL021_FrameDecoder::Emit(S_RL021_LogRow * row)
+{
+    statistics.rows++;
+    callback(row, context);
+}
+
+uint16_t RL021_FrameDecoder::Get16(size_t offset)
+{
+    return frame[offset] | ((uint16_t)frame[offset+1] << 8);
+}
+
+bool RL021_FrameDecoder::GetVarint(size_t * offset, size_t end, uint32_t * value)
+{
+    *value = 0;
+    for(uint8_t shift=0;shift<35;shift+=7)
+    {
+        if(*offset >= end)
+        {
+            return false;
+        }
+        uint8_t b = frame[(*offset)++];
+        *value |= (uint32_t)(b & 0x7F) << shift;
+        if(!(b & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/************************************************************************************************************************************************/
+/* Private - ASCII protocol
+/************************************************************************************************************************************************/
+/** 's' type [-]digits 'e', any other character between type and 'e' discards the command (text)
+ *
+ *  @param char value -
+ *	@return /
+ */
+void RL021_FrameDecoder::AsciiByte(char value)
+{
+    if(!asciiCommand)
+    {
+        if(value == 's')
+        {
+            asciiCommand = true;
+            asciiType = 0;
+            asciiNegative = false;
+            asciiNumber = -1;
+        }
+        return;
+    }
+
+    if(asciiType == 0)
+    {
+        asciiType = value;
+    }
+    else if(value >= '0' && value <= '9')
+    {
+        asciiNumber = ((asciiNumber < 0) ? 0 : asciiNumber * 10) + (value - '0');
+    }
+    else if(value == '-' && asciiNumber < 0 && !asciiNegative)
+    {
+        asciiNegative = true;
+    }
+    else
+    {
+        if(value == 'e' && asciiNumber >= 0)
+        {
+            AsciiValue(asciiType, asciiNegative ? -asciiNumber : asciiNumber);
+        }
+        asciiCommand = false;
+        /// 's' of the next command (text "...s")
+        if(value == 's')
+        {
+            AsciiByte(value);
+        }
+    }
+}
+
+void RL021_FrameDecoder::AsciiValue(char type, int32_t value)
+{
+    if(type == 'x')
+    {
+        asciiBoard = (uint8_t)value;
+        return;
+    }
+
+    bool raw = (type >= 'f' && type <= 'i');
+    if(!raw && !(type >= 'a' && type <= 'd'))
+    {
+        return;
+    }
+    uint8_t ch = type - (raw ? 'f' : 'a');
+
+    /// other board, other type or channel already set: previous row is complete
+    if(asciiRow.mask && (asciiRow.board != asciiBoard || (bool)(asciiRow.mask & RL021_ROW_RAW) != raw || (asciiRow.mask & (1<<ch))))
+    {
+        Emit(&asciiRow);
+        asciiRow.mask = 0;
+    }
+
+    if(asciiRow.mask == 0)
+    {
+        asciiRow.time_us = hostTime_us;
+        asciiRow.board = asciiBoard;
+        asciiRow.mask = raw ? RL021_ROW_RAW : 0;
+    }
+    asciiRow.mask |= (1<<ch);
+    asciiRow.value[ch] = value;
+
+    /// NTC is sent last
+    if(ch == RL021_ROW_CHANNELS - 1)
+    {
+        Emit(&asciiRow);
+        asciiRow.mask = 0;
+    }
+}
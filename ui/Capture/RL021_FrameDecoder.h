@@ -0,0 +1,151 @@
+/**
+* \file    RL021_FrameDecoder.h
+* \brief    Host side decoder of the serial telemetry of DigitalLoadExample: binary frames (RL021_Protocol.h)
+*           and ASCII values ('s'x'...'e'), one row per sample with a 64-bit time
+* \brief    Required drivers: /
+*
+* \brief    basic functions:
+*               Decode(): bytes in any chunking (whole read() buffers), rows are passed to the row callback,
+*               bytes outside of frames are ASCII protocol / text (TakeText())
+*               frames: FRAME_SNAPSHOT, FRAME_RAW_SNAPSHOT, FRAME_BOARD_SNAPSHOT (one row), FRAME_BLOCK (one row per
+*               sample), CRC-16/CCITT-FALSE checked, lost frames counted by the sequence number
+*               ASCII: 'sx'<board>'e', 'sa'...'sd' (calibrated) / 'sf'...'si' (raw), one row per board and type
+*               (committed with the NTC value or when a channel repeats)
+*
+* \brief    time of a row [us since capture start]:
+*               frames: device time (micros() of the frame timestamp + block sample times), the 32-bit device time is
+*               unwrapped and anchored to the host time of the first frame
+*               the device time is anchored again to the host time after a reset of the MCU (time jumps back > 1s)
+*               or a pause of the frames > 30 min (wrap not detectable)
+*               ASCII: host time of the received buffer
+*
+* \par     Editor
+*           17.10.2026 first implementation: capture tool: frame / ASCII decoder
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_FrameDecoder_H_
+#define _RL021_FrameDecoder_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/// frame format, see firmware/DigitalLoadExample/RL021_Protocol.h
+#define RL021_FRAME_SYNC1           0xA5
+#define RL021_FRAME_SYNC2           0x5A
+#define RL021_FRAME_VERSION         1
+#define RL021_FRAME_HEADER_SIZE     11
+#define RL021_FRAME_CRC_SIZE        2
+#define RL021_FRAME_SNAPSHOT        1
+#define RL021_FRAME_RAW_SNAPSHOT    2
+#define RL021_FRAME_BLOCK           3
+#define RL021_FRAME_BOARD_SNAPSHOT  4
+/// FRAME_BLOCK channel mask / FRAME_BOARD_SNAPSHOT board number flag: raw ADC values
+#define RL021_FRAME_RAW             0x80
+
+/// channels of a row (current, Vload, Vext, NTC)
+#define RL021_ROW_CHANNELS          4
+/// S_RL021_LogRow::mask flag: raw ADC values
+#define RL021_ROW_RAW               0x80
+
+/// device time jumping back more than this: MCU reset [us]
+#define RL021_DECODER_RESET_US      1000000
+/// frames paused longer than this: device time anchored again [us]
+#define RL021_DECODER_PAUSE_US      (30ULL * 60 * 1000000)
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+/// One sample of one board
+typedef struct
+{
+    /// [us since capture start]
+    uint64_t time_us;
+    uint8_t board;
+    /// channels of the row (1<<E_ADC_CHANNEL), RL021_ROW_RAW: raw ADC values
+    uint8_t mask;
+    /// current [mA], Vload [mV], Vext [mV], NTC [°C x10] / raw ADC values (channels of the mask only)
+    int32_t value[RL021_ROW_CHANNELS];
+
+} S_RL021_LogRow;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t crcErrors;
+    uint32_t lostFrames;
+    uint32_t rows;
+    /// device time anchored again (reset, pause)
+    uint32_t timeAnchors;
+
+} S_RL021_DecoderStatistics;
+
+typedef void (*RL021_RowCallback)(const S_RL021_LogRow * row, void * context);
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_FrameDecoder {
+
+ public:
+    RL021_FrameDecoder(RL021_RowCallback newCallback, void * newContext);
+
+    /// Decode received bytes - host_us: host time of the buffer [us since capture start]
+    void Decode(const uint8_t * data, size_t size, uint64_t host_us);
+
+    /// ASCII bytes since the last call (text and ASCII protocol)
+    std::string TakeText();
+
+    const S_RL021_DecoderStatistics * GetStatistics();
+
+    /// CRC-16/CCITT-FALSE (crc: 0xFFFF or CRC of the previous part)
+    static uint16_t CRC16(const uint8_t * data, size_t length, uint16_t crc = 0xFFFF);
+
+ private:
+    /// returns true if the byte belongs to a binary frame
+    bool FrameByte(uint8_t value);
+    void ProcessFrame();
+    void AsciiByte(char value);
+    void AsciiValue(char type, int32_t value);
+
+    /// 32-bit device time -> [us since capture start]
+    uint64_t DeviceTime(uint32_t timestamp_us);
+    void Emit(S_RL021_LogRow * row);
+
+    uint16_t Get16(size_t offset);
+    /// returns false if the varint exceeds the payload
+    bool GetVarint(size_t * offset, size_t end, uint32_t * value);
+
+    RL021_RowCallback callback;
+    void * context;
+    uint64_t hostTime_us;
+
+    uint8_t frame[RL021_FRAME_HEADER_SIZE + 255 + RL021_FRAME_CRC_SIZE];
+    size_t frameIndex;
+    size_t frameSize;
+    int32_t lastSequence;
+
+    /// device time
+    bool anchored;
+    uint32_t lastTimestamp_us;
+    uint64_t deviceTime_us;
+    uint64_t lastFrameHost_us;
+
+    /// ASCII protocol
+    bool asciiCommand;
+    char asciiType;
+    bool asciiNegative;
+    int32_t asciiNumber;
+    uint8_t asciiBoard;
+    S_RL021_LogRow asciiRow;
+    std::string text;
+
+    S_RL021_DecoderStatistics statistics;
+};
+
+#endif /* _RL021_FrameDecoder_H_ */
@@ -0,0 +1,625 @@
+#include "RL021_LogFile.h"
+
+#include <string.h>
+
+static const uint8_t FILE_MAGIC[4] = {'R', 'L', '2', '1'};
+static const uint8_t CHUNK_MAGIC[4] = {'C', 'H', 'N', 'K'};
+static const uint8_t INDEX_MAGIC[4] = {'I', 'N', 'D', 'X'};
+static const uint8_t TRAILER_MAGIC[4] = {'R', 'L', 'I', 'X'};
+
+/// offset of the CRC in the chunk header
+#define CHUNK_OFFSET_CRC    30
+
+
+/************************************************************************************************************************************************/
+/* Encoding
+/************************************************************************************************************************************************/
+static void Put16(uint8_t * data, uint16_t value)
+{
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+static void Put32(uint8_t * data, uint32_t value)
+{
+    Put16(data, value & 0xFFFF);
+    Put16(data + 2, value >> 16);
+}
+
+static void Put64(uint8_t * data, uint64_t value)
+{
+    Put32(data, value & 0xFFFFFFFF);
+    Put32(data + 4, value >> 32);
+}
+
+static uint16_t Get16(const uint8_t * data)
+{
+    return data[0] | ((uint16_t)data[1] << 8);
+}
+
+static uint32_t Get32(const uint8_t * data)
+{
+    return Get16(data) | ((uint32_t)Get16(data + 2) << 16);
+}
+
+static uint64_t Get64(const uint8_t * data)
+{
+    return Get32(data) | ((uint64_t)Get32(data + 4) << 32);
+}
+
+static void PutVarint(std::vector<uint8_t> * data, uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        data->push_back((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    data->push_back(value);
+}
+
+/// returns false if the varint exceeds end
+static bool GetVarint(const uint8_t ** data, const uint8_t * end, uint64_t * value)
+{
+    *value = 0;
+    for(uint8_t shift=0;shift<64;shift+=7)
+    {
+        if(*data >= end)
+        {
+            return false;
+        }
+        uint8_t b = *(*data)++;
+        *value |= (uint64_t)(b & 0x7F) << shift;
+        if(!(b & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t ZigZag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t UnZigZag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/// chunk / index header (CRC not set)
+static void PutHeader(uint8_t * header, const uint8_t * magic, const S_RL021_LogIndexEntry * entry, uint32_t payloadLength)
+{
+    memset(header, 0, RL021_LOG_CHUNK_HEADER);
+    memcpy(header, magic, 4);
+    header[4] = entry->board;
+    header[5] = entry->mask;
+    Put16(&header[6], entry->rows);
+    Put64(&header[8], entry->firstTime_us);
+    Put64(&header[16], entry->lastTime_us);
+    Put32(&header[24], payloadLength);
+}
+
+static uint16_t ChunkCRC(const uint8_t * header, const uint8_t * payload, uint32_t payloadLength)
+{
+    uint16_t crc = RL021_FrameDecoder::CRC16(&header[4], CHUNK_OFFSET_CRC - 4);
+    return RL021_FrameDecoder::CRC16(payload, payloadLength, crc);
+}
+
+
+/************************************************************************************************************************************************/
+/*  Writer
+/************************************************************************************************************************************************/
+RL021_LogWriter::RL021_LogWriter()
+{
+    file = NULL;
+    span_us = RL021_LOG_CHUNK_SPAN_US;
+    maxRows = RL021_LOG_CHUNK_ROWS;
+    rowCount = 0;
+    bytes = 0;
+
+    for(uint8_t i=0;i<RL021_LOG_OPEN_CHUNKS;i++)
+    {
+        chunks[i].used = false;
+    }
+}
+
+RL021_LogWriter::~RL021_LogWriter()
+{
+    if(file != NULL)
+    {
+        Close();
+    }
+}
+
+bool RL021_LogWriter::Open(const char * path, uint64_t start_us)
+{
+    file = fopen(path, "wb");
+    if(file == NULL)
+    {
+        return false;
+    }
+
+    uint8_t header[RL021_LOG_FILE_HEADER] = {0};
+    memcpy(header, FILE_MAGIC, 4);
+    header[4] = RL021_LOG_VERSION;
+    Put64(&header[8], start_us);
+    return Write(header, sizeof(header));
+}
+
+void RL021_LogWriter::SetChunkLimits(uint64_t newSpan_us, uint16_t rows)
+{
+    span_us = newSpan_us;
+    maxRows = (rows > 0) ? rows : 1;
+}
+
+/************************************************************************************************************************************************/
+/* Public - writer
+/************************************************************************************************************************************************/
+/** Add row to the open chunk of its stream (board, mask)
+ *  Chunks of other streams are written if they span chunkSpan_us up to this row (stream stopped).
+ *
+ *  @param const S_RL021_LogRow * row -
+ *	@return bool - (false): write error
+ */
+bool RL021_LogWriter::Add(const S_RL021_LogRow * row)
+{
+    S_Chunk * chunk = NULL;
+    S_Chunk * slot = NULL;
+    bool ok = true;
+
+    for(uint8_t i=0;i<RL021_LOG_OPEN_CHUNKS;i++)
+    {
+        S_Chunk * open = &chunks[i];
+        if(open->used && (int64_t)(row->time_us - open->firstTime_us) >= (int64_t)span_us)
+        {
+            ok &= WriteChunk(open);
+        }
+
+        if(open->used && open->board == row->board && open->mask == row->mask)
+        {
+            chunk = open;
+        }
+        /// free slot, otherwise the chunk with the oldest data
+        if(slot == NULL || (slot->used && (!open->used || open->firstTime_us < slot->firstTime_us)))
+        {
+            slot = open;
+        }
+    }
+
+    if(chunk != NULL && chunk->rows >= maxRows)
+    {
+        ok &= WriteChunk(chunk);
+    }
+    if(chunk == NULL)
+    {
+        chunk = slot;
+        if(chunk->used)
+        {
+            ok &= WriteChunk(chunk);
+        }
+    }
+    if(!chunk->used)
+    {
+        chunk->used = true;
+        chunk->board = row->board;
+        chunk->mask = row->mask;
+        chunk->rows = 0;
+        chunk->firstTime_us = row->time_us;
+        chunk->lastTime_us = row->time_us;
+        chunk->lastDelta_us = 0;
+    }
+
+    /// time column
+    int64_t delta_us = (int64_t)(row->time_us - chunk->lastTime_us);
+    if(chunk->rows == 1)
+    {
+        PutVarint(&chunk->column[0], ZigZag(delta_us));
+    }
+    else if(chunk->rows > 1)
+    {
+        PutVarint(&chunk->column[0], ZigZag(delta_us - chunk->lastDelta_us));
+    }
+    chunk->lastDelta_us = delta_us;
+    chunk->lastTime_us = row->time_us;
+
+    /// channel columns
+    for(uint8_t ch=0;ch<RL021_ROW_CHANNELS;ch++)
+    {
+        if(chunk->mask & (1<<ch))
+        {
+            int64_t value = row->value[ch];
+            PutVarint(&chunk->column[1 + ch], ZigZag((chunk->rows == 0) ? value : value - chunk->last[ch]));
+            chunk->last[ch] = row->value[ch];
+        }
+    }
+
+    chunk->rows++;
+    rowCount++;
+    return ok;
+}
+
+bool RL021_LogWriter::Flush()
+{
+    bool ok = true;
+    for(uint8_t i=0;i<RL021_LOG_OPEN_CHUNKS;i++)
+    {
+        if(chunks[i].used)
+        {
+            ok &= WriteChunk(&chunks[i]);
+        }
+    }
+    return ok;
+}
+
+/** Write open chunks, index of all chunks and trailer, close file
+ *
+ *  @param /
+ *	@return bool - (false): write error (the chunks written before are readable without index)
+ */
+bool RL021_LogWriter::Close()
+{
+    if(file == NULL)
+    {
+        return false;
+    }
+
+    bool ok = Flush();
+
+    S_RL021_LogIndexEntry capture;
+    memset(&capture, 0, sizeof(capture));
+    for(size_t i=0;i<index.size();i++)
+    {
+        if(i == 0 || index[i].firstTime_us < capture.firstTime_us)
+        {
+            capture.firstTime_us = index[i].firstTime_us;
+        }
+        if(i == 0 || index[i].lastTime_us > capture.lastTime_us)
+        {
+            capture.lastTime_us = index[i].lastTime_us;
+        }
+    }
+
+    std::vector<uint8_t> payload(index.size() * RL021_LOG_INDEX_ENTRY);
+    for(size_t i=0;i<index.size();i++)
+    {
+        uint8_t * entry = &payload[i * RL021_LOG_INDEX_ENTRY];
+        Put64(&entry[0], index[i].offset);
+        entry[8] = index[i].board;
+        entry[9] = index[i].mask;
+        Put16(&entry[10], index[i].rows);
+        Put64(&entry[12], index[i].firstTime_us);
+        Put64(&entry[20], index[i].lastTime_us);
+    }
+
+    uint64_t indexOffset = bytes;
+    uint8_t header[RL021_LOG_CHUNK_HEADER];
+    PutHeader(header, INDEX_MAGIC, &capture, payload.size());
+    Put16(&header[CHUNK_OFFSET_CRC], ChunkCRC(header, payload.data(), payload.size()));
+
+    uint8_t trailer[RL021_LOG_TRAILER] = {0};
+    memcpy(trailer, TRAILER_MAGIC, 4);
+    Put64(&trailer[8], indexOffset);
+
+    ok = ok && Write(header, sizeof(header)) && Write(payload.data(), payload.size()) && Write(trailer, sizeof(trailer));
+    ok &= (fclose(file) == 0);
+    file = NULL;
+    return ok;
+}
+
+uint32_t RL021_LogWriter::GetChunks()
+{
+    return index.size();
+}
+
+uint64_t RL021_LogWriter::GetRows()
+{
+    return rowCount;
+}
+
+uint64_t RL021_LogWriter::GetBytes()
+{
+    return bytes;
+}
+
+/************************************************************************************************************************************************/
+/* Private - writer
+/************************************************************************************************************************************************/
+bool RL021_LogWriter::WriteChunk(S_Chunk * chunk)
+{
+    std::vector<uint8_t> payload;
+    for(uint8_t column=0;column<=RL021_ROW_CHANNELS;column++)
+    {
+        if(column == 0 || (chunk->mask & (1<<(column-1))))
+        {
+            PutVarint(&payload, chunk->column[column].size());
+            payload.insert(payload.end(), chunk->column[column].begin(), chunk->column[column].end());
+        }
+        chunk->column[column].clear();
+    }
+    chunk->used = false;
+
+    S_RL021_LogIndexEntry entry;
+    entry.offset = bytes;
+    entry.board = chunk->board;
+    entry.mask = chunk->mask;
+    entry.rows = chunk->rows;
+    entry.firstTime_us = chunk->firstTime_us;
+    entry.lastTime_us = chunk->lastTime_us;
+
+    uint8_t header[RL021_LOG_CHUNK_HEADER];
+    PutHeader(header, CHUNK_MAGIC, &entry, payload.size());
+    Put16(&header[CHUNK_OFFSET_CRC], ChunkCRC(header, payload.data(), payload.size()));
+
+    if(!Write(header, sizeof(header)) || !Write(payload.data(), payload.size()) || fflush(file) != 0)
+    {
+        return false;
+    }
+    index.push_back(entry);
+    return true;
+}
+
+bool RL021_LogWriter::Write(const uint8_t * data, size_t size)
+{
+    if(size > 0 && fwrite(data, 1, size, file) != size)
+    {
+        return false;
+    }
+    bytes += size;
+    return true;
+}
+
+
+/************************************************************************************************************************************************/
+/*  Reader
+/************************************************************************************************************************************************/
+RL021_LogReader::RL021_LogReader()
+{
+    file = NULL;
+    start_us = 0;
+    size = 0;
+    trailer = false;
+}
+
+RL021_LogReader::~RL021_LogReader()
+{
+    Close();
+}
+
+/** Open log file and read its time index
+ *
+ *  @param const char * path -
+ *	@return bool - (false): no log file / other version
+ */
+bool RL021_LogReader::Open(const char * path)
+{
+    Close();
+    file = fopen(path, "rb");
+    if(file == NULL)
+    {
+        return false;
+    }
+
+    uint8_t header[RL021_LOG_FILE_HEADER];
+    if(fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, FILE_MAGIC, 4) != 0 || header[4] != RL021_LOG_VERSION)
+    {
+        Close();
+        return false;
+    }
+    start_us = Get64(&header[8]);
+
+    fseeko(file, 0, SEEK_END);
+    size = ftello(file);
+
+    trailer = ReadIndex();
+    if(!trailer)
+    {
+        ScanChunks();
+    }
+    return true;
+}
+
+void RL021_LogReader::Close()
+{
+    if(file != NULL)
+    {
+        fclose(file);
+        file = NULL;
+    }
+    index.clear();
+}
+
+uint64_t RL021_LogReader::GetStart()
+{
+    return start_us;
+}
+
+bool RL021_LogReader::HasTrailer()
+{
+    return trailer;
+}
+
+size_t RL021_LogReader::GetChunkCount()
+{
+    return index.size();
+}
+
+const S_RL021_LogIndexEntry * RL021_LogReader::GetChunk(size_t chunk)
+{
+    return (chunk < index.size()) ? &index[chunk] : NULL;
+}
+
+/************************************************************************************************************************************************/
+/* Public - reader
+/************************************************************************************************************************************************/
+/** Read and decode one chunk
+ *
+ *  @param size_t chunk - number of the index
+ *  @param std::vector<S_RL021_LogRow> * rows - rows are appended
+ *	@return bool - (false): truncated chunk, CRC error or inconsistent columns (no rows appended)
+ */
+bool RL021_LogReader::ReadChunk(size_t chunk, std::vector<S_RL021_LogRow> * rows)
+{
+    if(chunk >= index.size())
+    {
+        return false;
+    }
+
+    uint8_t header[RL021_LOG_CHUNK_HEADER];
+    if(fseeko(file, index[chunk].offset, SEEK_SET) != 0 || fread(header, 1, sizeof(header), file) != sizeof(header) ||
+       memcmp(header, CHUNK_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+
+    uint32_t payloadLength = Get32(&header[24]);
+    std::vector<uint8_t> payload(payloadLength);
+    if(fread(payload.data(), 1, payloadLength, file) != payloadLength ||
+       ChunkCRC(header, payload.data(), payloadLength) != Get16(&header[CHUNK_OFFSET_CRC]))
+    {
+        return false;
+    }
+
+    S_RL021_LogRow row;
+    memset(&row, 0, sizeof(row));
+    row.board = header[4];
+    row.mask = header[5];
+    uint16_t count = Get16(&header[6]);
+    uint64_t firstTime_us = Get64(&header[8]);
+
+    size_t first = rows->size();
+    rows->resize(first + count, row);
+
+    const uint8_t * p = payload.data();
+    const uint8_t * end = p + payloadLength;
+
+    for(uint8_t column=0;column<=RL021_ROW_CHANNELS;column++)
+    {
+        if(column > 0 && !(row.mask & (1<<(column-1))))
+        {
+            continue;
+        }
+
+        uint64_t length;
+        if(!GetVarint(&p, end, &length) || length > (uint64_t)(end - p))
+        {
+            rows->resize(first);
+            return false;
+        }
+        const uint8_t * columnEnd = p + length;
+
+        int64_t value = 0;
+        int64_t delta = 0;
+        for(uint16_t n=0;n<count;n++)
+        {
+            uint64_t encoded = 0;
+            if((column > 0 || n > 0) && !GetVarint(&p, columnEnd, &encoded))
+            {
+                rows->resize(first);
+                return false;
+            }
+
+            S_RL021_LogRow * target = &(*rows)[first + n];
+            if(column == 0)
+            {
+                /// row 0: header, row 1: delta, rows 2...: delta of the delta
+                delta = (n == 1) ? UnZigZag(encoded) : delta + UnZigZag(encoded);
+                value = (n == 0) ? (int64_t)firstTime_us : value + delta;
+                target->time_us = value;
+            }
+            else
+            {
+                value = (n == 0) ? UnZigZag(encoded) : value + UnZigZag(encoded);
+                target->value[column-1] = (int32_t)value;
+            }
+        }
+        p = columnEnd;
+    }
+    return true;
+}
+
+/************************************************************************************************************************************************/
+/* Private - reader
+/************************************************************************************************************************************************/
+/** Index of the trailer (capture closed)
+ *
+ *  @param /
+ *	@return bool - (false): no trailer or index invalid
+ */
+bool RL021_LogReader::ReadIndex()
+{
+    uint8_t data[RL021_LOG_TRAILER];
+    if(size < RL021_LOG_FILE_HEADER + RL021_LOG_CHUNK_HEADER + RL021_LOG_TRAILER ||
+       fseeko(file, size - RL021_LOG_TRAILER, SEEK_SET) != 0 || fread(data, 1, sizeof(data), file) != sizeof(data) ||
+       memcmp(data, TRAILER_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+
+    uint64_t offset = Get64(&data[8]);
+    uint8_t header[RL021_LOG_CHUNK_HEADER];
+    if(offset > size - RL021_LOG_TRAILER - RL021_LOG_CHUNK_HEADER || fseeko(file, offset, SEEK_SET) != 0 ||
+       fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, INDEX_MAGIC, 4) != 0)
+    {
+        return false;
+    }
+
+    uint32_t payloadLength = Get32(&header[24]);
+    if(payloadLength % RL021_LOG_INDEX_ENTRY != 0 || offset + RL021_LOG_CHUNK_HEADER + payloadLength > size - RL021_LOG_TRAILER)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> payload(payloadLength);
+    if(fread(payload.data(), 1, payloadLength, file) != payloadLength ||
+       ChunkCRC(header, payload.data(), payloadLength) != Get16(&header[CHUNK_OFFSET_CRC]))
+    {
+        return false;
+    }
+
+    index.resize(payloadLength / RL021_LOG_INDEX_ENTRY);
+    for(size_t i=0;i<index.size();i++)
+    {
+        const uint8_t * entry = &payload[i * RL021_LOG_INDEX_ENTRY];
+        index[i].offset = Get64(&entry[0]);
+        index[i].board = entry[8];
+        index[i].mask = entry[9];
+        index[i].rows = Get16(&entry[10]);
+        index[i].firstTime_us = Get64(&entry[12]);
+        index[i].lastTime_us = Get64(&entry[20]);
+    }
+    return true;
+}
+
+/** Index of the chunk headers (capture killed / not closed): header by header up to the first truncated chunk
+ *
+ *  @param /
+ *	@return /
+ */
+void RL021_LogReader::ScanChunks()
+{
+    uint64_t offset = RL021_LOG_FILE_HEADER;
+    uint8_t header[RL021_LOG_CHUNK_HEADER];
+
+    index.clear();
+    while(offset + RL021_LOG_CHUNK_HEADER <= size && fseeko(file, offset, SEEK_SET) == 0 &&
+          fread(header, 1, sizeof(header), file) == sizeof(header) && memcmp(header, CHUNK_MAGIC, 4) == 0)
+    {
+        uint32_t payloadLength = Get32(&header[24]);
+        if(offset + RL021_LOG_CHUNK_HEADER + payloadLength > size)
+        {
+            break;
+        }
+
+        S_RL021_LogIndexEntry entry;
+        entry.offset = offset;
+        entry.board = header[4];
+        entry.mask = header[5];
+        entry.rows = Get16(&header[6]);
+        entry.firstTime_us = Get64(&header[8]);
+        entry.lastTime_us = Get64(&header[16]);
+        index.push_back(entry);
+
+        offset += RL021_LOG_CHUNK_HEADER + payloadLength;
+    }
+}
@@ -0,0 +1,178 @@
+/**
+* \file    RL021_LogFile.h
+* \brief    Capture log: chunked columnar file of S_RL021_LogRow, delta / varint encoded, time index, CRC per chunk
+* \brief    Required drivers: RL021_FrameDecoder.h (S_RL021_LogRow, CRC16)
+*
+* \brief    file format (version 1, all values little endian):
+*               file header (16 bytes):
+*               offset  size  content
+*               0       4     magic "RL21"
+*               4       1     format version
+*               5       3     reserved (0)
+*               8       8     capture start, unix time [us]
+*
+*               chunks (RL021_LOG_CHUNK_HEADER bytes + payload), rows of one stream (board, channel mask incl. raw flag):
+*               0       4     magic "CHNK"
+*               4       1     board
+*               5       1     channel mask (bit 7: raw values)
+*               6       2     rows
+*               8       8     time of the first row [us since capture start]
+*               16      8     time of the last row
+*               24      4     payload length
+*               28      2     reserved (0)
+*               30      2     CRC-16/CCITT-FALSE over offset 4 ... 29 and the payload
+*               payload: time column, one column per channel of the mask (ascending), each column:
+*                        column length (varint), zigzag varints
+*                        time:    row 1: delta to row 0, rows 2...: delta of the delta (0 at a constant sample rate)
+*                        channel: row 0: value, rows 1...: delta to the previous row
+*
+*               index (written by Close(), optional): chunk header with magic "INDX", board / mask / rows 0, times of
+*               the whole capture, payload RL021_LOG_INDEX_ENTRY bytes per chunk: offset (8), board (1), mask (1),
+*               rows (2), first time (8), last time (8)
+*               trailer (16 bytes, end of file): magic "RLIX", reserved (4), offset of the index (8)
+*
+* \brief    basic functions:
+*               writer: one open chunk per stream (max. RL021_LOG_OPEN_CHUNKS), a chunk is written (and the file
+*                       flushed) if it spans chunkSpan_us or has maxRows rows - a killed capture loses at most the
+*                       open chunks
+*               reader: time index of the trailer, without trailer (capture killed) the chunk headers are read one
+*                       after the other (header + seek, payloads are not read) up to the first truncated chunk
+*                       seek by time: only the chunks of the index overlapping the time range are read and checked
+*
+* \brief    size: snapshot 1/s of 4 channels ~6 bytes per row (~0.5 MB per day), stream of 4 channels at 240 rows/s
+*           (12-bit, noise of a few LSB) ~6 bytes per row (~125 MB per day)
+*
+* \par     Editor
+*           17.10.2026 first implementation: capture tool: chunked columnar log file
+*
+* \todo
+* \version V0.1
+*/
+
+#ifndef _RL021_LogFile_H_
+#define _RL021_LogFile_H_
+
+#include <stdio.h>
+#include <vector>
+
+#include "RL021_FrameDecoder.h"
+
+#define RL021_LOG_VERSION           1
+#define RL021_LOG_FILE_HEADER       16
+#define RL021_LOG_CHUNK_HEADER      32
+#define RL021_LOG_INDEX_ENTRY       28
+#define RL021_LOG_TRAILER           16
+
+/// streams with an open chunk (boards x calibrated / raw x channel masks)
+#define RL021_LOG_OPEN_CHUNKS       16
+/// default limits of a chunk
+#define RL021_LOG_CHUNK_SPAN_US     (60ULL * 1000000)
+#define RL021_LOG_CHUNK_ROWS        16384
+
+
+/************************************************************************/
+/* Structs                                                              */
+/************************************************************************/
+/// Chunk of the time index
+typedef struct
+{
+    /// file offset of the chunk header
+    uint64_t offset;
+    uint8_t board;
+    uint8_t mask;
+    uint16_t rows;
+    /// [us since capture start]
+    uint64_t firstTime_us;
+    uint64_t lastTime_us;
+
+} S_RL021_LogIndexEntry;
+
+
+/************************************************************************/
+/* Class                                                                */
+/************************************************************************/
+class RL021_LogWriter {
+
+ public:
+    RL021_LogWriter();
+    ~RL021_LogWriter();
+
+    /// Create log file - start_us: unix time of the capture start
+    bool Open(const char * path, uint64_t start_us);
+    /// Chunk limits (time span [us], rows)
+    void SetChunkLimits(uint64_t span_us, uint16_t rows);
+
+    /// Add row to the chunk of its stream - returns false on a write error
+    bool Add(const S_RL021_LogRow * row);
+    /// Write all open chunks
+    bool Flush();
+    /// Write open chunks, index and trailer, close the file
+    bool Close();
+
+    /// chunks / rows / bytes written
+    uint32_t GetChunks();
+    uint64_t GetRows();
+    uint64_t GetBytes();
+
+ private:
+    typedef struct
+    {
+        bool used;
+        uint8_t board;
+        uint8_t mask;
+        uint16_t rows;
+        uint64_t firstTime_us;
+        uint64_t lastTime_us;
+        int64_t lastDelta_us;
+        int32_t last[RL021_ROW_CHANNELS];
+        std::vector<uint8_t> column[1 + RL021_ROW_CHANNELS];
+
+    } S_Chunk;
+
+    /// Write chunk, the slot is free afterwards
+    bool WriteChunk(S_Chunk * chunk);
+    bool Write(const uint8_t * data, size_t size);
+
+    FILE * file;
+    uint64_t span_us;
+    uint16_t maxRows;
+
+    S_Chunk chunks[RL021_LOG_OPEN_CHUNKS];
+    std::vector<S_RL021_LogIndexEntry> index;
+    uint64_t rowCount;
+    uint64_t bytes;
+};
+
+class RL021_LogReader {
+
+ public:
+    RL021_LogReader();
+    ~RL021_LogReader();
+
+    /// Open log, index of the trailer or of the chunk headers - returns false if no log file
+    bool Open(const char * path);
+    void Close();
+
+    /// unix time of the capture start [us]
+    uint64_t GetStart();
+    /// (true): index of the trailer, (false): index read from the chunk headers (capture not closed)
+    bool HasTrailer();
+
+    size_t GetChunkCount();
+    const S_RL021_LogIndexEntry * GetChunk(size_t chunk);
+
+    /// Rows of a chunk (appended) - returns false if the chunk is truncated or its CRC is wrong
+    bool ReadChunk(size_t chunk, std::vector<S_RL021_LogRow> * rows);
+
+ private:
+    bool ReadIndex();
+    void ScanChunks();
+
+    FILE * file;
+    uint64_t start_us;
+    uint64_t size;
+    bool trailer;
+    std::vector<S_RL021_LogIndexEntry> index;
+};
+
+#endif /* _RL021_LogFile_H_ */
@@ -0,0 +1,120 @@
+#!/bin/sh
+#
+# capture_test.sh - test of rl021_capture against the host simulation as stand-in of the board (-s)
+#
+#   builds rl021_capture and rl021_sim (firmware/HostSimulation) in a temporary directory, captures
+#   TEST_SECONDS simulated seconds of snapshots (telemetry once per second, first at 1s) and checks:
+#       row count, 0 CRC errors, 0 lost frames
+#       wrap of the 32-bit device timestamp (micros(), 2^32us = 4295s): export times increase by ~1s per row
+#       CSV export of a time range across the wrap: same rows as the full export filtered by time
+#       truncated log (capture killed): index from the chunk headers, rows of the complete chunks
+#       damaged chunk (CRC): reported, exit code 2
+#
+#   usage: ui/Capture/Test/capture_test.sh     exit code 0: passed, 1: failed
+#
+
+TEST_SECONDS=4500
+RANGE_FROM=4200
+RANGE_UNTIL=4400
+
+TEST_DIR=$(cd "$(dirname "$0")" && pwd)
+CAPTURE_DIR="$TEST_DIR/.."
+SIM_DIR="$TEST_DIR/../../../firmware/HostSimulation"
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+# Check <description> <test expression ...>
+Check()
+{
+    description=$1
+    shift
+    if "$@"; then
+        echo "ok      $description"
+    else
+        echo "FAILED  $description"
+        FAILED=1
+    fi
+}
+
+# Rows of a CSV export (without the header line)
+Rows()
+{
+    tail -n +2 "$1" | wc -l
+}
+
+echo "build"
+g++ -std=gnu++11 -O2 "$CAPTURE_DIR"/*.cpp -lutil -o "$WORK/rl021_capture" || exit 1
+(cd "$SIM_DIR" && g++ -std=gnu++11 -O2 -I. -I../DigitalLoadExample *.cpp ../DigitalLoadExample/*.cpp -o "$WORK/rl021_sim") || exit 1
+
+CAPTURE="$WORK/rl021_capture"
+LOG="$WORK/test.rl21"
+
+###############################################################################
+# Capture: binary frames from the start of the simulation (-c 1:bt), so the row count does not depend
+# on the time the capture's own "bt" arrives
+echo "capture $TEST_SECONDS simulated seconds"
+"$CAPTURE" -o "$LOG" -s "$WORK/rl021_sim -t $TEST_SECONDS -c 1:bt" 2> "$WORK/capture.txt"
+Check "capture exit code 0" test $? -eq 0
+cat "$WORK/capture.txt"
+Check "rows: $((TEST_SECONDS - 1))" grep -q "^$((TEST_SECONDS - 1)) rows," "$WORK/capture.txt"
+Check "0 CRC errors, 0 lost frames" grep -q "CRC errors 0, lost frames 0$" "$WORK/capture.txt"
+
+"$CAPTURE" -i "$LOG" > "$WORK/info.txt"
+Check "info: trailer, no damaged chunk" test $? -eq 0
+Check "info: index of the trailer" grep -q "^index: *trailer" "$WORK/info.txt"
+CHUNKS=$(sed -n 's/^chunks: *\([0-9]*\) .*/\1/p' "$WORK/info.txt")
+
+"$CAPTURE" -e "$LOG" > "$WORK/full.csv"
+Check "export: exit code 0" test $? -eq 0
+Check "export: $((TEST_SECONDS - 1)) rows" test "$(Rows "$WORK/full.csv")" -eq $((TEST_SECONDS - 1))
+
+###############################################################################
+# Timestamp wrap: every row ~1s after the previous one, last row after the wrap
+awk -F, 'NR > 2 && ($1 - last < 0.9 || $1 - last > 1.1) { bad++ } NR > 1 { last = $1 } END { exit (bad > 0 || last < 4295) }' "$WORK/full.csv"
+Check "timestamp wrap: rows 1s apart up to $((TEST_SECONDS - 2))s" test $? -eq 0
+
+###############################################################################
+# Time range
+"$CAPTURE" -e "$LOG" -f $RANGE_FROM -u $RANGE_UNTIL > "$WORK/range.csv"
+Check "export range: exit code 0" test $? -eq 0
+awk -F, -v from=$RANGE_FROM -v until=$RANGE_UNTIL 'NR == 1 || ($1 >= from && $1 <= until)' "$WORK/full.csv" > "$WORK/expected.csv"
+Check "export range ${RANGE_FROM}s ... ${RANGE_UNTIL}s: $(Rows "$WORK/range.csv") rows" test "$(Rows "$WORK/range.csv")" -eq $((RANGE_UNTIL - RANGE_FROM))
+Check "export range: rows of the full export in the range" cmp -s "$WORK/range.csv" "$WORK/expected.csv"
+
+###############################################################################
+# Truncated log: trailer, index and the end of the last chunk missing (capture killed while writing)
+SIZE=$(wc -c < "$LOG")
+cp "$LOG" "$WORK/truncated.rl21"
+truncate -s $((SIZE - 16 - 32 - 28 * CHUNKS - 100)) "$WORK/truncated.rl21"
+
+"$CAPTURE" -i "$WORK/truncated.rl21" > "$WORK/info_truncated.txt"
+Check "truncated: info exit code 0" test $? -eq 0
+Check "truncated: index of the chunk headers" grep -q "^index: *chunk headers" "$WORK/info_truncated.txt"
+Check "truncated: $((CHUNKS - 1)) complete chunks" grep -q "^chunks: *$((CHUNKS - 1)) (0 damaged)" "$WORK/info_truncated.txt"
+
+"$CAPTURE" -e "$WORK/truncated.rl21" > "$WORK/truncated.csv"
+Check "truncated: export exit code 0" test $? -eq 0
+TRUNCATED_ROWS=$(Rows "$WORK/truncated.csv")
+Check "truncated: $TRUNCATED_ROWS rows, fewer than the full log" test "$TRUNCATED_ROWS" -gt 0 -a "$TRUNCATED_ROWS" -lt $((TEST_SECONDS - 1))
+head -n $((TRUNCATED_ROWS + 1)) "$WORK/full.csv" > "$WORK/expected.csv"
+Check "truncated: rows equal to the start of the full log" cmp -s "$WORK/truncated.csv" "$WORK/expected.csv"
+
+###############################################################################
+# Damaged chunk: one payload byte of the first chunk changed
+cp "$LOG" "$WORK/damaged.rl21"
+printf '\377' | dd of="$WORK/damaged.rl21" bs=1 seek=$((16 + 32 + 4)) conv=notrunc 2> /dev/null
+
+"$CAPTURE" -i "$WORK/damaged.rl21" > "$WORK/info_damaged.txt"
+Check "damaged: info exit code 2" test $? -eq 2
+Check "damaged: 1 damaged chunk" grep -q "^chunks: *$CHUNKS (1 damaged)" "$WORK/info_damaged.txt"
+"$CAPTURE" -e "$WORK/damaged.rl21" > /dev/null 2>&1
+Check "damaged: export exit code 2" test $? -eq 2
+
+if [ $FAILED -ne 0 ]; then
+    echo "capture test FAILED"
+    exit 1
+fi
+echo "capture test passed"
+exit 0
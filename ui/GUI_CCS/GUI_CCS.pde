@@ -25,6 +25,8 @@ Serial myPort;      // The serial port
 
 boolean showGraph = false;
 
+boolean useBinaryProtocol = true; // (true): request binary frames from firmware ('b'), (false): ASCII protocol
+
 int SLIDER_POS_X = 50;
 
 int SLIDER_WIDTH = 200;
@@ -238,6 +240,14 @@ void setup()
   String portName = Serial.list()[0];
   myPort = new Serial(this, portName, 115200);
   
+  /// request binary frames, firmware without binary protocol keeps sending ASCII (both are parsed)
+  if(useBinaryProtocol)
+  {
+    myPort.write('b');
+  }
+  
+  /// serial data is parsed by its own thread (see serialReader())
+  thread("serialReader");
   
 }
 
@@ -263,72 +273,482 @@ void draw()
 int width = 800;                                                   //use this variable to controll screen widtt
 int height = 400;                                                  //use this variable to controll screen height 
 
-int[] data1 = new int[width];                                      //data1, data2 and data3 store the graph information, and must be as long has the width of the screen (pixels)
-int[] data2 = new int[width];                    
-int[] data3 = new int[width];
-int newDataPoint1 = 0;                                             //newDataPoint1, newDataPoint2 and newDataPoint3 are esentially buffers for incoming data
-int newDataPoint2 = 0;
-int newDataPoint3 = 0;
+long PLOT_TIME_US = 10000000;                                      //time span of the graph [us], one pixel column = PLOT_TIME_US / width
+
+/// traces of the calibrated channels (current [A], Vload [V], Vext [V], NTC [°C]), scaled to the range of the sliders
+String[] TRACE_SLIDER = {"sliderCurrent", "sliderVoltLoad", "sliderVoltExt", "sliderTemp"};
+float[] TRACE_UNIT = {1000.0, 1000.0, 1000.0, 10.0};
+int[] TRACE_COLOR = {#00FF00, #0000FF, #FFFF00, #FF0000};
+PlotTrace[] traces = new PlotTrace[4];
+
+int receivedSamples = 0;
+int sampleRate = 0;
+int sampleRateStart = 0;
+
 void draw()                                                        //the main routine (runs continuously until the program is ended)
 {
+  /// all samples parsed since the last frame: sliders show the newest values, the traces get every sample
+  drainSamples();
   
   if(showGraph == true)
   {
     background(0,0,100);                                         //set the background to white. There are RGB color selectors online if you'd like to find a better looking color
     stroke(0,0,0);                                                   //set the stroke (line) color to black
     strokeWeight(2);                                                 //set the stroke width (weight) for the axes
-    line(0,height/2,width,height/2);                                 //draw the x-axis line            
+    line(0,offsetY,width,offsetY);                                   //draw the x-axis line (minimum of the slider ranges)
     line(width/4,0,width/4,height);                                  //draw the y-axis line
     
-    float tY = cp5.getController("sliderTemp").getValue();
-    float vY = cp5.getController("sliderCurrent").getValue();
-    //****DATA HANDLING****//                                        //the following 3 variables are buffers for incoming informaion, set these variables to the data you would like to display
-    //*********************//  
-    newDataPoint1 = offsetY-(int)tY;                                          
-    newDataPoint2 = offsetY-(int)(vY*1000);          
-    newDataPoint3 = 0;                                               //because the third data buffer is set to a constant (0), you'll notice a blue line at the top of the window.
-    //*********************//
-    //*********************//
+    /// right edge: newest column of all traces (same time base)
+    long newestColumn = Long.MIN_VALUE;
+    for(int ch = 0; ch < 4; ch++)
+    {
+      if(traces[ch] != null && !traces[ch].empty)
+      {
+        newestColumn = Math.max(newestColumn, traces[ch].headColumn);
+      }
+    }
     
-    for(int i = 0; i < width-1; i++)                                 //each interation of draw, shift data points one pixel to the left to simulate a continuously moving graph
+    strokeWeight(1);                                                //set the stroke width (weight) for the actual graph
+    for(int ch = 0; ch < 4 && newestColumn != Long.MIN_VALUE; ch++)
     {
-      data1[i] = data1[i+1];
-      data2[i] = data2[i+1];
-      data3[i] = data3[i+1];
+      if(traces[ch] != null && !traces[ch].empty)
+      {
+        Controller slider = cp5.getController(TRACE_SLIDER[ch]);
+        stroke(TRACE_COLOR[ch]);
+        traces[ch].draw(newestColumn, slider.getMin(), slider.getMax());
+      }
     }
     
-    data1[width-1] = newDataPoint1;                                 //introduce the bufffered data into the rightmost data slot
-    data2[width-1] = newDataPoint2;
-    data3[width-1] = newDataPoint3;
+    fill(255);
+    text(sampleRate + " samples/s, dropped " + droppedSamples + ", lost frames " + lostFrames + ", CRC errors " + crcErrors, 10, height - 10);
+  }
+  else
+  {
+    background(100);
+  }
+  
+}    
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sample queue: filled by the serial reader thread, drained by draw()
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+int SAMPLE_QUEUE_SIZE = 65536;
+
+class Sample
+{
+  long time_us;      // device time (binary frames) / host time (ASCII protocol)
+  int channel;
+  boolean raw;
+  long value;
+  
+  Sample(long time_us, int channel, boolean raw, long value)
+  {
+    this.time_us = time_us;
+    this.channel = channel;
+    this.raw = raw;
+    this.value = value;
+  }
+}
+
+java.util.concurrent.ArrayBlockingQueue<Sample> sampleQueue = new java.util.concurrent.ArrayBlockingQueue<Sample>(SAMPLE_QUEUE_SIZE);
+volatile int droppedSamples = 0;
+
+/// reader thread: queue full (UI stalled) -> sample dropped
+void queueSample(long time_us, int channel, boolean raw, long value)
+{
+  if(!sampleQueue.offer(new Sample(time_us, channel, raw, value)))
+  {
+    droppedSamples++;
+  }
+}
+
+long[] latestValue = new long[8];
+boolean[] latestNew = new boolean[8];
+/// slider update order: current last (power uses the load voltage of the same frame)
+int[] SLIDER_ORDER = {1, 2, 3, 0, 4, 5, 6, 7};
+
+void drainSamples()
+{
+  Sample sample;
+  while((sample = sampleQueue.poll()) != null)
+  {
+    int index = sample.channel + (sample.raw ? 4 : 0);
+    latestValue[index] = sample.value;
+    latestNew[index] = true;
+    receivedSamples++;
     
-    strokeWeight(2);                                                //set the stroke width (weight) for the actual graph
+    if(!sample.raw)
+    {
+      if(traces[sample.channel] == null)
+      {
+        traces[sample.channel] = new PlotTrace(width, PLOT_TIME_US / width);
+      }
+      traces[sample.channel].add(sample.time_us, sample.value / TRACE_UNIT[sample.channel]);
+    }
+  }
+  
+  for(int i = 0; i < 8; i++)
+  {
+    int index = SLIDER_ORDER[i];
+    if(latestNew[index])
+    {
+      latestNew[index] = false;
+      actSerialCommand((char)((index < 4 ? 'a' : 'f') + (index % 4)), latestValue[index]);
+    }
+  }
+  
+  if(millis() - sampleRateStart >= 1000)
+  {
+    sampleRate = receivedSamples;
+    receivedSamples = 0;
+    sampleRateStart = millis();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Plot trace: circular buffer of pixel columns, min / max of all samples of a column (no shifting)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+class PlotTrace
+{
+  int columns;
+  long columnTime_us;
+  float[] low;
+  float[] high;
+  float[] first;
+  float[] last;
+  int[] count;
+  long headColumn;   // column number (time / columnTime_us) of the newest sample
+  boolean empty = true;
+  
+  PlotTrace(int columns, long columnTime_us)
+  {
+    this.columns = columns;
+    this.columnTime_us = Math.max(columnTime_us, 1);
+    low = new float[columns];
+    high = new float[columns];
+    first = new float[columns];
+    last = new float[columns];
+    count = new int[columns];
+  }
+  
+  int index(long column)
+  {
+    return (int)Math.floorMod(column, (long)columns);
+  }
+  
+  void add(long time_us, float value)
+  {
+    long column = time_us / columnTime_us;
+    
+    if(empty || column <= headColumn - columns)
+    {
+      /// first sample / time restarted (device reset, protocol switched)
+      java.util.Arrays.fill(count, 0);
+      headColumn = column;
+      empty = false;
+    }
+    else if(column > headColumn)
+    {
+      /// clear the columns between the newest sample and this one (at most the whole buffer)
+      for(long c = headColumn + 1; c <= column && c <= headColumn + columns; c++)
+      {
+        count[index(c)] = 0;
+      }
+      headColumn = column;
+    }
     
-    for(int i = width-1; i > 0; i--)                                
+    int i = index(column);
+    if(count[i] == 0)
     {
-      stroke(255,0,0);
-      line(i,data1[i-1], i+1, data1[i]);
-      stroke(0,255,0);
-      line(i,data2[i-1], i+1, data2[i]);
-      stroke(0,0,255);
-      line(i,data3[i-1], i+1, data3[i]); 
+      low[i] = value;
+      high[i] = value;
+      first[i] = value;
     }
+    else
+    {
+      low[i] = Math.min(low[i], value);
+      high[i] = Math.max(high[i], value);
+    }
+    last[i] = value;
+    count[i]++;
+  }
   
+  float plotY(float value, float minimum, float maximum)
+  {
+    float range = (maximum > minimum) ? maximum - minimum : 1;
+    return offsetY - constrain((value - minimum) / range, 0, 1) * (offsetY - 20);
   }
-  else
+  
+  /// one vertical line min...max per column, columns connected last -> first value (empty columns bridged)
+  void draw(long newestColumn, float minimum, float maximum)
   {
-    background(100);
+    float lastX = -1;
+    float lastY = 0;
+    
+    for(int x = 0; x < columns; x++)
+    {
+      long column = newestColumn - columns + 1 + x;
+      if(column > headColumn || column <= headColumn - columns)
+      {
+        continue;
+      }
+      
+      int i = index(column);
+      if(count[i] == 0)
+      {
+        continue;
+      }
+      
+      if(lastX >= 0)
+      {
+        line(lastX, lastY, x, plotY(first[i], minimum, maximum));
+      }
+      line(x, plotY(low[i], minimum, maximum), x, plotY(high[i], minimum, maximum));
+      lastX = x;
+      lastY = plotY(last[i], minimum, maximum);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Serial reader thread: whole buffers are parsed off the UI thread, values go to the sample queue
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+StringBuilder consoleText = new StringBuilder();
+
+void serialReader()
+{
+  while(true)
+  {
+    if(myPort.available() > 0)
+    {
+      byte[] data = myPort.readBytes();
+      if(data != null)
+      {
+        parseBuffer(data);
+      }
+    }
+    else
+    {
+      try
+      {
+        Thread.sleep(1);
+      }
+      catch(InterruptedException e)
+      {
+        return;
+      }
+    }
+  }
+}
+
+void parseBuffer(byte[] data)
+{
+  for(int i = 0; i < data.length; i++)
+  {
+    int inByte = data[i] & 0xFF;
+    
+    /// binary frames are consumed by the frame parser, all other bytes are ASCII protocol
+    if(!handleFrameByte(inByte))
+    {
+      char inChar = (char)inByte;
+      consoleText.append(inChar);
+      handleSerialCommand(inChar);
+    }
   }
   
-}    
+  /// console output once per buffer
+  if(consoleText.length() > 0)
+  {
+    print(consoleText);
+    consoleText.setLength(0);
+  }
+}
+
+/// host time of ASCII values [us]
+long hostTime_us()
+{
+  return System.nanoTime() / 1000;
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
-void serialEvent(Serial myPort) 
+// Binary frame protocol (see firmware RL021_Protocol.h)
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+final int FRAME_SYNC1 = 0xA5;
+final int FRAME_SYNC2 = 0x5A;
+final int FRAME_VERSION = 1;
+final int FRAME_HEADER_SIZE = 11;
+final int FRAME_SNAPSHOT = 1;
+final int FRAME_RAW_SNAPSHOT = 2;
+final int FRAME_BLOCK = 3;
+final int BLOCK_RAW = 0x80;
+
+int[] frameBuffer = new int[FRAME_HEADER_SIZE + 255 + 2];
+int frameIndex = 0;
+int frameSize = 0;
+int lastSequence = -1;
+int lostFrames = 0;
+int crcErrors = 0;
+
+/// returns true if the byte belongs to a binary frame
+boolean handleFrameByte(int b)
 {
-  //int inByte = myPort.read();  
-  char inChar = myPort.readChar();
-  print(inChar);
-  handleSerialCommand(inChar);
+  if(frameIndex == 0)
+  {
+    if(b != FRAME_SYNC1)
+    {
+      return false;
+    }
+  }
+  else if(frameIndex == 1 && b != FRAME_SYNC2)
+  {
+    /// no frame: sync byte is not an ASCII character, drop it
+    frameIndex = 0;
+    return (b == FRAME_SYNC1) ? handleFrameByte(b) : false;
+  }
+  
+  frameBuffer[frameIndex++] = b;
+  
+  if(frameIndex == 5)
+  {
+    frameSize = FRAME_HEADER_SIZE + b + 2;
+  }
   
+  if(frameIndex > 5 && frameIndex == frameSize)
+  {
+    processFrame();
+    frameIndex = 0;
+  }
+  return true;
+}
+
+/// CRC-16/CCITT-FALSE
+int crc16(int[] data, int offset, int length)
+{
+  int crc = 0xFFFF;
+  for(int i = offset; i < offset + length; i++)
+  {
+    crc ^= (data[i] << 8);
+    for(int bit = 0; bit < 8; bit++)
+    {
+      crc = ((crc & 0x8000) != 0) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+      crc &= 0xFFFF;
+    }
+  }
+  return crc;
+}
+
+int frameUInt16(int offset)
+{
+  return frameBuffer[offset] | (frameBuffer[offset+1] << 8);
+}
+
+int frameInt16(int offset)
+{
+  int value = frameUInt16(offset);
+  return (value > 32767) ? value - 65536 : value;
+}
+
+void processFrame()
+{
+  int payloadLength = frameBuffer[4];
+  int crc = frameUInt16(FRAME_HEADER_SIZE + payloadLength);
+  
+  if(frameBuffer[2] != FRAME_VERSION || crc16(frameBuffer, 2, FRAME_HEADER_SIZE - 2 + payloadLength) != crc)
+  {
+    crcErrors++;
+    return;
+  }
+  
+  int sequence = frameUInt16(5);
+  if(lastSequence >= 0 && sequence != ((lastSequence + 1) & 0xFFFF))
+  {
+    lostFrames += (sequence - lastSequence - 1) & 0xFFFF;
+  }
+  lastSequence = sequence;
+  
+  int type = frameBuffer[3];
+  int p = FRAME_HEADER_SIZE;
+  long timestamp = unwrapDeviceTime(frameUInt16(7) | ((long)frameUInt16(9) << 16));
+  
+  if(type == FRAME_SNAPSHOT || type == FRAME_RAW_SNAPSHOT)
+  {
+    for(int ch = 0; ch < 4; ch++)
+    {
+      int value = (type == FRAME_SNAPSHOT) ? frameInt16(p + 2*ch) : frameUInt16(p + 2*ch);
+      actChannelValue(timestamp, ch, type == FRAME_RAW_SNAPSHOT, value);
+    }
+  }
+  else if(type == FRAME_BLOCK)
+  {
+    int mask = frameBuffer[p++];
+    boolean raw = (mask & BLOCK_RAW) != 0;
+    int count = frameBuffer[p++];
+    int[] last = new int[4];
+    
+    for(int n = 0; n < count; n++)
+    {
+      long[] varint = readVarint(p);  // time since frame timestamp (1st sample) / previous sample
+      p = (int)varint[1];
+      timestamp += varint[0];
+      
+      for(int ch = 0; ch < 4; ch++)
+      {
+        if((mask & (1 << ch)) == 0)
+        {
+          continue;
+        }
+        if(n == 0)
+        {
+          last[ch] = raw ? frameUInt16(p) : frameInt16(p);
+          p += 2;
+        }
+        else
+        {
+          varint = readVarint(p);
+          p = (int)varint[1];
+          long zigzag = varint[0];
+          last[ch] += (int)((zigzag >>> 1) ^ -(zigzag & 1));
+        }
+        actChannelValue(timestamp, ch, raw, last[ch]);
+      }
+    }
+  }
+}
+
+/// returns {value, next offset}
+long[] readVarint(int p)
+{
+  long value = 0;
+  int shift = 0;
+  int b;
+  do
+  {
+    b = frameBuffer[p++];
+    value |= (long)(b & 0x7F) << shift;
+    shift += 7;
+  } while((b & 0x80) != 0);
+  
+  return new long[] {value, p};
+}
+
+/// device time [us] without the wrap of the 32-bit timestamp
+long deviceTimeHigh = 0;
+long lastDeviceTime = -1;
+
+long unwrapDeviceTime(long timestamp)
+{
+  if(lastDeviceTime >= 0 && timestamp < lastDeviceTime - 0x80000000L)
+  {
+    deviceTimeHigh += 0x100000000L;
+  }
+  lastDeviceTime = timestamp;
+  return deviceTimeHigh + timestamp;
+}
+
+/// value of a channel: calibrated (ASCII 'a'...'d') / raw (ASCII 'f'...'i')
+void actChannelValue(long time_us, int channel, boolean raw, long value)
+{
+  queueSample(time_us, channel, raw, value);
 }
 
                             // E, Z, H, T
@@ -417,7 +837,14 @@ void handleSerialCommand(char c)
     //set read in number to DAC
     //myLoad.SetCurrent_mA(serialNumber);      
     
-    actSerialCommand(serialDigitType, serialNumber);   
+    if(serialDigitType >= 'a' && serialDigitType <= 'd')
+    {
+      actChannelValue(hostTime_us(), serialDigitType - 'a', false, serialNumber);
+    }
+    else if(serialDigitType >= 'f' && serialDigitType <= 'i')
+    {
+      actChannelValue(hostTime_us(), serialDigitType - 'f', true, serialNumber);
+    }
 
     readInDigit = false;
   }